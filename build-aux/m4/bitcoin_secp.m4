@@ -9,6 +9,34 @@ AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[
 AC_MSG_RESULT([$has_64bit_asm])
 ])
 
+dnl Check for target attributes and for runtime detection of the CPU features used in src/cpu.h.
+AC_DEFUN([SECP_RUNTIME_CPU_DISPATCH_CHECK],[
+AC_MSG_CHECKING(for runtime CPU dispatch availability)
+AC_LINK_IFELSE([AC_LANG_PROGRAM([[
+  __attribute__((target("sha"))) static int f(int x) { return x + 1; }]],[[
+  int r = 0;
+  if (__builtin_cpu_supports("avx512ifma")) r = f(r);
+  if (__builtin_cpu_supports("sha")) r = f(r);
+  return r;
+  ]])],[has_runtime_cpu_dispatch=yes],[has_runtime_cpu_dispatch=no])
+AC_MSG_RESULT([$has_runtime_cpu_dispatch])
+])
+
+dnl Check for AVX-512 IFMA intrinsics in functions with a target attribute.
+AC_DEFUN([SECP_AVX512IFMA_CHECK],[
+AC_MSG_CHECKING(for AVX-512 IFMA intrinsics availability)
+AC_COMPILE_IFELSE([AC_LANG_PROGRAM([[
+  #include <immintrin.h>
+  __attribute__((target("avx512f,avx512ifma"))) static void f(void *p) {
+    __m512i a = _mm512_loadu_si512(p);
+    _mm512_storeu_si512(p, _mm512_madd52hi_epu64(a, a, a));
+  }]],[[
+  unsigned char x[64] = {0};
+  f(x);
+  ]])],[has_avx512ifma=yes],[has_avx512ifma=no])
+AC_MSG_RESULT([$has_avx512ifma])
+])
+
 dnl
 AC_DEFUN([SECP_OPENSSL_CHECK],[
   has_libcrypto=no
@@ -70,6 +70,15 @@ typedef struct secp256k1_context_struct secp256k1_context;
  */
 typedef struct secp256k1_scratch_space_struct secp256k1_scratch_space;
 
+/** Opaque data structure that holds a public key together with a table of
+ *  precomputed multiples of it, which speeds up signature verification with
+ *  that public key. It is created by secp256k1_pubkey_precomp_create.
+ *
+ *  The object is not modified after its creation and can therefore be shared
+ *  between threads.
+ */
+typedef struct secp256k1_pubkey_precomp_struct secp256k1_pubkey_precomp;
+
 /** Opaque data structure that holds a parsed and valid public key.
  *
  *  The exact representation of data inside is implementation defined and not
@@ -83,6 +92,31 @@ typedef struct {
     unsigned char data[64];
 } secp256k1_pubkey;
 
+/** Opaque data structure that holds the state of a public key iterator.
+ *
+ *  A public key iterator produces the public keys P, P + S, P + 2*S, ... for
+ *  a start point P and a step S. The exact representation of data inside is
+ *  implementation defined and not guaranteed to be portable between different
+ *  platforms or versions. It can be safely copied/moved. It is initialized by
+ *  secp256k1_pubkey_iterator_init.
+ */
+typedef struct {
+    unsigned char data[129];
+} secp256k1_pubkey_iterator;
+
+/** Opaque data structure that holds the SHA256 midstate of a tagged hash.
+ *
+ *  It contains the state after hashing SHA256(tag)||SHA256(tag), so that
+ *  tagged hashes with the same tag can be computed without hashing the tag
+ *  again. The exact representation of data inside is implementation defined
+ *  and not guaranteed to be portable between different platforms or
+ *  versions. It can be safely copied/moved. It is initialized by
+ *  secp256k1_tagged_sha256_ctx_init.
+ */
+typedef struct {
+    unsigned char data[32];
+} secp256k1_tagged_sha256_ctx;
+
 /** Opaque data structured that holds a parsed ECDSA signature.
  *
  *  The exact representation of data inside is implementation defined and not
@@ -231,6 +265,100 @@ SECP256K1_API secp256k1_context* secp256k1_context_create(
     unsigned int flags
 ) SECP256K1_WARN_UNUSED_RESULT;
 
+/** Range of window sizes accepted by secp256k1_context_create_ecmult_window. */
+#define SECP256K1_ECMULT_WINDOW_MIN 2
+#define SECP256K1_ECMULT_WINDOW_MAX 24
+
+/** Create a secp256k1 context object with a chosen window size for the
+ *  verification tables (in dynamically allocated memory).
+ *
+ *  Same as secp256k1_context_create, except that the tables of precomputed
+ *  multiples of the generator, which are used by verification, public key
+ *  recovery and public key tweaking, have the given window size instead of the
+ *  one chosen at build time (configure option --with-ecmult-window). The two
+ *  tables take 2^(window+5) bytes in total, e.g., 32 KiB for window 10, 1 MiB
+ *  for window 15 and 128 MiB for window 22. Larger windows make verification
+ *  faster.
+ *
+ *  If the window size is the one chosen at build time, the static tables built
+ *  into the library are used. Otherwise the tables are computed by this
+ *  function, which takes time roughly proportional to their size, and are
+ *  copied along with the context by secp256k1_context_clone.
+ *
+ *  Returns: a newly created context object, or NULL if window is out of range.
+ *  In:      flags:  which parts of the context to initialize.
+ *           window: window size of the verification tables, between
+ *                   SECP256K1_ECMULT_WINDOW_MIN and SECP256K1_ECMULT_WINDOW_MAX.
+ */
+SECP256K1_API secp256k1_context* secp256k1_context_create_ecmult_window(
+    unsigned int flags,
+    int window
+) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Make a context use verification tables from caller-provided memory.
+ *
+ *  The tables must be in the format written by the gen_ecmult_static_pre_g
+ *  program of this library when given a window size and an output file
+ *  (e.g., "gen_ecmult_static_pre_g 20 tables.bin"), and they must have been
+ *  written for the same platform. Since the tables are not copied, they can
+ *  be mapped read-only from a file (e.g., with mmap), so that processes using
+ *  the same file share one copy of them in memory.
+ *
+ *  The tables are trusted input. They must be protected from modification
+ *  like the library binary itself: tampered tables can make signature
+ *  verification accept forged signatures. The format contains a version
+ *  number and an unkeyed checksum, which this function checks, but they
+ *  only detect accidental corruption and truncation. Anyone who can modify
+ *  the tables can also recompute the checksum.
+ *
+ *  The header and the first table entries are checked first, but every
+ *  call that passes these checks then hashes all tableslen bytes to verify
+ *  the checksum (8 MiB for window 18). That is a full pass over the tables,
+ *  which also reads a mapped file completely into memory. To use the same
+ *  tables in several contexts, call this function once and clone that
+ *  context instead of calling it again.
+ *
+ *  The memory must stay valid and unmodified until the context and all
+ *  contexts cloned from it after this call have been destroyed or been given
+ *  other tables by this function.
+ *
+ *  Returns: 1 if the tables were valid and are now used by the context.
+ *           0 if they were not valid, in which case the context is unchanged.
+ *  Args:    ctx:       an existing context object (cannot be NULL)
+ *  In:      tables:    pointer to the serialized tables, aligned like memory
+ *                      returned by malloc or mmap (cannot be NULL)
+ *           tableslen: length of the serialized tables in bytes
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_context_set_ecmult_tables(
+    secp256k1_context* ctx,
+    const unsigned char *tables,
+    size_t tableslen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Make a context use a tuning profile for multiplying many points at once.
+ *
+ *  Functions which multiply many points at once, such as secp256k1_ecmult_multi
+ *  and the batch verification functions, choose between several algorithms
+ *  and their parameters depending on the number of points. The default
+ *  choices were measured on one machine and can be far from optimal on
+ *  others. A profile with the choices measured on the current machine is
+ *  written by the bench_ecmult program of this library when given the
+ *  "calibrate" argument and an output file (e.g., "bench_ecmult calibrate
+ *  profile.bin"). The profile is copied into the context, and to contexts
+ *  cloned from it afterwards.
+ *
+ *  Returns: 1 if the profile was valid and is now used by the context.
+ *           0 if it was not valid, in which case the context is unchanged.
+ *  Args:    ctx:        an existing context object (cannot be NULL)
+ *  In:      profile:    pointer to the serialized profile (cannot be NULL)
+ *           profilelen: length of the serialized profile in bytes
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_context_set_ecmult_multi_profile(
+    secp256k1_context* ctx,
+    const unsigned char *profile,
+    size_t profilelen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
 /** Copy a secp256k1 context object (into dynamically allocated memory).
  *
  *  This function uses malloc to allocate memory. It is guaranteed that malloc is
@@ -396,6 +524,66 @@ SECP256K1_API int secp256k1_ec_pubkey_serialize(
     unsigned int flags
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Parse an array of variable-length public keys into pubkey objects.
+ *
+ *  Produces the same results as calling secp256k1_ec_pubkey_parse on every
+ *  input, but decompresses several compressed public keys at once, which is
+ *  considerably faster.
+ *
+ *  Returns: 1 if all public keys were fully valid.
+ *           0 if at least one public key could not be parsed or is invalid.
+ *  Args: ctx:       a secp256k1 context object.
+ *  Out:  pubkeys:   pointer to an array of n pubkey objects (can only be NULL
+ *                   if n is 0). Public keys which could not be parsed are
+ *                   zeroed.
+ *        valid:     pointer to an array of n integers which are set to 1 if
+ *                   the corresponding public key was fully valid and to 0
+ *                   otherwise (can be NULL).
+ *  In:   inputs:    pointer to an array of n pointers to serialized public keys
+ *                   (can only be NULL if n is 0)
+ *        inputlens: pointer to an array of the n lengths of the serialized
+ *                   public keys (can only be NULL if n is 0)
+ *        n:         the number of public keys
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_parse_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *pubkeys,
+    int *valid,
+    const unsigned char * const *inputs,
+    const size_t *inputlens,
+    size_t n
+) SECP256K1_ARG_NONNULL(1);
+
+/** Serialize an array of pubkey objects into a byte sequence.
+ *
+ *  Produces the concatenation of the outputs of secp256k1_ec_pubkey_serialize
+ *  for every public key.
+ *
+ *  Returns: 1 if all public keys were serialized.
+ *           0 if at least one public key was not initialized. Its serialization
+ *             is zeroed.
+ *  Args:   ctx:        a secp256k1 context object.
+ *  Out:    output:     a pointer to a byte array of at least 65*n (if
+ *                      compressed==0) or 33*n (if compressed==1) bytes to
+ *                      place the serialized keys in.
+ *  In/Out: outputlen:  a pointer to an integer which is initially set to the
+ *                      size of output, and is overwritten with the written
+ *                      size.
+ *  In:     pubkeys:    a pointer to an array of n initialized public keys (can
+ *                      only be NULL if n is 0)
+ *          n:          the number of public keys
+ *          flags:      SECP256K1_EC_COMPRESSED if serialization should be in
+ *                      compressed format, otherwise SECP256K1_EC_UNCOMPRESSED.
+ */
+SECP256K1_API int secp256k1_ec_pubkey_serialize_batch(
+    const secp256k1_context* ctx,
+    unsigned char *output,
+    size_t *outputlen,
+    const secp256k1_pubkey *pubkeys,
+    size_t n,
+    unsigned int flags
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 /** Compare two public keys using lexicographic (of compressed serialization) order
  *
  *  Returns: <0 if the first public key is less than the second
@@ -519,6 +707,100 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify(
     const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Verify a batch of ECDSA signatures.
+ *
+ *  Returns: 1: all signatures are correct
+ *           0: at least one signature is incorrect or unparseable
+ *  Args:    ctx:       a secp256k1 context object, initialized for verification.
+ *           scratch:   scratch space used for the multiexponentiation (cannot
+ *                      be NULL)
+ *  In:      sig:       array of pointers to the signatures being verified (can
+ *                      only be NULL if n_sigs is 0)
+ *           recid:     array of recovery ids, one per signature (can be NULL if
+ *                      no recovery ids are known). An entry is either -1 if the
+ *                      recovery id of the signature is unknown, or the recovery
+ *                      id in [0..3] as output by the recovery module.
+ *           msghash32: array of pointers to 32-byte message hashes (can only be
+ *                      NULL if n_sigs is 0). See secp256k1_ecdsa_verify.
+ *           pubkey:    array of pointers to initialized public keys to verify
+ *                      with (can only be NULL if n_sigs is 0)
+ *           n_sigs:    number of signatures in the above arrays. Must be below
+ *                      the minimum of 2^31 and SIZE_MAX/2.
+ *
+ *  The result is the same as calling secp256k1_ecdsa_verify on every signature.
+ *  The recovery id allows reconstructing the nonce point R of a signature, and
+ *  all signatures with a recovery id are checked at once by verifying a random
+ *  linear combination of their verification equations. Signatures without a
+ *  recovery id are verified individually. A recovery id which does not match
+ *  its signature does not make the signature fail, but it causes all
+ *  signatures of the batch to be verified individually.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_batch(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    const secp256k1_ecdsa_signature *const *sig,
+    const int *recid,
+    const unsigned char *const *msghash32,
+    const secp256k1_pubkey *const *pubkey,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** The largest window size accepted by secp256k1_pubkey_precomp_create. */
+#define SECP256K1_PUBKEY_PRECOMP_MAX_WINDOW 20
+
+/** Create a public key object with precomputed multiples.
+ *
+ *  Verifying with the resulting object avoids computing a table of multiples
+ *  of the public key in every verification, and allows using a larger table
+ *  than the verification functions compute on the fly. This is worthwhile if
+ *  many signatures are verified with the same public key.
+ *
+ *  Returns: a newly created object, or NULL if the public key is invalid.
+ *  Args:   ctx:    an existing context object (cannot be NULL)
+ *  In:     pubkey: pointer to the public key (cannot be NULL)
+ *          window: the window size of the table, which must be between 2 and
+ *                  SECP256K1_PUBKEY_PRECOMP_MAX_WINDOW. The table has
+ *                  2^(window-2) entries of 64 bytes. Larger windows speed up
+ *                  verification at the cost of memory; windows of 8 to 12
+ *                  are a reasonable choice.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_pubkey_precomp* secp256k1_pubkey_precomp_create(
+    const secp256k1_context* ctx,
+    const secp256k1_pubkey *pubkey,
+    int window
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Destroy a public key object with precomputed multiples.
+ *
+ *  Args:   ctx:     an existing context object (cannot be NULL)
+ *  In:     precomp: the object to destroy (can be NULL, in which case the
+ *                   function does nothing)
+ */
+SECP256K1_API void secp256k1_pubkey_precomp_destroy(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey_precomp *precomp
+) SECP256K1_ARG_NONNULL(1);
+
+/** Verify an ECDSA signature with a public key with precomputed multiples.
+ *
+ *  Same as secp256k1_ecdsa_verify, except that the public key is given as an
+ *  object created by secp256k1_pubkey_precomp_create.
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect or unparseable signature
+ *  Args:    ctx:       a secp256k1 context object, initialized for verification.
+ *  In:      sig:       the signature being verified (cannot be NULL)
+ *           msghash32: the 32-byte message hash being verified (cannot be NULL).
+ *           precomp:   pointer to the public key object to verify with (cannot
+ *                      be NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_precomp(
+    const secp256k1_context* ctx,
+    const secp256k1_ecdsa_signature *sig,
+    const unsigned char *msghash32,
+    const secp256k1_pubkey_precomp *precomp
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 /** Convert a signature to a normalized lower-S form.
  *
  *  Returns: 1 if sigin was not normalized, 0 if it already was.
@@ -599,6 +881,40 @@ SECP256K1_API int secp256k1_ecdsa_sign(
     const void *ndata
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Create ECDSA signatures for a batch of messages with the same secret key.
+ *
+ *  Creates the same signatures as calling secp256k1_ecdsa_sign on every
+ *  message, but checks the secret key only once and computes the nonce points
+ *  and nonce inverses of consecutive messages together, which is faster when
+ *  signing many messages. For every message, the nonce function is called
+ *  with the same sequence of counters as by secp256k1_ecdsa_sign, but the
+ *  calls for consecutive messages are interleaved: the first nonces of up to
+ *  16 messages are requested before any of them is retried.
+ *
+ *  Returns: 1: all signatures created
+ *           0: the nonce generation function failed for at least one message,
+ *              or the secret key was invalid. Signatures that could not be
+ *              created are set to an invalid value.
+ *  Args:    ctx:       pointer to a context object, initialized for signing (cannot be NULL)
+ *  Out:     sigs:      pointer to an array of n signatures (can only be NULL if n is 0)
+ *  In:      msghash32: array of pointers to the 32-byte message hashes being signed
+ *                      (can only be NULL if n is 0, and no element can be NULL)
+ *           n:         number of messages
+ *           seckey:    pointer to a 32-byte secret key (cannot be NULL)
+ *           noncefp:   pointer to a nonce generation function. If NULL, secp256k1_nonce_function_default is used
+ *           ndata:     pointer to arbitrary data used by the nonce generation function for
+ *                      every message (can be NULL)
+ */
+SECP256K1_API int secp256k1_ecdsa_sign_batch(
+    const secp256k1_context* ctx,
+    secp256k1_ecdsa_signature *sigs,
+    const unsigned char *const *msghash32,
+    size_t n,
+    const unsigned char *seckey,
+    secp256k1_nonce_function noncefp,
+    const void *ndata
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(5);
+
 /** Verify an ECDSA secret key.
  *
  *  A secret key is valid if it is not 0 and less than the secp256k1 curve order
@@ -630,6 +946,76 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_create(
     const unsigned char *seckey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Initialize a public key iterator.
+ *
+ *  The iterator produces the public keys start, start + step, start + 2*step,
+ *  ... in this order. If step is the generator, this corresponds to the
+ *  secret keys k, k + 1, k + 2, ... where k is the secret key of start.
+ *  Every public key is obtained by a single point addition, which is much
+ *  faster than creating it from its secret key.
+ *
+ *  Note that the public keys are computed in variable time. They must not be
+ *  used for keys whose public keys are meant to be kept secret.
+ *
+ *  Returns: 1 if the iterator was initialized, 0 if a public key was invalid.
+ *  Args:   ctx:   pointer to a context object (cannot be NULL)
+ *  Out:    iter:  pointer to the iterator object to initialize (cannot be NULL)
+ *  In:     start: pointer to the first public key produced (cannot be NULL)
+ *          step:  pointer to the public key added in every step (can be NULL,
+ *                 in which case the generator is used)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pubkey_iterator_init(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey_iterator *iter,
+    const secp256k1_pubkey *start,
+    const secp256k1_pubkey *step
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Produce the next public keys of a public key iterator.
+ *
+ *  The conversion of the public keys to affine coordinates is done in blocks
+ *  which share a single field inversion.
+ *
+ *  Returns: 1: all n public keys were stored.
+ *           0: at least one of the public keys is the point at infinity, which
+ *              is not a valid public key. Its public key object is zeroed, the
+ *              others are still stored and the iterator is advanced by n.
+ *  Args:   ctx:     pointer to a context object (cannot be NULL)
+ *  In/Out: iter:    pointer to an initialized iterator object (cannot be NULL)
+ *  Out:    pubkeys: pointer to an array of n public key objects to store the
+ *                   next public keys (can only be NULL if n is 0)
+ *  In:     n:       the number of public keys to produce
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_pubkey_iterator_next(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey_iterator *iter,
+    secp256k1_pubkey *pubkeys,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Compute the public keys for a batch of secret keys.
+ *
+ *  Produces the same public keys as calling secp256k1_ec_pubkey_create on
+ *  every secret key, but shares the expensive conversion of the results to
+ *  affine coordinates between several keys.
+ *
+ *  Returns: 1: all secret keys were valid, public keys stored.
+ *           0: at least one secret key was invalid. The public keys of the
+ *              invalid secret keys are zeroed, the others are still stored.
+ *  Args:   ctx:     pointer to a context object, initialized for signing (cannot be NULL)
+ *  Out:    pubkeys: pointer to an array of n public key objects to store the
+ *                   results (can only be NULL if n is 0)
+ *  In:     seckeys: pointer to an array of n pointers to 32-byte secret keys
+ *                   (can only be NULL if n is 0)
+ *          n:       the number of secret keys
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_create_batch(
+    const secp256k1_context* ctx,
+    secp256k1_pubkey *pubkeys,
+    const unsigned char * const *seckeys,
+    size_t n
+) SECP256K1_ARG_NONNULL(1);
+
 /** Negates a secret key in place.
  *
  *  Returns: 0 if the given secret key is invalid according to
@@ -805,6 +1191,145 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_combine(
     size_t n
 ) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** A pointer to a function that provides the inputs of a multi-scalar
+ *  multiplication.
+ *
+ *  Returns: 1 if the input was successfully provided. 0 will cause
+ *           secp256k1_ecmult_multi to return an error.
+ *  Out:  scalar32: pointer to a 32-byte array to store the big-endian scalar
+ *                  of the idx-th input (will not be NULL)
+ *           point: pointer to a public key object to store the point of the
+ *                  idx-th input (will not be NULL)
+ *  In:        idx: the index of the input, in the range [0, n)
+ *            data: arbitrary data pointer that is passed through
+ *
+ *  The function may be called more than once for the same index and the
+ *  indices are not necessarily requested in order.
+ */
+typedef int (*secp256k1_ecmult_multi_input_callback)(
+    unsigned char *scalar32,
+    secp256k1_pubkey *point,
+    size_t idx,
+    void *data
+);
+
+/** Compute a multi-scalar multiplication.
+ *
+ *  Computes g_scalar*G + scalar_0*P_0 + ... + scalar_{n-1}*P_{n-1}, where the
+ *  scalars and points are provided by a callback function.
+ *
+ *  This function is not constant time: its run time and memory access
+ *  pattern depend on the scalars. It must only be used with public scalars,
+ *  as in signature verification, and never with secret keys, nonces or
+ *  other secret values. Unlike secp256k1_ec_pubkey_tweak_mul, it is therefore
+ *  not suitable for computing a shared secret or deriving keys.
+ *
+ *  Returns: 1: the result is a valid public key.
+ *           0: the result is the point at infinity, a scalar overflowed, a
+ *              point was invalid, the callback returned 0 or the arguments
+ *              were invalid.
+ *  Args:       ctx: pointer to a context object (cannot be NULL)
+ *          scratch: scratch space used for the computation (can be NULL, in
+ *                   which case every input is multiplied individually). If the
+ *                   inputs do not fit into the scratch space, they are
+ *                   processed in batches.
+ *  Out:     pubkey: pointer to a public key object for placing the result
+ *                   (cannot be NULL)
+ *  In:  g_scalar32: pointer to the 32-byte big-endian scalar the generator is
+ *                   multiplied with (can be NULL, in which case it is zero)
+ *               cb: function providing the inputs (can only be NULL if n is 0)
+ *           cbdata: arbitrary data pointer that is passed through to cb
+ *                n: number of inputs provided by cb
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecmult_multi(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *pubkey,
+    const unsigned char *g_scalar32,
+    secp256k1_ecmult_multi_input_callback cb,
+    void *cbdata,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
+/** A pointer to a task of a parallel multi-scalar multiplication.
+ *
+ *  In:        idx: the index of the task, in the range [0, n_tasks)
+ *       task_data: data pointer that must be passed through unchanged
+ */
+typedef void (*secp256k1_ecmult_multi_task_callback)(
+    size_t idx,
+    void *task_data
+);
+
+/** A pointer to a function that runs the tasks of a parallel multi-scalar
+ *  multiplication, for example on the threads of a thread pool.
+ *
+ *  The function must call task(i, task_data) exactly once for every i in the
+ *  range [0, n_tasks) and must only return after all of these calls have
+ *  returned. The calls may be made concurrently and in any order.
+ *
+ *  In:          task: the task to run (will not be NULL)
+ *          task_data: data pointer to pass through to task
+ *            n_tasks: number of tasks to run
+ *      dispatch_data: arbitrary data pointer that is passed through
+ */
+typedef void (*secp256k1_ecmult_multi_dispatch_callback)(
+    secp256k1_ecmult_multi_task_callback task,
+    void *task_data,
+    size_t n_tasks,
+    void *dispatch_data
+);
+
+/** Compute a multi-scalar multiplication using several threads.
+ *
+ *  Same as secp256k1_ecmult_multi, but splits the inputs into at most n_tasks
+ *  parts of roughly equal size that are multiplied by separate tasks, which
+ *  are run by the dispatch function. The results of the tasks are added up
+ *  after dispatch returns. The same warning applies: this function is not
+ *  constant time and must only be used with public scalars.
+ *
+ *  The callback cb is called concurrently from all tasks, so it must be safe
+ *  to call from several threads at the same time. In particular it must not
+ *  modify any state shared between calls without synchronization.
+ *
+ *  The scratch space is divided between the tasks. If scratch is NULL, if
+ *  n_tasks is smaller than 2 or if the scratch space is too small to be
+ *  divided, dispatch is not called and the computation runs on the calling
+ *  thread as in secp256k1_ecmult_multi.
+ *
+ *  Returns: 1: the result is a valid public key.
+ *           0: the result is the point at infinity, a scalar overflowed, a
+ *              point was invalid, the callback returned 0 or the arguments
+ *              were invalid.
+ *  Args:          ctx: pointer to a context object (cannot be NULL)
+ *             scratch: scratch space used for the computation (can be NULL)
+ *  Out:        pubkey: pointer to a public key object for placing the result
+ *                      (cannot be NULL)
+ *  In:     g_scalar32: pointer to the 32-byte big-endian scalar the generator
+ *                      is multiplied with (can be NULL, in which case it is
+ *                      zero)
+ *                  cb: thread-safe function providing the inputs (can only be
+ *                      NULL if n is 0)
+ *              cbdata: arbitrary data pointer that is passed through to cb
+ *                   n: number of inputs provided by cb
+ *            dispatch: function running the tasks (cannot be NULL)
+ *       dispatch_data: arbitrary data pointer that is passed through to
+ *                      dispatch
+ *             n_tasks: maximum number of tasks to split the inputs into
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecmult_multi_parallel(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *pubkey,
+    const unsigned char *g_scalar32,
+    secp256k1_ecmult_multi_input_callback cb,
+    void *cbdata,
+    size_t n,
+    secp256k1_ecmult_multi_dispatch_callback dispatch,
+    void *dispatch_data,
+    size_t n_tasks
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(8);
+
 /** Compute a tagged hash as defined in BIP-340.
  *
  *  This is useful for creating a message hash and achieving domain separation
@@ -830,6 +1355,95 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tagged_sha256(
     size_t msglen
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(5);
 
+/** Compute tagged hashes of multiple messages with the same tag.
+ *
+ *  The result is the same as calling secp256k1_tagged_sha256 for every
+ *  message, but the messages are hashed in parallel if the CPU supports it.
+ *
+ *  Returns 0 if the arguments are invalid and 1 otherwise.
+ *  Args:    ctx: pointer to a context object
+ *  Out:  hash32: pointer to an array of 32*n bytes to store the resulting
+ *                hashes, with the hash of message i at offset 32*i (can only
+ *                be NULL if n is 0)
+ *  In:      tag: pointer to an array containing the tag
+ *        taglen: length of the tag array
+ *           msg: array of pointers to the messages (can only be NULL if n is
+ *                0). An individual message pointer can only be NULL if the
+ *                corresponding message length is 0.
+ *        msglen: array of message lengths (can only be NULL if n is 0)
+ *             n: number of messages
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tagged_sha256_batch(
+    const secp256k1_context* ctx,
+    unsigned char *hash32,
+    const unsigned char *tag,
+    size_t taglen,
+    const unsigned char *const *msg,
+    const size_t *msglen,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
+/** Initialize a tagged hash midstate for a tag.
+ *
+ *  Returns 0 if the arguments are invalid and 1 otherwise.
+ *  Args:     ctx: pointer to a context object
+ *  Out:  tag_ctx: pointer to the midstate object to initialize
+ *  In:       tag: pointer to an array containing the tag
+ *         taglen: length of the tag array
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tagged_sha256_ctx_init(
+    const secp256k1_context* ctx,
+    secp256k1_tagged_sha256_ctx *tag_ctx,
+    const unsigned char *tag,
+    size_t taglen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Compute a tagged hash using a precomputed midstate.
+ *
+ *  Same as secp256k1_tagged_sha256 with the tag that tag_ctx was initialized
+ *  with, but without hashing the tag.
+ *
+ *  Returns 0 if the arguments are invalid and 1 otherwise.
+ *  Args:     ctx: pointer to a context object
+ *  Out:   hash32: pointer to a 32-byte array to store the resulting hash
+ *  In:   tag_ctx: pointer to an initialized midstate object
+ *            msg: pointer to an array containing the message
+ *         msglen: length of the message array
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tagged_sha256_ctx_hash(
+    const secp256k1_context* ctx,
+    unsigned char *hash32,
+    const secp256k1_tagged_sha256_ctx *tag_ctx,
+    const unsigned char *msg,
+    size_t msglen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Compute tagged hashes of multiple messages using a precomputed midstate.
+ *
+ *  Same as secp256k1_tagged_sha256_batch with the tag that tag_ctx was
+ *  initialized with, but without hashing the tag.
+ *
+ *  Returns 0 if the arguments are invalid and 1 otherwise.
+ *  Args:     ctx: pointer to a context object
+ *  Out:   hash32: pointer to an array of 32*n bytes to store the resulting
+ *                 hashes, with the hash of message i at offset 32*i (can only
+ *                 be NULL if n is 0)
+ *  In:   tag_ctx: pointer to an initialized midstate object
+ *            msg: array of pointers to the messages (can only be NULL if n is
+ *                 0). An individual message pointer can only be NULL if the
+ *                 corresponding message length is 0.
+ *         msglen: array of message lengths (can only be NULL if n is 0)
+ *              n: number of messages
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tagged_sha256_ctx_hash_batch(
+    const secp256k1_context* ctx,
+    unsigned char *hash32,
+    const secp256k1_tagged_sha256_ctx *tag_ctx,
+    const unsigned char *const *msg,
+    const size_t *msglen,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
 #ifdef __cplusplus
 }
 #endif
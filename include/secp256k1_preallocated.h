@@ -78,6 +78,47 @@ SECP256K1_API secp256k1_context* secp256k1_context_preallocated_create(
     unsigned int flags
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_WARN_UNUSED_RESULT;
 
+/** Determine the memory size of a secp256k1 context object with a chosen
+ *  window size for the verification tables to be created in caller-provided
+ *  memory.
+ *
+ *  The purpose of this function is to determine how much memory must be provided
+ *  to secp256k1_context_preallocated_create_ecmult_window.
+ *
+ *  Returns: the required size of the caller-provided memory block, or 0 if
+ *           window is out of range.
+ *  In:      flags:  which parts of the context to initialize.
+ *           window: window size of the verification tables (see
+ *                   secp256k1_context_create_ecmult_window in secp256k1.h).
+ */
+SECP256K1_API size_t secp256k1_context_preallocated_size_ecmult_window(
+    unsigned int flags,
+    int window
+) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Create a secp256k1 context object with a chosen window size for the
+ *  verification tables in caller-provided memory.
+ *
+ *  Same as secp256k1_context_preallocated_create, except that the memory block
+ *  must have a size of at least
+ *  secp256k1_context_preallocated_size_ecmult_window(flags, window) bytes and
+ *  that the verification tables are computed in it, see
+ *  secp256k1_context_create_ecmult_window (in secp256k1.h).
+ *
+ *  Returns: a newly created context object, or NULL if window is out of range.
+ *  In:      prealloc: a pointer to a rewritable contiguous block of memory of
+ *                     size at least
+ *                     secp256k1_context_preallocated_size_ecmult_window(flags, window)
+ *                     bytes (cannot be NULL)
+ *           flags:    which parts of the context to initialize.
+ *           window:   window size of the verification tables.
+ */
+SECP256K1_API secp256k1_context* secp256k1_context_preallocated_create_ecmult_window(
+    void* prealloc,
+    unsigned int flags,
+    int window
+) SECP256K1_ARG_NONNULL(1) SECP256K1_WARN_UNUSED_RESULT;
+
 /** Determine the memory size of a secp256k1 context object to be copied into
  *  caller-provided memory.
  *
@@ -135,6 +135,35 @@ SECP256K1_API int secp256k1_schnorrsig_sign(
     unsigned char *aux_rand32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Create Schnorr signatures for a batch of messages with the same keypair.
+ *
+ *  Creates the same signatures as calling secp256k1_schnorrsig_sign on every
+ *  message, but loads the keypair only once and computes the nonce points and
+ *  challenge hashes of consecutive messages together, which is faster when
+ *  signing many messages.
+ *
+ *  Returns 1 if all signatures were created, 0 otherwise. Signatures that
+ *  could not be created are set to zero.
+ *  Args:    ctx: pointer to a context object, initialized for signing (cannot be NULL)
+ *  Out:   sig64: pointer to an array of 64*n bytes to store the serialized
+ *                signatures (can only be NULL if n is 0)
+ *  In:    msg32: array of pointers to the 32-byte messages being signed (can
+ *                only be NULL if n is 0, and no element can be NULL)
+ *             n: number of messages
+ *       keypair: pointer to an initialized keypair (cannot be NULL)
+ *    aux_rand32: array of pointers to 32 bytes of fresh randomness per message
+ *                as in secp256k1_schnorrsig_sign (can be NULL, in which case
+ *                no randomness is used, and individual elements can be NULL)
+ */
+SECP256K1_API int secp256k1_schnorrsig_sign_batch(
+    const secp256k1_context* ctx,
+    unsigned char *sig64,
+    const unsigned char *const *msg32,
+    size_t n,
+    const secp256k1_keypair *keypair,
+    unsigned char *const *aux_rand32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(5);
+
 /** Create a Schnorr signature with a more flexible API.
  *
  *  Same arguments as secp256k1_schnorrsig_sign except that it allows signing
@@ -175,6 +204,68 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify(
     const secp256k1_xonly_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
 
+/** Verify a Schnorr signature with a public key with precomputed multiples.
+ *
+ *  Same as secp256k1_schnorrsig_verify, except that the public key is given as
+ *  an object created by secp256k1_pubkey_precomp_create. The x-only public key
+ *  used for verification is the one corresponding to the public key of that
+ *  object, as computed by secp256k1_xonly_pubkey_from_pubkey. To create the
+ *  object from a serialized x-only public key, parse it with
+ *  secp256k1_ec_pubkey_parse after prepending the byte 0x02.
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect signature
+ *  Args:    ctx: a secp256k1 context object, initialized for verification.
+ *  In:    sig64: pointer to the 64-byte signature to verify (cannot be NULL)
+ *           msg: the message being verified. Can only be NULL if msglen is 0.
+ *        msglen: length of the message
+ *       precomp: pointer to the public key object to verify with (cannot be
+ *                NULL)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify_precomp(
+    const secp256k1_context* ctx,
+    const unsigned char *sig64,
+    const unsigned char *msg,
+    size_t msglen,
+    const secp256k1_pubkey_precomp *precomp
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
+
+/** Verify a batch of Schnorr signatures.
+ *
+ *  Returns 1 if all signatures are valid and 0 if at least one of them is
+ *  invalid. A return value of 0 does not indicate which signature is invalid;
+ *  use secp256k1_schnorrsig_verify on the individual signatures to find out.
+ *
+ *  The signatures are checked at once by verifying a random linear
+ *  combination of the individual verification equations. The random weights
+ *  are derived deterministically from a hash of all inputs.
+ *
+ *  Args:    ctx: a secp256k1 context object, initialized for verification.
+ *       scratch: scratch space used for the multiexponentiation (cannot be
+ *                NULL). Batch verification is only faster than individual
+ *                verification if the scratch space can hold a reasonable
+ *                number of points.
+ *  In:    sig64: array of pointers to 64-byte signatures to verify (can only be
+ *                NULL if n_sigs is 0)
+ *           msg: array of pointers to the messages being verified (can only be
+ *                NULL if n_sigs is 0). An individual message pointer can
+ *                only be NULL if the corresponding message length is 0.
+ *        msglen: array of message lengths (can only be NULL if n_sigs is 0)
+ *        pubkey: array of pointers to x-only public keys to verify with (can
+ *                only be NULL if n_sigs is 0)
+ *        n_sigs: number of signatures in the above arrays. Must be below the
+ *                minimum of 2^31 and SIZE_MAX/2.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify_batch(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    const unsigned char *const *sig64,
+    const unsigned char *const *msg,
+    const size_t *msglen,
+    const secp256k1_xonly_pubkey *const *pubkey,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,7 +22,8 @@
 #ifdef USE_BASIC_CONFIG
 
 #define ECMULT_WINDOW_SIZE 15
-#define ECMULT_GEN_PREC_BITS 4
+#define ECMULT_GEN_COMB_BLOCKS 11
+#define ECMULT_GEN_COMB_TEETH 6
 
 #endif /* USE_BASIC_CONFIG */
 
@@ -28,12 +28,18 @@
 #include "ecmult_impl.h"
 #include "bench.h"
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 #define POINTS 32768
+#define MAX_THREADS 16
 
 void help(char **argv) {
     printf("Benchmark EC multiplication algorithms\n");
     printf("\n");
-    printf("Usage: %s <help|pippenger_wnaf|strauss_wnaf|simple>\n", argv[0]);
+    printf("Usage: %s <help|pippenger_wnaf|pippenger_affine|strauss_wnaf|simple|threads>\n", argv[0]);
+    printf("       %s calibrate <file>\n", argv[0]);
     printf("The output shows the number of multiplied and summed points right after the\n");
     printf("function name. The letter 'g' indicates that one of the points is the generator.\n");
     printf("The benchmarks are divided by the number of points.\n");
@@ -41,8 +47,15 @@ void help(char **argv) {
     printf("default (ecmult_multi): picks pippenger_wnaf or strauss_wnaf depending on the\n");
     printf("                        batch size\n");
     printf("pippenger_wnaf:         for all batch sizes\n");
+    printf("pippenger_affine:       pippenger_wnaf with affine buckets, for all batch sizes\n");
     printf("strauss_wnaf:           for all batch sizes\n");
     printf("simple:                 multiply and sum each point individually\n");
+    printf("threads:                ecmult_multi split between 1, 2, 4, ..., %d threads; the\n", MAX_THREADS);
+    printf("                        thread count is shown after the number of points\n");
+    printf("\n");
+    printf("calibrate:              measure the best algorithm choices of ecmult_multi on this\n");
+    printf("                        machine and write them to <file>, as a profile for\n");
+    printf("                        secp256k1_context_set_ecmult_multi_profile\n");
 }
 
 typedef struct {
@@ -59,6 +72,7 @@ typedef struct {
     /* Changes per benchmark */
     size_t count;
     int includes_g;
+    size_t n_threads;
 
     /* Changes per benchmark iteration, used to pick different scalars and pubkeys
      * in each run. */
@@ -141,7 +155,7 @@ static void bench_ecmult_1(void* arg, int iters) {
     int i;
 
     for (i = 0; i < iters; ++i) {
-        secp256k1_ecmult(&data->output[i], &data->pubkeys_gej[(data->offset1+i) % POINTS], &data->scalars[(data->offset2+i) % POINTS], NULL);
+        secp256k1_ecmult(&data->ctx->ecmult_ctx, &data->output[i], &data->pubkeys_gej[(data->offset1+i) % POINTS], &data->scalars[(data->offset2+i) % POINTS], NULL);
     }
 }
 
@@ -157,7 +171,7 @@ static void bench_ecmult_1g(void* arg, int iters) {
 
     secp256k1_scalar_set_int(&zero, 0);
     for (i = 0; i < iters; ++i) {
-        secp256k1_ecmult(&data->output[i], NULL, &zero, &data->scalars[(data->offset1+i) % POINTS]);
+        secp256k1_ecmult(&data->ctx->ecmult_ctx, &data->output[i], NULL, &zero, &data->scalars[(data->offset1+i) % POINTS]);
     }
 }
 
@@ -171,7 +185,7 @@ static void bench_ecmult_2g(void* arg, int iters) {
     int i;
 
     for (i = 0; i < iters/2; ++i) {
-        secp256k1_ecmult(&data->output[i], &data->pubkeys_gej[(data->offset1+i) % POINTS], &data->scalars[(data->offset2+i) % POINTS], &data->scalars[(data->offset1+i) % POINTS]);
+        secp256k1_ecmult(&data->ctx->ecmult_ctx, &data->output[i], &data->pubkeys_gej[(data->offset1+i) % POINTS], &data->scalars[(data->offset2+i) % POINTS], &data->scalars[(data->offset1+i) % POINTS]);
     }
 }
 
@@ -210,6 +224,47 @@ static int bench_ecmult_multi_callback(secp256k1_scalar* sc, secp256k1_ge* ge, s
     return 1;
 }
 
+#ifdef HAVE_PTHREAD
+typedef struct {
+    secp256k1_ecmult_multi_task *task;
+    void *task_data;
+    size_t idx;
+} bench_thread_data;
+
+static void* bench_ecmult_multi_thread(void* arg) {
+    bench_thread_data* thread_data = (bench_thread_data*)arg;
+    thread_data->task(thread_data->idx, thread_data->task_data);
+    return NULL;
+}
+
+/* Runs task 0 on the calling thread and every other task on a new thread. */
+static void bench_ecmult_multi_dispatch(secp256k1_ecmult_multi_task *task, void *task_data, size_t n_tasks, void *dispatch_data) {
+    pthread_t threads[MAX_THREADS];
+    bench_thread_data thread_data[MAX_THREADS];
+    size_t i;
+    (void)dispatch_data;
+
+    CHECK(n_tasks <= MAX_THREADS);
+    for (i = 1; i < n_tasks; i++) {
+        thread_data[i].task = task;
+        thread_data[i].task_data = task_data;
+        thread_data[i].idx = i;
+        CHECK(pthread_create(&threads[i], NULL, bench_ecmult_multi_thread, &thread_data[i]) == 0);
+    }
+    task(0, task_data);
+    for (i = 1; i < n_tasks; i++) {
+        CHECK(pthread_join(threads[i], NULL) == 0);
+    }
+}
+
+/* bench_ecmult_multi_callback only reads the bench_data, so it can be called
+ * from all threads at once. */
+static int bench_ecmult_multi_threads(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ecmult_ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    bench_data* data = (bench_data*)cbdata;
+    return secp256k1_ecmult_multi_var_parallel(error_callback, ecmult_ctx, scratch, r, inp_g_sc, cb, cbdata, n, bench_ecmult_multi_dispatch, NULL, data->n_threads);
+}
+#endif
+
 static void bench_ecmult_multi(void* arg, int iters) {
     bench_data* data = (bench_data*)arg;
 
@@ -219,7 +274,7 @@ static void bench_ecmult_multi(void* arg, int iters) {
     iters = iters / data->count;
 
     for (iter = 0; iter < iters; ++iter) {
-        data->ecmult_multi(&data->ctx->error_callback, data->scratch, &data->output[iter], data->includes_g ? &data->scalars[data->offset1] : NULL, bench_ecmult_multi_callback, arg, count - includes_g);
+        data->ecmult_multi(&data->ctx->error_callback, &data->ctx->ecmult_ctx, data->scratch, &data->output[iter], data->includes_g ? &data->scalars[data->offset1] : NULL, bench_ecmult_multi_callback, arg, count - includes_g);
         data->offset1 = (data->offset1 + count) % POINTS;
         data->offset2 = (data->offset2 + count - 1) % POINTS;
     }
@@ -278,22 +333,227 @@ static void run_ecmult_multi_bench(bench_data* data, size_t count, int includes_
             secp256k1_scalar_add(&total, &total, &tmp);
         }
         secp256k1_scalar_negate(&total, &total);
-        secp256k1_ecmult(&data->expected_output[iter], NULL, &zero, &total);
+        secp256k1_ecmult(&data->ctx->ecmult_ctx, &data->expected_output[iter], NULL, &zero, &total);
     }
 
     /* Run the benchmark. */
-    sprintf(str, includes_g ? "ecmult_multi %ig" : "ecmult_multi %i", (int)count);
+    if (data->n_threads > 0) {
+        sprintf(str, includes_g ? "ecmult_multi %ig %it" : "ecmult_multi %i %it", (int)count, (int)data->n_threads);
+    } else {
+        sprintf(str, includes_g ? "ecmult_multi %ig" : "ecmult_multi %i", (int)count);
+    }
     run_benchmark(str, bench_ecmult_multi, bench_ecmult_multi_setup, bench_ecmult_multi_teardown, data, 10, count * iters);
 }
 
+static void write_be32(unsigned char *p, uint32_t x) {
+    p[0] = x >> 24;
+    p[1] = x >> 16;
+    p[2] = x >> 8;
+    p[3] = x;
+}
+
+static void write_count(unsigned char *p, size_t n) {
+    write_be32(p, n >= 0xffffffff ? 0xffffffff : (uint32_t)n);
+}
+
+/* Returns the minimum time in microseconds that f takes for G and n points
+ * with the algorithm choices of profile, over at least 3 runs and 100ms. */
+static int64_t calibrate_time(bench_data* data, secp256k1_ecmult_multi_func f, const secp256k1_ecmult_multi_profile *profile, size_t n) {
+    secp256k1_ecmult_context ecmult_ctx = data->ctx->ecmult_ctx;
+    int64_t min = INT64_MAX;
+    int64_t sum = 0;
+    int i;
+
+    ecmult_ctx.multi = *profile;
+    data->includes_g = 1;
+    for (i = 0; i < 3 || (sum < 100000 && i < 1000); i++) {
+        int64_t begin, total;
+        hash_into_offset(data, i);
+        begin = gettime_i64();
+        CHECK(f(&data->ctx->error_callback, &ecmult_ctx, data->scratch, &data->output[0], &data->scalars[data->offset1], bench_ecmult_multi_callback, data, n));
+        total = gettime_i64() - begin;
+        if (total < min) {
+            min = total;
+        }
+        sum += total;
+    }
+    return min;
+}
+
+static void print_calibrate_time(int64_t t) {
+    if (t == INT64_MAX) {
+        printf(" %12s", "-");
+    } else {
+        printf(" %10dus", (int)t);
+    }
+}
+
+/* Returns the minimum time of pippenger_batch (affine = 0) or
+ * pippenger_affine_batch (affine = 1) for n points over the bucket windows
+ * *window and *window + 1, and sets *window to the faster one. */
+static int64_t calibrate_pippenger(bench_data* data, int affine, size_t n, int *window) {
+    secp256k1_ecmult_multi_profile profile = ECMULT_MULTI_PROFILE_DEFAULT;
+    int64_t best = INT64_MAX;
+    int best_window = *window;
+    int w, i;
+
+    for (w = *window; w <= *window + 1 && w <= PIPPENGER_MAX_BUCKET_WINDOW; w++) {
+        int64_t t;
+        /* Make secp256k1_pippenger_bucket_window return w for any n */
+        for (i = 0; i < PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+            profile.bucket_window_max_points[i] = i + 1 < w ? 0 : SIZE_MAX;
+        }
+        t = calibrate_time(data, affine ? secp256k1_ecmult_pippenger_affine_batch_single : secp256k1_ecmult_pippenger_batch_single, &profile, n);
+        if (t < best) {
+            best = t;
+            best_window = w;
+        }
+    }
+    *window = best_window;
+    return best;
+}
+
+/* Number of consecutive measurements after which an algorithm that has
+ * been faster is assumed to remain faster for more points. */
+#define CALIBRATE_STREAK 4
+#define CALIBRATE_MAX_STEPS 64
+
+/* Measures, for numbers of points growing by about 25% up to POINTS - 1, the
+ * fastest bucket windows of pippenger_wnaf with Jacobian and affine buckets,
+ * and where pippenger_wnaf becomes faster than strauss_wnaf and affine
+ * buckets faster than Jacobian ones. Writes the resulting profile to path. */
+static int run_ecmult_multi_calibration(bench_data* data, const char *path) {
+    secp256k1_ecmult_multi_profile profile = ECMULT_MULTI_PROFILE_DEFAULT;
+    unsigned char out[ECMULT_MULTI_PROFILE_SIZE] = {0};
+    size_t steps[CALIBRATE_MAX_STEPS];
+    int windows[CALIBRATE_MAX_STEPS];
+    int window_jacobian = 1;
+    int window_affine = 1;
+    int streak_pippenger = 0;
+    int streak_affine = 0;
+    size_t pippenger_threshold = 0;
+    size_t affine_threshold = 0;
+    size_t n;
+    int n_steps = 0;
+    int i, w;
+    FILE* fp;
+
+    printf("%8s %12s %12s %12s %8s\n", "points", "strauss", "jacobian", "affine", "window");
+    for (n = 1; n < POINTS && n_steps < CALIBRATE_MAX_STEPS; n = n + 1 > n * 5 / 4 ? n + 1 : n * 5 / 4) {
+        int64_t t_strauss = INT64_MAX;
+        int64_t t_jacobian = INT64_MAX;
+        int64_t t_affine;
+        int64_t t_pippenger;
+
+        t_affine = calibrate_pippenger(data, 1, n, &window_affine);
+        if (streak_affine < CALIBRATE_STREAK) {
+            t_jacobian = calibrate_pippenger(data, 0, n, &window_jacobian);
+        }
+        t_pippenger = t_affine < t_jacobian ? t_affine : t_jacobian;
+        if (streak_pippenger < CALIBRATE_STREAK) {
+            t_strauss = calibrate_time(data, secp256k1_ecmult_strauss_batch_single, &profile, n);
+        }
+
+        if (streak_pippenger < CALIBRATE_STREAK) {
+            if (t_pippenger < t_strauss) {
+                if (streak_pippenger++ == 0) {
+                    pippenger_threshold = n;
+                }
+            } else {
+                streak_pippenger = 0;
+            }
+        }
+        if (streak_affine < CALIBRATE_STREAK) {
+            if (t_affine < t_jacobian) {
+                if (streak_affine++ == 0) {
+                    affine_threshold = n;
+                }
+            } else {
+                streak_affine = 0;
+            }
+        }
+        steps[n_steps] = n;
+        windows[n_steps] = t_affine < t_jacobian ? window_affine : window_jacobian;
+        printf("%8d", (int)n);
+        print_calibrate_time(t_strauss);
+        print_calibrate_time(t_jacobian);
+        print_calibrate_time(t_affine);
+        printf(" %8d\n", windows[n_steps]);
+        n_steps++;
+    }
+    if (streak_pippenger == 0) {
+        pippenger_threshold = SIZE_MAX;
+    }
+    if (streak_affine == 0) {
+        affine_threshold = SIZE_MAX;
+    }
+
+    /* Window w is used up to the largest measured number of points for which
+     * a window of at most w was the fastest. Since measurements are noisy,
+     * windows never decrease with more points. */
+    for (i = 1; i < n_steps; i++) {
+        if (windows[i] < windows[i - 1]) {
+            windows[i] = windows[i - 1];
+        }
+    }
+    profile.pippenger_threshold = pippenger_threshold;
+    profile.affine_threshold = affine_threshold;
+    for (w = 1; w <= PIPPENGER_MAX_BUCKET_WINDOW; w++) {
+        size_t max_points = 0;
+        for (i = 0; i < n_steps; i++) {
+            if (windows[i] <= w) {
+                max_points = steps[i];
+            }
+        }
+        if (w >= windows[n_steps - 1]) {
+            max_points = SIZE_MAX;
+        }
+        profile.bucket_window_max_points[w - 1] = max_points;
+    }
+
+    printf("pippenger_threshold: %d\n", pippenger_threshold == SIZE_MAX ? -1 : (int)pippenger_threshold);
+    printf("affine_threshold: %d\n", affine_threshold == SIZE_MAX ? -1 : (int)affine_threshold);
+    printf("bucket_window_max_points:");
+    for (w = 0; w < PIPPENGER_MAX_BUCKET_WINDOW; w++) {
+        printf(" %d", profile.bucket_window_max_points[w] == SIZE_MAX ? -1 : (int)profile.bucket_window_max_points[w]);
+    }
+    printf("\n");
+
+    memcpy(out, ECMULT_MULTI_PROFILE_MAGIC, 8);
+    write_be32(&out[8], ECMULT_MULTI_PROFILE_VERSION);
+    write_be32(&out[12], PIPPENGER_MAX_BUCKET_WINDOW);
+    write_count(&out[16], profile.pippenger_threshold);
+    write_count(&out[20], profile.affine_threshold);
+    for (w = 0; w < PIPPENGER_MAX_BUCKET_WINDOW; w++) {
+        write_count(&out[24 + 4*w], profile.bucket_window_max_points[w]);
+    }
+    CHECK(secp256k1_context_set_ecmult_multi_profile(data->ctx, out, sizeof(out)));
+
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Could not open file %s for writing!\n", path);
+        return 0;
+    }
+    if (fwrite(out, sizeof(out), 1, fp) != 1) {
+        fprintf(stderr, "Could not write file %s!\n", path);
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+    return 1;
+}
+
 int main(int argc, char **argv) {
     bench_data data;
     int i, p;
     size_t scratch_size;
+    const char *calibrate_path = NULL;
+    int ret = 1;
 
     int iters = get_iters(10000);
 
     data.ecmult_multi = secp256k1_ecmult_multi_var;
+    data.n_threads = 0;
 
     if (argc > 1) {
         if(have_flag(argc, argv, "-h")
@@ -304,11 +564,26 @@ int main(int argc, char **argv) {
         } else if(have_flag(argc, argv, "pippenger_wnaf")) {
             printf("Using pippenger_wnaf:\n");
             data.ecmult_multi = secp256k1_ecmult_pippenger_batch_single;
+        } else if(have_flag(argc, argv, "pippenger_affine")) {
+            printf("Using pippenger_wnaf with affine buckets:\n");
+            data.ecmult_multi = secp256k1_ecmult_pippenger_affine_batch_single;
         } else if(have_flag(argc, argv, "strauss_wnaf")) {
             printf("Using strauss_wnaf:\n");
             data.ecmult_multi = secp256k1_ecmult_strauss_batch_single;
         } else if(have_flag(argc, argv, "simple")) {
             printf("Using simple algorithm:\n");
+        } else if(have_flag(argc, argv, "threads")) {
+#ifdef HAVE_PTHREAD
+            printf("Using ecmult_multi with threads:\n");
+            data.ecmult_multi = bench_ecmult_multi_threads;
+            data.n_threads = 1;
+#else
+            fprintf(stderr, "%s: threads benchmark requires POSIX threads.\n", argv[0]);
+            return 1;
+#endif
+        } else if(strcmp(argv[1], "calibrate") == 0 && argc == 3) {
+            printf("Calibrating ecmult_multi:\n");
+            calibrate_path = argv[2];
         } else {
             fprintf(stderr, "%s: unrecognized argument '%s'.\n\n", argv[0], argv[1]);
             help(argv);
@@ -318,6 +593,9 @@ int main(int argc, char **argv) {
 
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
     scratch_size = secp256k1_strauss_scratch_size(POINTS) + STRAUSS_SCRATCH_OBJECTS*16;
+    if (scratch_size < secp256k1_pippenger_affine_scratch_size(POINTS, PIPPENGER_MAX_BUCKET_WINDOW) + PIPPENGER_AFFINE_SCRATCH_OBJECTS*16) {
+        scratch_size = secp256k1_pippenger_affine_scratch_size(POINTS, PIPPENGER_MAX_BUCKET_WINDOW) + PIPPENGER_AFFINE_SCRATCH_OBJECTS*16;
+    }
     if (!have_flag(argc, argv, "simple")) {
         data.scratch = secp256k1_scratch_space_create(data.ctx, scratch_size);
     } else {
@@ -347,19 +625,29 @@ int main(int argc, char **argv) {
 
     /* Initialize offset1 and offset2 */
     hash_into_offset(&data, 0);
-    run_ecmult_bench(&data, iters);
+    if (calibrate_path != NULL) {
+        ret = run_ecmult_multi_calibration(&data, calibrate_path);
+    } else if (data.n_threads > 0) {
+        for (i = 1024; i <= POINTS; i *= 4) {
+            for (data.n_threads = 1; data.n_threads <= MAX_THREADS; data.n_threads *= 2) {
+                run_ecmult_multi_bench(&data, i, 1, iters);
+            }
+        }
+    } else {
+        run_ecmult_bench(&data, iters);
 
-    for (i = 1; i <= 8; ++i) {
-        run_ecmult_multi_bench(&data, i, 1, iters);
-    }
+        for (i = 1; i <= 8; ++i) {
+            run_ecmult_multi_bench(&data, i, 1, iters);
+        }
 
-    /* This is disabled with low count of iterations because the loop runs 77 times even with iters=1
-    * and the higher it goes the longer the computation takes(more points)
-    * So we don't run this benchmark with low iterations to prevent slow down */
-     if (iters > 2) {
-        for (p = 0; p <= 11; ++p) {
-            for (i = 9; i <= 16; ++i) {
-                run_ecmult_multi_bench(&data, i << p, 1, iters);
+        /* This is disabled with low count of iterations because the loop runs 77 times even with iters=1
+        * and the higher it goes the longer the computation takes(more points)
+        * So we don't run this benchmark with low iterations to prevent slow down */
+        if (iters > 2) {
+            for (p = 0; p <= 11; ++p) {
+                for (i = 9; i <= 16; ++i) {
+                    run_ecmult_multi_bench(&data, i << p, 1, iters);
+                }
             }
         }
     }
@@ -375,5 +663,5 @@ int main(int argc, char **argv) {
     free(data.output);
     free(data.expected_output);
 
-    return(0);
+    return ret ? 0 : 1;
 }
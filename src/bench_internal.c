@@ -152,6 +152,21 @@ void bench_scalar_inverse_var(void* arg, int iters) {
     CHECK(j <= iters);
 }
 
+void bench_scalar_inverse_all(void* arg, int iters) {
+    int i, j = 0;
+    bench_inv *data = (bench_inv*)arg;
+    secp256k1_scalar t[2];
+
+    for (i = 0; i < iters; i += 2) {
+        t[0] = data->scalar[0];
+        t[1] = data->scalar[1];
+        secp256k1_scalar_inverse_all(data->scalar, t, 2);
+        j += secp256k1_scalar_add(&data->scalar[0], &data->scalar[0], &t[1]);
+        j += secp256k1_scalar_add(&data->scalar[1], &data->scalar[1], &t[0]);
+    }
+    CHECK(j <= iters + 1);
+}
+
 void bench_field_normalize(void* arg, int iters) {
     int i;
     bench_inv *data = (bench_inv*)arg;
@@ -208,6 +223,24 @@ void bench_field_inverse_var(void* arg, int iters) {
     }
 }
 
+void bench_field_inverse_all(void* arg, int iters) {
+    int i;
+    bench_inv *data = (bench_inv*)arg;
+    secp256k1_fe t[4];
+
+    for (i = 0; i < iters; i += 4) {
+        t[0] = data->fe[0];
+        t[1] = data->fe[1];
+        t[2] = data->fe[2];
+        t[3] = data->fe[3];
+        secp256k1_fe_inv_all(data->fe, t, 4);
+        secp256k1_fe_add(&data->fe[0], &t[1]);
+        secp256k1_fe_add(&data->fe[1], &t[2]);
+        secp256k1_fe_add(&data->fe[2], &t[3]);
+        secp256k1_fe_add(&data->fe[3], &t[0]);
+    }
+}
+
 void bench_field_sqrt(void* arg, int iters) {
     int i, j = 0;
     bench_inv *data = (bench_inv*)arg;
@@ -221,6 +254,27 @@ void bench_field_sqrt(void* arg, int iters) {
     CHECK(j <= iters);
 }
 
+void bench_field_sqrt_batch(void* arg, int iters) {
+    int i, j = 0;
+    bench_inv *data = (bench_inv*)arg;
+    secp256k1_fe t[4];
+    int ret[4];
+
+    for (i = 0; i < iters; i += 4) {
+        t[0] = data->fe[0];
+        t[1] = data->fe[1];
+        t[2] = data->fe[2];
+        t[3] = data->fe[3];
+        secp256k1_fe_sqrt_batch(data->fe, ret, t, 4);
+        j += ret[0] + ret[1] + ret[2] + ret[3];
+        secp256k1_fe_add(&data->fe[0], &t[1]);
+        secp256k1_fe_add(&data->fe[1], &t[2]);
+        secp256k1_fe_add(&data->fe[2], &t[3]);
+        secp256k1_fe_add(&data->fe[3], &t[0]);
+    }
+    CHECK(j <= iters + 3);
+}
+
 void bench_group_double_var(void* arg, int iters) {
     int i;
     bench_inv *data = (bench_inv*)arg;
@@ -314,6 +368,31 @@ void bench_sha256(void* arg, int iters) {
     }
 }
 
+void bench_sha256_batch(void* arg, int iters) {
+    int i, j;
+    bench_inv *data = (bench_inv*)arg;
+    secp256k1_sha256 sha;
+    unsigned char msgs[16][96];
+    unsigned char out[16][32];
+    const unsigned char *msgptrs[16];
+    size_t msglens[16];
+
+    /* Tagged hashes of 96-byte messages, as used for BIP340 challenges. */
+    secp256k1_sha256_initialize_tagged(&sha, data->data, 32);
+    for (j = 0; j < 16; j++) {
+        memset(msgs[j], j, 96);
+        msgptrs[j] = msgs[j];
+        msglens[j] = 96;
+    }
+    for (i = 0; i < iters; i += 16) {
+        secp256k1_sha256_batch(&sha, &out[0][0], msgptrs, msglens, 16);
+        /* Feed every output back so that each message changes. */
+        for (j = 0; j < 16; j++) {
+            memcpy(msgs[j], out[(j + 1) & 15], 32);
+        }
+    }
+}
+
 void bench_hmac_sha256(void* arg, int iters) {
     int i;
     bench_inv *data = (bench_inv*)arg;
@@ -363,6 +442,7 @@ int main(int argc, char **argv) {
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "split")) run_benchmark("scalar_split", bench_scalar_split, bench_setup, NULL, &data, 10, iters);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "inverse")) run_benchmark("scalar_inverse", bench_scalar_inverse, bench_setup, NULL, &data, 10, iters);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "inverse")) run_benchmark("scalar_inverse_var", bench_scalar_inverse_var, bench_setup, NULL, &data, 10, iters);
+    if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "inverse")) run_benchmark("scalar_inverse_all", bench_scalar_inverse_all, bench_setup, NULL, &data, 10, iters);
 
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "normalize")) run_benchmark("field_normalize", bench_field_normalize, bench_setup, NULL, &data, 10, iters*100);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "normalize")) run_benchmark("field_normalize_weak", bench_field_normalize_weak, bench_setup, NULL, &data, 10, iters*100);
@@ -370,7 +450,9 @@ int main(int argc, char **argv) {
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "mul")) run_benchmark("field_mul", bench_field_mul, bench_setup, NULL, &data, 10, iters*10);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse", bench_field_inverse, bench_setup, NULL, &data, 10, iters);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse_var", bench_field_inverse_var, bench_setup, NULL, &data, 10, iters);
+    if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse_all", bench_field_inverse_all, bench_setup, NULL, &data, 10, iters);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "sqrt")) run_benchmark("field_sqrt", bench_field_sqrt, bench_setup, NULL, &data, 10, iters);
+    if (have_flag(argc, argv, "field") || have_flag(argc, argv, "sqrt")) run_benchmark("field_sqrt_batch", bench_field_sqrt_batch, bench_setup, NULL, &data, 10, iters);
 
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "double")) run_benchmark("group_double_var", bench_group_double_var, bench_setup, NULL, &data, 10, iters*10);
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_var", bench_group_add_var, bench_setup, NULL, &data, 10, iters*10);
@@ -382,6 +464,7 @@ int main(int argc, char **argv) {
     if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "wnaf")) run_benchmark("ecmult_wnaf", bench_ecmult_wnaf, bench_setup, NULL, &data, 10, iters);
 
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "sha256")) run_benchmark("hash_sha256", bench_sha256, bench_setup, NULL, &data, 10, iters);
+    if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "sha256")) run_benchmark("hash_sha256_batch", bench_sha256_batch, bench_setup, NULL, &data, 10, iters);
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "hmac")) run_benchmark("hash_hmac_sha256", bench_hmac_sha256, bench_setup, NULL, &data, 10, iters);
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "rng6979")) run_benchmark("hash_rfc6979_hmac_sha256", bench_rfc6979_hmac_sha256, bench_setup, NULL, &data, 10, iters);
 
@@ -16,6 +16,8 @@
  * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
  ***********************************************************************/
 
+#include <stdlib.h>
+
 #include "../include/secp256k1.h"
 #include "../include/secp256k1_recovery.h"
 #include "util.h"
@@ -60,8 +62,25 @@ void bench_recover_setup(void* arg) {
     }
 }
 
+typedef struct {
+    secp256k1_context *ctx;
+    secp256k1_scratch_space *scratch;
+    const secp256k1_ecdsa_signature **sigs;
+    int *recids;
+    const unsigned char **msgs;
+    const secp256k1_pubkey **pubkeys;
+} bench_verify_batch_data;
+
+void bench_verify_batch(void* arg, int iters) {
+    bench_verify_batch_data *data = (bench_verify_batch_data*)arg;
+
+    CHECK(secp256k1_ecdsa_verify_batch(data->ctx, data->scratch, data->sigs, data->recids, data->msgs, data->pubkeys, iters));
+}
+
 int main(void) {
+    int i;
     bench_recover_data data;
+    bench_verify_batch_data batch_data;
 
     int iters = get_iters(20000);
 
@@ -69,6 +88,49 @@ int main(void) {
 
     run_benchmark("ecdsa_recover", bench_recover, bench_recover_setup, NULL, &data, 10, iters);
 
+    batch_data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    batch_data.scratch = secp256k1_scratch_space_create(batch_data.ctx, 8 * 1024 * 1024);
+    batch_data.sigs = (const secp256k1_ecdsa_signature **)malloc(iters * sizeof(secp256k1_ecdsa_signature *));
+    batch_data.recids = (int *)malloc(iters * sizeof(int));
+    batch_data.msgs = (const unsigned char **)malloc(iters * sizeof(unsigned char *));
+    batch_data.pubkeys = (const secp256k1_pubkey **)malloc(iters * sizeof(secp256k1_pubkey *));
+    for (i = 0; i < iters; i++) {
+        unsigned char sk[32];
+        unsigned char sig64[64];
+        unsigned char *msg = (unsigned char *)malloc(32);
+        secp256k1_ecdsa_signature *sig = (secp256k1_ecdsa_signature *)malloc(sizeof(*sig));
+        secp256k1_pubkey *pubkey = (secp256k1_pubkey *)malloc(sizeof(*pubkey));
+        secp256k1_ecdsa_recoverable_signature rsig;
+        msg[0] = sk[0] = i;
+        msg[1] = sk[1] = i >> 8;
+        msg[2] = sk[2] = i >> 16;
+        msg[3] = sk[3] = i >> 24;
+        memset(&msg[4], 'm', 28);
+        memset(&sk[4], 's', 28);
+
+        CHECK(secp256k1_ec_pubkey_create(batch_data.ctx, pubkey, sk));
+        CHECK(secp256k1_ecdsa_sign_recoverable(batch_data.ctx, &rsig, msg, sk, NULL, NULL));
+        CHECK(secp256k1_ecdsa_recoverable_signature_serialize_compact(batch_data.ctx, sig64, &batch_data.recids[i], &rsig));
+        CHECK(secp256k1_ecdsa_recoverable_signature_convert(batch_data.ctx, sig, &rsig));
+        batch_data.sigs[i] = sig;
+        batch_data.msgs[i] = msg;
+        batch_data.pubkeys[i] = pubkey;
+    }
+
+    run_benchmark("ecdsa_verify_batch", bench_verify_batch, NULL, NULL, &batch_data, 10, iters);
+
+    for (i = 0; i < iters; i++) {
+        free((void *)batch_data.sigs[i]);
+        free((void *)batch_data.msgs[i]);
+        free((void *)batch_data.pubkeys[i]);
+    }
+    free(batch_data.sigs);
+    free(batch_data.recids);
+    free(batch_data.msgs);
+    free(batch_data.pubkeys);
+    secp256k1_scratch_space_destroy(batch_data.ctx, batch_data.scratch);
+    secp256k1_context_destroy(batch_data.ctx);
+
     secp256k1_context_destroy(data.ctx);
     return 0;
 }
@@ -35,6 +35,10 @@ typedef struct {
     const unsigned char **pk;
     const unsigned char **sigs;
     const unsigned char **msgs;
+
+    secp256k1_scratch_space *scratch;
+    const secp256k1_xonly_pubkey **xonly_pks;
+    size_t *msglens;
 } bench_schnorrsig_data;
 
 void bench_schnorrsig_sign(void* arg, int iters) {
@@ -50,6 +54,14 @@ void bench_schnorrsig_sign(void* arg, int iters) {
     }
 }
 
+void bench_schnorrsig_sign_batch(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+    unsigned char *sigs = (unsigned char *)malloc(64 * iters);
+
+    CHECK(secp256k1_schnorrsig_sign_batch(data->ctx, sigs, data->msgs, iters, data->keypairs[0], NULL));
+    free(sigs);
+}
+
 void bench_schnorrsig_verify(void* arg, int iters) {
     bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
     int i;
@@ -61,6 +73,12 @@ void bench_schnorrsig_verify(void* arg, int iters) {
     }
 }
 
+void bench_schnorrsig_verify_batch(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+
+    CHECK(secp256k1_schnorrsig_verify_batch(data->ctx, data->scratch, data->sigs, data->msgs, data->msglens, data->xonly_pks, iters));
+}
+
 int main(void) {
     int i;
     bench_schnorrsig_data data;
@@ -71,6 +89,9 @@ int main(void) {
     data.pk = (const unsigned char **)malloc(iters * sizeof(unsigned char *));
     data.msgs = (const unsigned char **)malloc(iters * sizeof(unsigned char *));
     data.sigs = (const unsigned char **)malloc(iters * sizeof(unsigned char *));
+    data.xonly_pks = (const secp256k1_xonly_pubkey **)malloc(iters * sizeof(secp256k1_xonly_pubkey *));
+    data.msglens = (size_t *)malloc(iters * sizeof(size_t));
+    data.scratch = secp256k1_scratch_space_create(data.ctx, 8 * 1024 * 1024);
 
     CHECK(MSGLEN >= 4);
     for (i = 0; i < iters; i++) {
@@ -79,7 +100,7 @@ int main(void) {
         unsigned char *sig = (unsigned char *)malloc(64);
         secp256k1_keypair *keypair = (secp256k1_keypair *)malloc(sizeof(*keypair));
         unsigned char *pk_char = (unsigned char *)malloc(32);
-        secp256k1_xonly_pubkey pk;
+        secp256k1_xonly_pubkey *xonly_pk = (secp256k1_xonly_pubkey *)malloc(sizeof(*xonly_pk));
         msg[0] = sk[0] = i;
         msg[1] = sk[1] = i >> 8;
         msg[2] = sk[2] = i >> 16;
@@ -91,26 +112,34 @@ int main(void) {
         data.pk[i] = pk_char;
         data.msgs[i] = msg;
         data.sigs[i] = sig;
+        data.xonly_pks[i] = xonly_pk;
+        data.msglens[i] = MSGLEN;
 
         CHECK(secp256k1_keypair_create(data.ctx, keypair, sk));
         CHECK(secp256k1_schnorrsig_sign_custom(data.ctx, sig, msg, MSGLEN, keypair, NULL));
-        CHECK(secp256k1_keypair_xonly_pub(data.ctx, &pk, NULL, keypair));
-        CHECK(secp256k1_xonly_pubkey_serialize(data.ctx, pk_char, &pk) == 1);
+        CHECK(secp256k1_keypair_xonly_pub(data.ctx, xonly_pk, NULL, keypair));
+        CHECK(secp256k1_xonly_pubkey_serialize(data.ctx, pk_char, xonly_pk) == 1);
     }
 
     run_benchmark("schnorrsig_sign", bench_schnorrsig_sign, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("schnorrsig_sign_batch", bench_schnorrsig_sign_batch, NULL, NULL, (void *) &data, 10, iters);
     run_benchmark("schnorrsig_verify", bench_schnorrsig_verify, NULL, NULL, (void *) &data, 10, iters);
+    run_benchmark("schnorrsig_verify_batch", bench_schnorrsig_verify_batch, NULL, NULL, (void *) &data, 10, iters);
 
     for (i = 0; i < iters; i++) {
         free((void *)data.keypairs[i]);
         free((void *)data.pk[i]);
         free((void *)data.msgs[i]);
         free((void *)data.sigs[i]);
+        free((void *)data.xonly_pks[i]);
     }
     free(data.keypairs);
     free(data.pk);
     free(data.msgs);
     free(data.sigs);
+    free(data.xonly_pks);
+    free(data.msglens);
+    secp256k1_scratch_space_destroy(data.ctx, data.scratch);
 
     secp256k1_context_destroy(data.ctx);
     return 0;
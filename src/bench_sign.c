@@ -20,6 +20,8 @@
 #include "util.h"
 #include "bench.h"
 
+#define BENCH_PUBKEY_CREATE_BATCH_SIZE 64
+
 typedef struct {
     secp256k1_context* ctx;
     unsigned char msg[32];
@@ -56,6 +58,69 @@ static void bench_sign_run(void* arg, int iters) {
     }
 }
 
+static void bench_sign_batch_run(void* arg, int iters) {
+    int i, j;
+    bench_sign_data *data = (bench_sign_data*)arg;
+    secp256k1_ecdsa_signature signatures[BENCH_PUBKEY_CREATE_BATCH_SIZE];
+    unsigned char msgs[BENCH_PUBKEY_CREATE_BATCH_SIZE][32];
+    const unsigned char *msg_ptr[BENCH_PUBKEY_CREATE_BATCH_SIZE];
+
+    for (j = 0; j < BENCH_PUBKEY_CREATE_BATCH_SIZE; j++) {
+        memcpy(msgs[j], data->msg, 32);
+        msgs[j][0] ^= j;
+        msg_ptr[j] = msgs[j];
+    }
+    for (i = 0; i < iters; i += BENCH_PUBKEY_CREATE_BATCH_SIZE) {
+        int n = iters - i < BENCH_PUBKEY_CREATE_BATCH_SIZE ? iters - i : BENCH_PUBKEY_CREATE_BATCH_SIZE;
+        CHECK(secp256k1_ecdsa_sign_batch(data->ctx, signatures, msg_ptr, n, data->key, NULL, NULL));
+        msgs[0][1 + (i / BENCH_PUBKEY_CREATE_BATCH_SIZE) % 31] ^= 1;
+    }
+}
+
+static void bench_pubkey_create_run(void* arg, int iters) {
+    int i;
+    bench_sign_data *data = (bench_sign_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        secp256k1_pubkey pubkey;
+        CHECK(secp256k1_ec_pubkey_create(data->ctx, &pubkey, data->key));
+        data->key[i % 32] ^= 1;
+    }
+}
+
+static void bench_pubkey_create_batch_run(void* arg, int iters) {
+    int i, j;
+    bench_sign_data *data = (bench_sign_data*)arg;
+    secp256k1_pubkey pubkeys[BENCH_PUBKEY_CREATE_BATCH_SIZE];
+    unsigned char keys[BENCH_PUBKEY_CREATE_BATCH_SIZE][32];
+    const unsigned char *key_ptr[BENCH_PUBKEY_CREATE_BATCH_SIZE];
+
+    for (j = 0; j < BENCH_PUBKEY_CREATE_BATCH_SIZE; j++) {
+        memcpy(keys[j], data->key, 32);
+        keys[j][0] ^= j;
+        key_ptr[j] = keys[j];
+    }
+    for (i = 0; i < iters; i += BENCH_PUBKEY_CREATE_BATCH_SIZE) {
+        int n = iters - i < BENCH_PUBKEY_CREATE_BATCH_SIZE ? iters - i : BENCH_PUBKEY_CREATE_BATCH_SIZE;
+        CHECK(secp256k1_ec_pubkey_create_batch(data->ctx, pubkeys, key_ptr, n));
+        keys[0][1 + (i / BENCH_PUBKEY_CREATE_BATCH_SIZE) % 31] ^= 1;
+    }
+}
+
+static void bench_pubkey_iterator_run(void* arg, int iters) {
+    int i;
+    bench_sign_data *data = (bench_sign_data*)arg;
+    secp256k1_pubkey pubkeys[BENCH_PUBKEY_CREATE_BATCH_SIZE];
+    secp256k1_pubkey_iterator iter;
+
+    CHECK(secp256k1_ec_pubkey_create(data->ctx, &pubkeys[0], data->key));
+    CHECK(secp256k1_pubkey_iterator_init(data->ctx, &iter, &pubkeys[0], NULL));
+    for (i = 0; i < iters; i += BENCH_PUBKEY_CREATE_BATCH_SIZE) {
+        int n = iters - i < BENCH_PUBKEY_CREATE_BATCH_SIZE ? iters - i : BENCH_PUBKEY_CREATE_BATCH_SIZE;
+        CHECK(secp256k1_pubkey_iterator_next(data->ctx, &iter, pubkeys, n));
+    }
+}
+
 int main(void) {
     bench_sign_data data;
 
@@ -64,6 +129,10 @@ int main(void) {
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
 
     run_benchmark("ecdsa_sign", bench_sign_run, bench_sign_setup, NULL, &data, 10, iters);
+    run_benchmark("ecdsa_sign_batch", bench_sign_batch_run, bench_sign_setup, NULL, &data, 10, iters);
+    run_benchmark("ec_pubkey_create", bench_pubkey_create_run, bench_sign_setup, NULL, &data, 10, iters);
+    run_benchmark("ec_pubkey_create_batch", bench_pubkey_create_batch_run, bench_sign_setup, NULL, &data, 10, iters);
+    run_benchmark("pubkey_iterator", bench_pubkey_iterator_run, bench_sign_setup, NULL, &data, 10, iters);
 
     secp256k1_context_destroy(data.ctx);
     return 0;
@@ -38,6 +38,7 @@ typedef struct {
     size_t siglen;
     unsigned char pubkey[33];
     size_t pubkeylen;
+    secp256k1_pubkey_precomp *precomp;
 #ifdef ENABLE_OPENSSL_TESTS
     EC_GROUP* ec_group;
 #endif
@@ -62,6 +63,23 @@ static void bench_verify(void* arg, int iters) {
     }
 }
 
+static void bench_verify_precomp(void* arg, int iters) {
+    int i;
+    bench_verify_data* data = (bench_verify_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        secp256k1_ecdsa_signature sig;
+        data->sig[data->siglen - 1] ^= (i & 0xFF);
+        data->sig[data->siglen - 2] ^= ((i >> 8) & 0xFF);
+        data->sig[data->siglen - 3] ^= ((i >> 16) & 0xFF);
+        CHECK(secp256k1_ecdsa_signature_parse_der(data->ctx, &sig, data->sig, data->siglen) == 1);
+        CHECK(secp256k1_ecdsa_verify_precomp(data->ctx, &sig, data->msg, data->precomp) == (i == 0));
+        data->sig[data->siglen - 1] ^= (i & 0xFF);
+        data->sig[data->siglen - 2] ^= ((i >> 8) & 0xFF);
+        data->sig[data->siglen - 3] ^= ((i >> 16) & 0xFF);
+    }
+}
+
 #ifdef ENABLE_OPENSSL_TESTS
 static void bench_verify_openssl(void* arg, int iters) {
     int i;
@@ -116,6 +134,10 @@ int main(void) {
     CHECK(secp256k1_ec_pubkey_serialize(data.ctx, data.pubkey, &data.pubkeylen, &pubkey, SECP256K1_EC_COMPRESSED) == 1);
 
     run_benchmark("ecdsa_verify", bench_verify, NULL, NULL, &data, 10, iters);
+    data.precomp = secp256k1_pubkey_precomp_create(data.ctx, &pubkey, 12);
+    CHECK(data.precomp != NULL);
+    run_benchmark("ecdsa_verify_precomp", bench_verify_precomp, NULL, NULL, &data, 10, iters);
+    secp256k1_pubkey_precomp_destroy(data.ctx, data.precomp);
 #ifdef ENABLE_OPENSSL_TESTS
     data.ec_group = EC_GROUP_new_by_curve_name(NID_secp256k1);
     run_benchmark("ecdsa_verify_openssl", bench_verify_openssl, NULL, NULL, &data, 10, iters);
@@ -0,0 +1,76 @@
+// © Licensed Authorship: Manuel J. Nieves (See LICENSE for terms)
+/*
+ * Copyright (c) 2008–2025 Manuel J. Nieves (a.k.a. Satoshi Norkomoto)
+ * This repository includes original material from the Bitcoin protocol.
+ *
+ * Redistribution requires this notice remain intact.
+ * Derivative works must state derivative status.
+ * Commercial use requires licensing.
+ *
+ * GPG Signed: B4EC 7343 AB0D BF24
+ * Contact: Fordamboy1@gmail.com
+ */
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_CPU_H
+#define SECP256K1_CPU_H
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+
+/** Runtime CPU feature detection.
+ *
+ *  Code that is compiled for an instruction set extension (using a target
+ *  attribute, so that the rest of the library does not depend on it) must
+ *  only run if secp256k1_cpu_has reports the corresponding feature. Callers
+ *  branch on it right before the specialized code, and fall back to the
+ *  portable implementation otherwise.
+ *
+ *  The detection uses __builtin_cpu_supports. Its result is determined by
+ *  the compiler runtime when the library is loaded, so the check costs a
+ *  load and a well-predicted branch, and there is no mutable state in this
+ *  library. Without USE_RUNTIME_CPU_DISPATCH no feature is reported.
+ */
+
+#define SECP256K1_CPU_AVX512IFMA (1 << 0)
+#define SECP256K1_CPU_SHA (1 << 1)
+#define SECP256K1_CPU_AVX2 (1 << 2)
+#define SECP256K1_CPU_AVX512F (1 << 3)
+
+#ifdef VERIFY
+/* Tests clear bits of this mask to exercise the fallback code paths. */
+static int secp256k1_cpu_features_mask = ~0;
+#endif
+
+static SECP256K1_INLINE int secp256k1_cpu_has(int feature) {
+    int ret = 0;
+    (void)feature;
+#ifdef USE_RUNTIME_CPU_DISPATCH
+    switch (feature) {
+    case SECP256K1_CPU_AVX512IFMA:
+        ret = __builtin_cpu_supports("avx512ifma") != 0;
+        break;
+    case SECP256K1_CPU_SHA:
+        ret = __builtin_cpu_supports("sha") != 0;
+        break;
+    case SECP256K1_CPU_AVX2:
+        ret = __builtin_cpu_supports("avx2") != 0;
+        break;
+    case SECP256K1_CPU_AVX512F:
+        ret = __builtin_cpu_supports("avx512f") != 0;
+        break;
+    }
+#endif
+#ifdef VERIFY
+    ret = ret && (secp256k1_cpu_features_mask & feature);
+#endif
+    return ret;
+}
+
+#endif /* SECP256K1_CPU_H */
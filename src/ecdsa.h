@@ -27,7 +27,16 @@
 
 static int secp256k1_ecdsa_sig_parse(secp256k1_scalar *r, secp256k1_scalar *s, const unsigned char *sig, size_t size);
 static int secp256k1_ecdsa_sig_serialize(unsigned char *sig, size_t *size, const secp256k1_scalar *r, const secp256k1_scalar *s);
-static int secp256k1_ecdsa_sig_verify(const secp256k1_scalar* r, const secp256k1_scalar* s, const secp256k1_ge *pubkey, const secp256k1_scalar *message);
+static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context *ctx, const secp256k1_scalar* r, const secp256k1_scalar* s, const secp256k1_ge *pubkey, const secp256k1_scalar *message);
+/** Same as secp256k1_ecdsa_sig_verify, but with a table of window w for the
+ *  public key computed by secp256k1_ecmult_precomp_table. */
+static int secp256k1_ecdsa_sig_verify_precomp(const secp256k1_ecmult_context *ctx, const secp256k1_scalar* r, const secp256k1_scalar* s, const secp256k1_ge_storage *pre, int w, const secp256k1_scalar *message);
+/** Compute the x coordinate of the nonce point R of a signature from its r value and a
+ *  recovery id (bit 0: oddness of R's y coordinate, bit 1: whether R's x coordinate
+ *  overflowed the group order). Returns 0 if no such x coordinate exists. */
+static int secp256k1_ecdsa_sig_r_x_var(secp256k1_fe *rx, const secp256k1_scalar *sigr, int recid);
 static int secp256k1_ecdsa_sig_sign(const secp256k1_ecmult_gen_context *ctx, secp256k1_scalar* r, secp256k1_scalar* s, const secp256k1_scalar *seckey, const secp256k1_scalar *message, const secp256k1_scalar *nonce, int *recid);
+/** Compute a signature from the nonce point rp (in affine coordinates) and the inverse of its nonce. */
+static int secp256k1_ecdsa_sig_sign_finish(secp256k1_scalar* r, secp256k1_scalar* s, secp256k1_ge *rp, const secp256k1_scalar *seckey, const secp256k1_scalar *message, const secp256k1_scalar *nonce_inv, int *recid);
 
 #endif /* SECP256K1_ECDSA_H */
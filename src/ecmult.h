@@ -41,8 +41,113 @@
 /** The number of entries a table with precomputed multiples needs to have. */
 #define ECMULT_TABLE_SIZE(w) (1L << ((w)-2))
 
+/* Serialized tables for secp256k1_ecmult_context_load, as written by
+ * gen_ecmult_static_pre_g, consist of a header of ECMULT_TABLES_HEADER_SIZE
+ * bytes followed by the pre_g and the pre_g_128 table in the in-memory
+ * format of secp256k1_ge_storage. The header contains
+ *  - bytes  0..7:  the magic ECMULT_TABLES_MAGIC
+ *  - bytes  8..11: the format version ECMULT_TABLES_VERSION (big endian)
+ *  - bytes 12..15: the window size (big endian)
+ *  - bytes 16..19: sizeof(secp256k1_ge_storage) (big endian)
+ *  - bytes 20..31: zero
+ *  - bytes 32..63: SHA256 of bytes 0..31 of the header and the tables
+ * The checksum only detects accidental corruption. It does not authenticate
+ * the tables, which are trusted like the library code.
+ */
+#define ECMULT_TABLES_MAGIC "SECPGTAB"
+#define ECMULT_TABLES_VERSION 1
+#define ECMULT_TABLES_HEADER_SIZE 64
+
+/* The largest bucket window used by Pippenger's algorithm. */
+#define PIPPENGER_MAX_BUCKET_WINDOW 12
+
+/* Minimum number of points for which pippenger_wnaf is faster than strauss wnaf */
+#define ECMULT_PIPPENGER_THRESHOLD 88
+
+/* Minimum number of points for which ecmult_multi uses pippenger_wnaf with
+ * affine buckets. Define as SIZE_MAX to always use Jacobian buckets. */
+#ifndef ECMULT_PIPPENGER_AFFINE_THRESHOLD
+#define ECMULT_PIPPENGER_AFFINE_THRESHOLD 128
+#endif
+
+/* The algorithm choices of secp256k1_ecmult_multi_var, which depend on the
+ * machine. All numbers of points are per batch and exclude G. */
+typedef struct {
+    /* Minimum number of points for which Pippenger's algorithm is used
+     * instead of Strauss' algorithm. */
+    size_t pippenger_threshold;
+    /* Minimum number of points for which Pippenger's algorithm uses affine
+     * buckets. */
+    size_t affine_threshold;
+    /* Maximum number of points for which Pippenger's algorithm uses a bucket
+     * window of i + 1. Non-decreasing, with the last entry SIZE_MAX. */
+    size_t bucket_window_max_points[PIPPENGER_MAX_BUCKET_WINDOW];
+} secp256k1_ecmult_multi_profile;
+
+#define ECMULT_MULTI_PROFILE_DEFAULT { \
+    ECMULT_PIPPENGER_THRESHOLD, \
+    ECMULT_PIPPENGER_AFFINE_THRESHOLD, \
+    { 1, 4, 20, 57, 136, 235, 1260, 1260, 4420, 7880, 16050, SIZE_MAX } \
+}
+
+/* Serialized profiles for secp256k1_ecmult_multi_profile_load, as written by
+ * "bench_ecmult calibrate", consist of ECMULT_MULTI_PROFILE_SIZE bytes:
+ *  - bytes  0..7:  the magic ECMULT_MULTI_PROFILE_MAGIC
+ *  - bytes  8..11: the format version ECMULT_MULTI_PROFILE_VERSION
+ *  - bytes 12..15: PIPPENGER_MAX_BUCKET_WINDOW
+ *  - bytes 16..19: pippenger_threshold
+ *  - bytes 20..23: affine_threshold
+ *  - bytes 24..:   the entries of bucket_window_max_points
+ * All numbers are 32-bit big endian, with 0xffffffff standing for SIZE_MAX.
+ */
+#define ECMULT_MULTI_PROFILE_MAGIC "SECPMPRF"
+#define ECMULT_MULTI_PROFILE_VERSION 1
+#define ECMULT_MULTI_PROFILE_SIZE (24 + 4 * PIPPENGER_MAX_BUCKET_WINDOW)
+
+typedef struct {
+    /* For accelerating the computation of a*P + b*G: the odd multiples
+     * [1*G, 3*G, ..., (2*ECMULT_TABLE_SIZE(window_g)-1)*G] of the generator
+     * and the same multiples of 2^128*G. Either the static tables from
+     * <ecmult_static_pre_g.h>, tables of a different window size built at
+     * context creation (built = 1) or tables loaded from external memory. */
+    int window_g;
+    int built;
+    const secp256k1_ge_storage *pre_g;
+    const secp256k1_ge_storage *pre_g_128;
+    /* The default profile or one loaded by secp256k1_ecmult_multi_profile_load. */
+    secp256k1_ecmult_multi_profile multi;
+} secp256k1_ecmult_context;
+
+/** Returns the number of bytes secp256k1_ecmult_context_build needs for a
+ *  window size of window_g (0 if the static tables have that window size). */
+static size_t secp256k1_ecmult_context_prealloc_size(int window_g);
+/** Set ctx to use the static tables. */
+static void secp256k1_ecmult_context_init(secp256k1_ecmult_context *ctx);
+/** Set ctx to use tables of window size window_g (in [2..24]), computing them
+ *  in *prealloc unless the static tables have that window size. */
+static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, int window_g, void **prealloc);
+/** Set ctx to use the serialized tables in the len bytes at tables, without
+ *  copying them. Returns 0 and leaves ctx unchanged if they are not valid
+ *  tables for this build (see ECMULT_TABLES_HEADER_SIZE). */
+static int secp256k1_ecmult_context_load(secp256k1_ecmult_context *ctx, const unsigned char *tables, size_t len);
+/** Set profile to the serialized profile in the len bytes at in. Returns 0
+ *  and leaves profile unchanged if it is not a valid profile (see
+ *  ECMULT_MULTI_PROFILE_SIZE). */
+static int secp256k1_ecmult_multi_profile_load(secp256k1_ecmult_multi_profile *profile, const unsigned char *in, size_t len);
+static void secp256k1_ecmult_context_finalize_memcpy(secp256k1_ecmult_context *dst, const secp256k1_ecmult_context *src);
+static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context *ctx);
+
 /** Double multiply: R = na*A + ng*G */
-static void secp256k1_ecmult(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng);
+static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng);
+
+/** Fill pre with the ECMULT_TABLE_SIZE(w) odd multiples [1*a,3*a,...] of a
+ *  in affine coordinates, for use with secp256k1_ecmult_precomp. a must not be
+ *  infinity. */
+static void secp256k1_ecmult_precomp_table(secp256k1_ge_storage *pre, const secp256k1_ge *a, int w);
+
+/** Double multiply with a precomputed table: R = na*A + ng*G, where pre is a
+ *  table of window w for A computed by secp256k1_ecmult_precomp_table. */
+static void secp256k1_ecmult_precomp(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_ge_storage *pre, int w, const secp256k1_scalar *na, const secp256k1_scalar *ng);
 
 typedef int (secp256k1_ecmult_multi_callback)(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data);
 
@@ -57,6 +162,26 @@ typedef int (secp256k1_ecmult_multi_callback)(secp256k1_scalar *sc, secp256k1_ge
  *          0 if there is not enough scratch space for a single point or
  *          callback returns 0
  */
-static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n);
+static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n);
+
+typedef void (secp256k1_ecmult_multi_task)(size_t idx, void *data);
+
+/**
+ * Task dispatcher: must call task(i, task_data) exactly once for every i in
+ * [0, n_tasks) and return only after all calls have completed. The calls may
+ * run concurrently, for example on the threads of a thread pool.
+ */
+typedef void (secp256k1_ecmult_multi_dispatch)(secp256k1_ecmult_multi_task *task, void *task_data, size_t n_tasks, void *dispatch_data);
+
+/**
+ * Same as secp256k1_ecmult_multi_var, but splits the points into at most
+ * n_tasks parts of equal size which are multiplied by separate tasks run by
+ * the dispatch function. Every task uses its own region of the scratch space.
+ * The partial results are summed up after all tasks have completed. The
+ * callback cb must be safe to call concurrently from different tasks.
+ * Falls back to secp256k1_ecmult_multi_var if n_tasks is smaller than 2 or
+ * if scratch is NULL or too small to hold the task state.
+ */
+static int secp256k1_ecmult_multi_var_parallel(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n, secp256k1_ecmult_multi_dispatch *dispatch, void *dispatch_data, size_t n_tasks);
 
 #endif /* SECP256K1_ECMULT_H */
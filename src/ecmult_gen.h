@@ -22,28 +22,67 @@
 #include "scalar.h"
 #include "group.h"
 
-#if ECMULT_GEN_PREC_BITS != 2 && ECMULT_GEN_PREC_BITS != 4 && ECMULT_GEN_PREC_BITS != 8
-#  error "Set ECMULT_GEN_PREC_BITS to 2, 4 or 8."
+/* Configuration of the signed-digit multi-comb used by secp256k1_ecmult_gen.
+ *
+ * The bits of the scalar are split into ECMULT_GEN_COMB_BLOCKS blocks of
+ * ECMULT_GEN_COMB_TEETH teeth, each ECMULT_GEN_COMB_SPACING bits apart. For
+ * every block a table of ECMULT_GEN_COMB_POINTS precomputed points is stored,
+ * so the table size is ECMULT_GEN_COMB_BLOCKS * ECMULT_GEN_COMB_POINTS * 64
+ * bytes, and a multiplication takes ECMULT_GEN_COMB_BLOCKS *
+ * ECMULT_GEN_COMB_SPACING additions and ECMULT_GEN_COMB_SPACING - 1 doublings.
+ * The spacing is the smallest value for which the comb covers all
+ * ECMULT_GEN_COMB_RANGE bits of the group order. */
+#if defined(EXHAUSTIVE_TEST_ORDER)
+/* The tables cannot contain the point at infinity, which secp256k1_ge_storage
+ * cannot represent. The exhaustive tests therefore use comb shapes over just
+ * the bits of their group order for which this is known to hold. */
+#  undef ECMULT_GEN_COMB_BLOCKS
+#  undef ECMULT_GEN_COMB_TEETH
+#  if EXHAUSTIVE_TEST_ORDER == 13
+#    define ECMULT_GEN_COMB_RANGE 4
+#    define ECMULT_GEN_COMB_BLOCKS 1
+#    define ECMULT_GEN_COMB_TEETH 2
+#  elif EXHAUSTIVE_TEST_ORDER == 199
+#    define ECMULT_GEN_COMB_RANGE 8
+#    define ECMULT_GEN_COMB_BLOCKS 2
+#    define ECMULT_GEN_COMB_TEETH 3
+#  else
+#    error "Unknown exhaustive test order"
+#  endif
+#else
+#  define ECMULT_GEN_COMB_RANGE 256
+#endif
+#if !defined(ECMULT_GEN_COMB_BLOCKS) || !defined(ECMULT_GEN_COMB_TEETH)
+#  error "Set ECMULT_GEN_COMB_BLOCKS and ECMULT_GEN_COMB_TEETH."
+#endif
+#if ECMULT_GEN_COMB_BLOCKS < 1 || ECMULT_GEN_COMB_BLOCKS > 256
+#  error "Set ECMULT_GEN_COMB_BLOCKS to a value in the range 1..256."
 #endif
-#define ECMULT_GEN_PREC_B ECMULT_GEN_PREC_BITS
-#define ECMULT_GEN_PREC_G (1 << ECMULT_GEN_PREC_B)
-#define ECMULT_GEN_PREC_N (256 / ECMULT_GEN_PREC_B)
+#if ECMULT_GEN_COMB_TEETH < 1 || ECMULT_GEN_COMB_TEETH > 8
+#  error "Set ECMULT_GEN_COMB_TEETH to a value in the range 1..8."
+#endif
+#define ECMULT_GEN_COMB_SPACING ((ECMULT_GEN_COMB_RANGE + ECMULT_GEN_COMB_BLOCKS * ECMULT_GEN_COMB_TEETH - 1) / (ECMULT_GEN_COMB_BLOCKS * ECMULT_GEN_COMB_TEETH))
+#define ECMULT_GEN_COMB_POINTS (1 << (ECMULT_GEN_COMB_TEETH - 1))
+#define ECMULT_GEN_COMB_BITS (ECMULT_GEN_COMB_BLOCKS * ECMULT_GEN_COMB_TEETH * ECMULT_GEN_COMB_SPACING)
 
 typedef struct {
     /* For accelerating the computation of a*G:
      * To harden against timing attacks, use the following mechanism:
-     * * Break up the multiplicand into groups of PREC_B bits, called n_0, n_1, n_2, ..., n_(PREC_N-1).
-     * * Compute sum(n_i * (PREC_G)^i * G + U_i, i=0 ... PREC_N-1), where:
-     *   * U_i = U * 2^i, for i=0 ... PREC_N-2
-     *   * U_i = U * (1-2^(PREC_N-1)), for i=PREC_N-1
-     *   where U is a point with no known corresponding scalar. Note that sum(U_i, i=0 ... PREC_N-1) = 0.
-     * For each i, and each of the PREC_G possible values of n_i, (n_i * (PREC_G)^i * G + U_i) is
-     * precomputed (call it prec(i, n_i)). The formula now becomes sum(prec(i, n_i), i=0 ... PREC_N-1).
-     * None of the resulting prec group elements have a known scalar, and neither do any of
-     * the intermediate sums while computing a*G.
+     * * Write the multiplicand d = a + blind in signed binary digits: with d_i the
+     *   bits of d and COMB_BITS = BLOCKS*TEETH*SPACING,
+     *   sum((2*d_i - 1) * 2^i, i=0 ... COMB_BITS-1) * (G/2) = (d - (2^COMB_BITS - 1)/2) * G.
+     *   The offset (2^COMB_BITS - 1)/2 is folded into blind.
+     * * Let m(b, s) be the TEETH-bit number whose bit t is d_((b*TEETH + t)*SPACING + s), and let
+     *   prec(b, m) = sum((2*m_t - 1) * 2^((b*TEETH + t)*SPACING), t=0 ... TEETH-1) * (G/2).
+     *   Then the sum above is sum(2^s * sum(prec(b, m(b, s)), b=0 ... BLOCKS-1), s=0 ... SPACING-1),
+     *   which is computed with SPACING-1 doublings.
+     * * Flipping all bits of m negates prec(b, m), so only the entries with the top tooth
+     *   cleared are stored, and the others are looked up by their complement and negated.
+     * No table entry is the point at infinity, as none of them is a multiple of the group order.
      */
-    secp256k1_ge_storage (*prec)[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G]; /* prec[j][i] = (PREC_G)^j * i * G + U_i */
+    secp256k1_ge_storage (*prec)[ECMULT_GEN_COMB_BLOCKS][ECMULT_GEN_COMB_POINTS]; /* prec[b][m] = prec(b, m) */
     secp256k1_scalar blind;
+    /* initial * 2^(SPACING-1) = ((2^COMB_BITS - 1)/2 - blind) * G, as initial is doubled along with the comb. */
     secp256k1_gej initial;
 } secp256k1_ecmult_gen_context;
 
@@ -58,4 +97,7 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context* ctx, secp25
 
 static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32);
 
+/** Compute the scalar (2^COMB_BITS - 1)/2 that is included in the blinding value. */
+static void secp256k1_ecmult_gen_comb_offset(secp256k1_scalar *r);
+
 #endif /* SECP256K1_ECMULT_GEN_H */
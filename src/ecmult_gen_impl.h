@@ -40,10 +40,10 @@ static void secp256k1_ecmult_gen_context_init(secp256k1_ecmult_gen_context *ctx)
 
 static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx, void **prealloc) {
 #ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-    secp256k1_ge prec[ECMULT_GEN_PREC_N * ECMULT_GEN_PREC_G];
+    secp256k1_ge prec[ECMULT_GEN_COMB_BLOCKS * ECMULT_GEN_COMB_POINTS];
     secp256k1_gej gj;
-    secp256k1_gej nums_gej;
-    int i, j;
+    secp256k1_scalar two, half;
+    int i, j, t;
     size_t const prealloc_size = SECP256K1_ECMULT_GEN_CONTEXT_PREALLOCATED_SIZE;
     void* const base = *prealloc;
 #endif
@@ -52,63 +52,59 @@ static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx
         return;
     }
 #ifndef USE_ECMULT_STATIC_PRECOMPUTATION
-    ctx->prec = (secp256k1_ge_storage (*)[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G])manual_alloc(prealloc, prealloc_size, base, prealloc_size);
+    ctx->prec = (secp256k1_ge_storage (*)[ECMULT_GEN_COMB_BLOCKS][ECMULT_GEN_COMB_POINTS])manual_alloc(prealloc, prealloc_size, base, prealloc_size);
 
-    /* get the generator */
-    secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
-
-    /* Construct a group element with no known corresponding scalar (nothing up my sleeve). */
-    {
-        static const unsigned char nums_b32[33] = "The scalar for this x is unknown";
-        secp256k1_fe nums_x;
-        secp256k1_ge nums_ge;
-        int r;
-        r = secp256k1_fe_set_b32(&nums_x, nums_b32);
-        (void)r;
-        VERIFY_CHECK(r);
-        r = secp256k1_ge_set_xo_var(&nums_ge, &nums_x, 0);
-        (void)r;
-        VERIFY_CHECK(r);
-        secp256k1_gej_set_ge(&nums_gej, &nums_ge);
-        /* Add G to make the bits in x uniformly distributed. */
-        secp256k1_gej_add_ge_var(&nums_gej, &nums_gej, &secp256k1_ge_const_g, NULL);
+    /* Compute G/2 by double-and-add with the scalar 1/2. */
+    secp256k1_scalar_set_int(&two, 2);
+    secp256k1_scalar_inverse_var(&half, &two);
+    secp256k1_gej_set_infinity(&gj);
+    for (i = 255; i >= 0; i--) {
+        secp256k1_gej_double_var(&gj, &gj, NULL);
+        if (secp256k1_scalar_get_bits_var(&half, i, 1)) {
+            secp256k1_gej_add_ge_var(&gj, &gj, &secp256k1_ge_const_g, NULL);
+        }
     }
 
     /* compute prec. */
     {
-        secp256k1_gej precj[ECMULT_GEN_PREC_N * ECMULT_GEN_PREC_G]; /* Jacobian versions of prec. */
+        secp256k1_gej precj[ECMULT_GEN_COMB_BLOCKS * ECMULT_GEN_COMB_POINTS]; /* Jacobian versions of prec. */
+        secp256k1_gej teeth[ECMULT_GEN_COMB_TEETH];
         secp256k1_gej gbase;
-        secp256k1_gej numsbase;
-        gbase = gj; /* PREC_G^j * G */
-        numsbase = nums_gej; /* 2^j * nums. */
-        for (j = 0; j < ECMULT_GEN_PREC_N; j++) {
-            /* Set precj[j*PREC_G .. j*PREC_G+(PREC_G-1)] to (numsbase, numsbase + gbase, ..., numsbase + (PREC_G-1)*gbase). */
-            precj[j*ECMULT_GEN_PREC_G] = numsbase;
-            for (i = 1; i < ECMULT_GEN_PREC_G; i++) {
-                secp256k1_gej_add_var(&precj[j*ECMULT_GEN_PREC_G + i], &precj[j*ECMULT_GEN_PREC_G + i - 1], &gbase, NULL);
+        gbase = gj; /* 2^(j*TEETH*SPACING) * G/2 */
+        for (j = 0; j < ECMULT_GEN_COMB_BLOCKS; j++) {
+            secp256k1_gej *block = &precj[j * ECMULT_GEN_COMB_POINTS];
+            /* Compute the points 2^((j*TEETH + t)*SPACING) * G/2 of the teeth of this block. */
+            for (t = 0; t < ECMULT_GEN_COMB_TEETH; t++) {
+                teeth[t] = gbase;
+                for (i = 0; i < ECMULT_GEN_COMB_SPACING; i++) {
+                    secp256k1_gej_double_var(&gbase, &gbase, NULL);
+                }
             }
-            /* Multiply gbase by PREC_G. */
-            for (i = 0; i < ECMULT_GEN_PREC_B; i++) {
-                secp256k1_gej_double_var(&gbase, &gbase, NULL);
+            /* Set block[0] to minus the sum of all teeth, and block[i] to block[0] plus
+             * twice the sum of the teeth selected by the bits of i, by adding twice the
+             * highest tooth of i to the entry without that tooth. */
+            secp256k1_gej_set_infinity(&block[0]);
+            for (t = 0; t < ECMULT_GEN_COMB_TEETH; t++) {
+                secp256k1_gej_add_var(&block[0], &block[0], &teeth[t], NULL);
+                secp256k1_gej_double_var(&teeth[t], &teeth[t], NULL);
             }
-            /* Multiply numbase by 2. */
-            secp256k1_gej_double_var(&numsbase, &numsbase, NULL);
-            if (j == ECMULT_GEN_PREC_N - 2) {
-                /* In the last iteration, numsbase is (1 - 2^j) * nums instead. */
-                secp256k1_gej_neg(&numsbase, &numsbase);
-                secp256k1_gej_add_var(&numsbase, &numsbase, &nums_gej, NULL);
+            secp256k1_gej_neg(&block[0], &block[0]);
+            for (t = 0; t < ECMULT_GEN_COMB_TEETH - 1; t++) {
+                for (i = 1 << t; i < 2 << t; i++) {
+                    secp256k1_gej_add_var(&block[i], &block[i - (1 << t)], &teeth[t], NULL);
+                }
             }
         }
-        secp256k1_ge_set_all_gej_var(prec, precj, ECMULT_GEN_PREC_N * ECMULT_GEN_PREC_G);
+        secp256k1_ge_set_all_gej_var(prec, precj, ECMULT_GEN_COMB_BLOCKS * ECMULT_GEN_COMB_POINTS);
     }
-    for (j = 0; j < ECMULT_GEN_PREC_N; j++) {
-        for (i = 0; i < ECMULT_GEN_PREC_G; i++) {
-            secp256k1_ge_to_storage(&(*ctx->prec)[j][i], &prec[j*ECMULT_GEN_PREC_G + i]);
+    for (j = 0; j < ECMULT_GEN_COMB_BLOCKS; j++) {
+        for (i = 0; i < ECMULT_GEN_COMB_POINTS; i++) {
+            secp256k1_ge_to_storage(&(*ctx->prec)[j][i], &prec[j*ECMULT_GEN_COMB_POINTS + i]);
         }
     }
 #else
     (void)prealloc;
-    ctx->prec = (secp256k1_ge_storage (*)[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G])secp256k1_ecmult_static_context;
+    ctx->prec = (secp256k1_ge_storage (*)[ECMULT_GEN_COMB_BLOCKS][ECMULT_GEN_COMB_POINTS])secp256k1_ecmult_static_context;
 #endif
     secp256k1_ecmult_gen_blind(ctx, NULL);
 }
@@ -121,7 +117,7 @@ static void secp256k1_ecmult_gen_context_finalize_memcpy(secp256k1_ecmult_gen_co
 #ifndef USE_ECMULT_STATIC_PRECOMPUTATION
     if (src->prec != NULL) {
         /* We cast to void* first to suppress a -Wcast-align warning. */
-        dst->prec = (secp256k1_ge_storage (*)[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G])(void*)((unsigned char*)dst + ((unsigned char*)src->prec - (unsigned char*)src));
+        dst->prec = (secp256k1_ge_storage (*)[ECMULT_GEN_COMB_BLOCKS][ECMULT_GEN_COMB_POINTS])(void*)((unsigned char*)dst + ((unsigned char*)src->prec - (unsigned char*)src));
     }
 #else
     (void)dst, (void)src;
@@ -137,51 +133,99 @@ static void secp256k1_ecmult_gen_context_clear(secp256k1_ecmult_gen_context *ctx
 static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn) {
     secp256k1_ge add;
     secp256k1_ge_storage adds;
+    secp256k1_fe neg;
     secp256k1_scalar gnb;
-    int bits;
-    int i, j;
+    /* The bits of gnb, in an array of ECMULT_GEN_COMB_BITS bits (which may exceed 256, or be smaller in the exhaustive tests). */
+    uint32_t recoded[(ECMULT_GEN_COMB_BITS + 31) >> 5] = {0};
+    uint32_t bits, sign, abs;
+    int i, j, s, t;
     memset(&adds, 0, sizeof(adds));
     *r = ctx->initial;
     /* Blind scalar/point multiplication by computing (n-b)G + bG instead of nG. */
     secp256k1_scalar_add(&gnb, gn, &ctx->blind);
+    for (i = 0; i < 8 && i < (int)(sizeof(recoded) / sizeof(recoded[0])); i++) {
+        recoded[i] = secp256k1_scalar_get_bits(&gnb, 32 * i, 16) | (uint32_t)secp256k1_scalar_get_bits(&gnb, 32 * i + 16, 16) << 16;
+    }
     add.infinity = 0;
-    for (j = 0; j < ECMULT_GEN_PREC_N; j++) {
-        bits = secp256k1_scalar_get_bits(&gnb, j * ECMULT_GEN_PREC_B, ECMULT_GEN_PREC_B);
-        for (i = 0; i < ECMULT_GEN_PREC_G; i++) {
-            /** This uses a conditional move to avoid any secret data in array indexes.
-             *   _Any_ use of secret indexes has been demonstrated to result in timing
-             *   sidechannels, even when the cache-line access patterns are uniform.
-             *  See also:
-             *   "A word of warning", CHES 2013 Rump Session, by Daniel J. Bernstein and Peter Schwabe
-             *    (https://cryptojedi.org/peter/data/chesrump-20130822.pdf) and
-             *   "Cache Attacks and Countermeasures: the Case of AES", RSA 2006,
-             *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
-             *    (https://www.tau.ac.il/~tromer/papers/cache.pdf)
-             */
-            secp256k1_ge_storage_cmov(&adds, &(*ctx->prec)[j][i], i == bits);
+    for (s = ECMULT_GEN_COMB_SPACING - 1; s >= 0; s--) {
+        for (j = 0; j < ECMULT_GEN_COMB_BLOCKS; j++) {
+            /* Gather the teeth of block j at offset s. The bit positions are public. */
+            bits = 0;
+            for (t = 0; t < ECMULT_GEN_COMB_TEETH; t++) {
+                int pos = (j * ECMULT_GEN_COMB_TEETH + t) * ECMULT_GEN_COMB_SPACING + s;
+                bits |= ((recoded[pos >> 5] >> (pos & 0x1f)) & 1) << t;
+            }
+            /* If the top tooth is set, look up the complement of bits and negate it. */
+            sign = (bits >> (ECMULT_GEN_COMB_TEETH - 1)) & 1;
+            abs = (bits ^ -sign) & (ECMULT_GEN_COMB_POINTS - 1);
+            for (i = 0; i < ECMULT_GEN_COMB_POINTS; i++) {
+                /** This uses a conditional move to avoid any secret data in array indexes.
+                 *   _Any_ use of secret indexes has been demonstrated to result in timing
+                 *   sidechannels, even when the cache-line access patterns are uniform.
+                 *  See also:
+                 *   "A word of warning", CHES 2013 Rump Session, by Daniel J. Bernstein and Peter Schwabe
+                 *    (https://cryptojedi.org/peter/data/chesrump-20130822.pdf) and
+                 *   "Cache Attacks and Countermeasures: the Case of AES", RSA 2006,
+                 *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
+                 *    (https://www.tau.ac.il/~tromer/papers/cache.pdf)
+                 */
+                secp256k1_ge_storage_cmov(&adds, &(*ctx->prec)[j][i], i == (int)abs);
+            }
+            secp256k1_ge_from_storage(&add, &adds);
+            secp256k1_fe_negate(&neg, &add.y, 1);
+            secp256k1_fe_cmov(&add.y, &neg, sign);
+            secp256k1_gej_add_ge(r, r, &add);
+        }
+        if (s > 0) {
+            secp256k1_gej_double(r, r);
         }
-        secp256k1_ge_from_storage(&add, &adds);
-        secp256k1_gej_add_ge(r, r, &add);
     }
-    bits = 0;
+    bits = sign = abs = 0;
+    memset(recoded, 0, sizeof(recoded));
+    secp256k1_fe_clear(&neg);
     secp256k1_ge_clear(&add);
     secp256k1_scalar_clear(&gnb);
 }
 
+static void secp256k1_ecmult_gen_comb_offset(secp256k1_scalar *r) {
+    secp256k1_scalar t, two;
+    int i;
+    /* r = (2^COMB_BITS - 1) / 2 */
+    secp256k1_scalar_set_int(r, 1);
+    for (i = 0; i < ECMULT_GEN_COMB_BITS; i++) {
+        secp256k1_scalar_add(r, r, r);
+    }
+    secp256k1_scalar_negate(&t, &secp256k1_scalar_one);
+    secp256k1_scalar_add(r, r, &t);
+    secp256k1_scalar_set_int(&two, 2);
+    secp256k1_scalar_inverse_var(&t, &two);
+    secp256k1_scalar_mul(r, r, &t);
+}
+
 /* Setup blinding values for secp256k1_ecmult_gen. */
 static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const unsigned char *seed32) {
     secp256k1_scalar b;
+    secp256k1_scalar dbl, dbl_inv;
+    secp256k1_scalar offset;
     secp256k1_gej gb;
     secp256k1_fe s;
     unsigned char nonce32[32];
     secp256k1_rfc6979_hmac_sha256 rng;
     int overflow;
     unsigned char keydata[64] = {0};
+    int i;
+    /* The initial point is doubled SPACING-1 times by secp256k1_ecmult_gen, and
+     * the offset of the signed-digit representation is included in the blinding value. */
+    secp256k1_scalar_set_int(&dbl, 1);
+    for (i = 1; i < ECMULT_GEN_COMB_SPACING; i++) {
+        secp256k1_scalar_add(&dbl, &dbl, &dbl);
+    }
+    secp256k1_ecmult_gen_comb_offset(&offset);
     if (seed32 == NULL) {
         /* When seed is NULL, reset the initial point and blinding value. */
         secp256k1_gej_set_ge(&ctx->initial, &secp256k1_ge_const_g);
         secp256k1_gej_neg(&ctx->initial, &ctx->initial);
-        secp256k1_scalar_set_int(&ctx->blind, 1);
+        secp256k1_scalar_add(&ctx->blind, &dbl, &offset);
     }
     /* The prior blinding value (if not reset) is chained forward by including it in the hash. */
     secp256k1_scalar_get_b32(nonce32, &ctx->blind);
@@ -209,11 +253,15 @@ static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const
     secp256k1_scalar_cmov(&b, &secp256k1_scalar_one, secp256k1_scalar_is_zero(&b));
     secp256k1_rfc6979_hmac_sha256_finalize(&rng);
     memset(nonce32, 0, 32);
-    secp256k1_ecmult_gen(ctx, &gb, &b);
+    /* Compute initial = b / 2^(SPACING-1) * G, so that the doublings turn it into b * G. */
+    secp256k1_scalar_inverse(&dbl_inv, &dbl);
+    secp256k1_scalar_mul(&dbl_inv, &dbl_inv, &b);
+    secp256k1_ecmult_gen(ctx, &gb, &dbl_inv);
     secp256k1_scalar_negate(&b, &b);
-    ctx->blind = b;
+    secp256k1_scalar_add(&ctx->blind, &b, &offset);
     ctx->initial = gb;
     secp256k1_scalar_clear(&b);
+    secp256k1_scalar_clear(&dbl_inv);
     secp256k1_gej_clear(&gb);
 }
 
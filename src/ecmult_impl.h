@@ -26,6 +26,7 @@
 #include "group.h"
 #include "scalar.h"
 #include "ecmult.h"
+#include "hash.h"
 #include "ecmult_static_pre_g.h"
 
 #if defined(EXHAUSTIVE_TEST_ORDER)
@@ -59,13 +60,9 @@
 
 /* The number of objects allocated on the scratch space for ecmult_multi algorithms */
 #define PIPPENGER_SCRATCH_OBJECTS 6
+#define PIPPENGER_AFFINE_SCRATCH_OBJECTS 8
 #define STRAUSS_SCRATCH_OBJECTS 6
 
-#define PIPPENGER_MAX_BUCKET_WINDOW 12
-
-/* Minimum number of points for which pippenger_wnaf is faster than strauss wnaf */
-#define ECMULT_PIPPENGER_THRESHOLD 88
-
 #define ECMULT_MAX_POINTS_PER_BATCH 5000000
 
 /** Fill a table 'prej' with precomputed odd multiples of a. Prej will contain
@@ -115,7 +112,7 @@ static void secp256k1_ecmult_odd_multiples_table(int n, secp256k1_gej *prej, sec
  *  It only operates on tables sized for WINDOW_A wnaf multiples.
  *
  *  To compute a*P + b*G, we compute a table for P using this function,
- *  and use the precomputed table in <ecmult_static_pre_g.h> for G.
+ *  and use the precomputed tables of the secp256k1_ecmult_context for G.
  */
 static void secp256k1_ecmult_odd_multiples_table_globalz_windowa(secp256k1_ge *pre, secp256k1_fe *globalz, const secp256k1_gej *a) {
     secp256k1_gej prej[ECMULT_TABLE_SIZE(WINDOW_A)];
@@ -229,7 +226,7 @@ struct secp256k1_strauss_state {
     struct secp256k1_strauss_point_state* ps;
 };
 
-static void secp256k1_ecmult_strauss_wnaf(const struct secp256k1_strauss_state *state, secp256k1_gej *r, size_t num, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+static void secp256k1_ecmult_strauss_wnaf(const secp256k1_ecmult_context *ctx, const struct secp256k1_strauss_state *state, secp256k1_gej *r, size_t num, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
     secp256k1_ge tmpa;
     secp256k1_fe Z;
     /* Splitted G factors. */
@@ -304,8 +301,8 @@ static void secp256k1_ecmult_strauss_wnaf(const struct secp256k1_strauss_state *
         secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
 
         /* Build wnaf representation for ng_1 and ng_128 */
-        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   WINDOW_G);
-        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, WINDOW_G);
+        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   ctx->window_g);
+        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, ctx->window_g);
         if (bits_ng_1 > bits) {
             bits = bits_ng_1;
         }
@@ -330,11 +327,11 @@ static void secp256k1_ecmult_strauss_wnaf(const struct secp256k1_strauss_state *
             }
         }
         if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, secp256k1_pre_g, n, WINDOW_G);
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, ctx->pre_g, n, ctx->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
         if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, secp256k1_pre_g_128, n, WINDOW_G);
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, ctx->pre_g_128, n, ctx->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
     }
@@ -344,7 +341,7 @@ static void secp256k1_ecmult_strauss_wnaf(const struct secp256k1_strauss_state *
     }
 }
 
-static void secp256k1_ecmult(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+static void secp256k1_ecmult(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
     secp256k1_gej prej[ECMULT_TABLE_SIZE(WINDOW_A)];
     secp256k1_fe zr[ECMULT_TABLE_SIZE(WINDOW_A)];
     secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
@@ -357,7 +354,249 @@ static void secp256k1_ecmult(secp256k1_gej *r, const secp256k1_gej *a, const sec
     state.pre_a = pre_a;
     state.pre_a_lam = pre_a_lam;
     state.ps = ps;
-    secp256k1_ecmult_strauss_wnaf(&state, r, 1, a, na, ng);
+    secp256k1_ecmult_strauss_wnaf(ctx, &state, r, 1, a, na, ng);
+}
+
+static void secp256k1_ecmult_precomp_table(secp256k1_ge_storage *pre, const secp256k1_ge *a, int w) {
+    /* The multiples are computed in chunks that share an inversion. */
+    secp256k1_gej prej[64];
+    secp256k1_ge prea[64];
+    secp256k1_ge d, last;
+    secp256k1_gej dj;
+    size_t i, j, n, n_chunk;
+
+    VERIFY_CHECK(!a->infinity);
+    VERIFY_CHECK(2 <= w && w <= 31);
+
+    secp256k1_gej_set_ge(&dj, a);
+    secp256k1_gej_double_var(&dj, &dj, NULL);
+    secp256k1_ge_set_gej_var(&d, &dj);
+    last = *a;
+    secp256k1_ge_to_storage(&pre[0], a);
+
+    n = ECMULT_TABLE_SIZE(w);
+    for (i = 1; i < n; i += n_chunk) {
+        n_chunk = n - i < 64 ? n - i : 64;
+        secp256k1_gej_set_ge(&prej[0], &last);
+        secp256k1_gej_add_ge_var(&prej[0], &prej[0], &d, NULL);
+        for (j = 1; j < n_chunk; j++) {
+            secp256k1_gej_add_ge_var(&prej[j], &prej[j - 1], &d, NULL);
+        }
+        secp256k1_ge_set_all_gej_var(prea, prej, n_chunk);
+        for (j = 0; j < n_chunk; j++) {
+            secp256k1_ge_to_storage(&pre[i + j], &prea[j]);
+        }
+        last = prea[n_chunk - 1];
+    }
+}
+
+static size_t secp256k1_ecmult_context_prealloc_size(int window_g) {
+    if (window_g == WINDOW_G) {
+        return 0;
+    }
+    return 2 * ROUND_TO_ALIGN(ECMULT_TABLE_SIZE(window_g) * sizeof(secp256k1_ge_storage));
+}
+
+static void secp256k1_ecmult_context_init(secp256k1_ecmult_context *ctx) {
+    static const secp256k1_ecmult_multi_profile default_profile = ECMULT_MULTI_PROFILE_DEFAULT;
+    ctx->window_g = WINDOW_G;
+    ctx->built = 0;
+    ctx->pre_g = secp256k1_pre_g;
+    ctx->pre_g_128 = secp256k1_pre_g_128;
+    ctx->multi = default_profile;
+}
+
+static void secp256k1_ecmult_context_build(secp256k1_ecmult_context *ctx, int window_g, void **prealloc) {
+    size_t const table_size = ECMULT_TABLE_SIZE(window_g) * sizeof(secp256k1_ge_storage);
+    size_t const prealloc_size = secp256k1_ecmult_context_prealloc_size(window_g);
+    void* const base = *prealloc;
+    secp256k1_ge_storage *pre_g, *pre_g_128;
+    secp256k1_gej g_128j;
+    secp256k1_ge g_128;
+    int i;
+
+    VERIFY_CHECK(2 <= window_g && window_g <= 24);
+    secp256k1_ecmult_context_init(ctx);
+    if (window_g == WINDOW_G) {
+        return;
+    }
+
+    pre_g = (secp256k1_ge_storage*)manual_alloc(prealloc, table_size, base, prealloc_size);
+    pre_g_128 = (secp256k1_ge_storage*)manual_alloc(prealloc, table_size, base, prealloc_size);
+    secp256k1_ecmult_precomp_table(pre_g, &secp256k1_ge_const_g, window_g);
+    secp256k1_gej_set_ge(&g_128j, &secp256k1_ge_const_g);
+    for (i = 0; i < 128; i++) {
+        secp256k1_gej_double_var(&g_128j, &g_128j, NULL);
+    }
+    secp256k1_ge_set_gej_var(&g_128, &g_128j);
+    secp256k1_ecmult_precomp_table(pre_g_128, &g_128, window_g);
+
+    ctx->window_g = window_g;
+    ctx->built = 1;
+    ctx->pre_g = pre_g;
+    ctx->pre_g_128 = pre_g_128;
+}
+
+static uint32_t secp256k1_ecmult_tables_read_be32(const unsigned char *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+static int secp256k1_ecmult_context_load(secp256k1_ecmult_context *ctx, const unsigned char *tables, size_t len) {
+    secp256k1_sha256 hash;
+    unsigned char checksum[32];
+    const secp256k1_ge_storage *pre_g, *pre_g_128;
+    uint32_t window_g;
+    size_t table_size;
+    int i;
+
+    if (len < ECMULT_TABLES_HEADER_SIZE
+        || memcmp(tables, ECMULT_TABLES_MAGIC, 8) != 0
+        || secp256k1_ecmult_tables_read_be32(&tables[8]) != ECMULT_TABLES_VERSION
+        || secp256k1_ecmult_tables_read_be32(&tables[16]) != sizeof(secp256k1_ge_storage)) {
+        return 0;
+    }
+    for (i = 20; i < 32; i++) {
+        if (tables[i] != 0) {
+            return 0;
+        }
+    }
+    window_g = secp256k1_ecmult_tables_read_be32(&tables[12]);
+    if (window_g < 2 || window_g > 24) {
+        return 0;
+    }
+    table_size = ECMULT_TABLE_SIZE(window_g) * sizeof(secp256k1_ge_storage);
+    if ((len - ECMULT_TABLES_HEADER_SIZE) / 2 != table_size || (len - ECMULT_TABLES_HEADER_SIZE) % 2 != 0) {
+        return 0;
+    }
+
+    /* The first entries are G and 2^128*G, which also rules out tables
+     * written on a platform with a different secp256k1_ge_storage layout.
+     * These checks are cheap, so do them before hashing the whole tables. */
+    pre_g = (const secp256k1_ge_storage*)(const void*)&tables[ECMULT_TABLES_HEADER_SIZE];
+    pre_g_128 = (const secp256k1_ge_storage*)(const void*)&tables[ECMULT_TABLES_HEADER_SIZE + table_size];
+    if (secp256k1_memcmp_var(&pre_g[0], &secp256k1_pre_g[0], sizeof(secp256k1_ge_storage)) != 0
+        || secp256k1_memcmp_var(&pre_g_128[0], &secp256k1_pre_g_128[0], sizeof(secp256k1_ge_storage)) != 0) {
+        return 0;
+    }
+
+    secp256k1_sha256_initialize(&hash);
+    secp256k1_sha256_write(&hash, tables, 32);
+    secp256k1_sha256_write(&hash, &tables[ECMULT_TABLES_HEADER_SIZE], len - ECMULT_TABLES_HEADER_SIZE);
+    secp256k1_sha256_finalize(&hash, checksum);
+    if (secp256k1_memcmp_var(checksum, &tables[32], 32) != 0) {
+        return 0;
+    }
+
+    ctx->window_g = window_g;
+    ctx->built = 0;
+    ctx->pre_g = pre_g;
+    ctx->pre_g_128 = pre_g_128;
+    return 1;
+}
+
+static size_t secp256k1_ecmult_multi_profile_read_count(const unsigned char *p) {
+    uint32_t x = secp256k1_ecmult_tables_read_be32(p);
+    return x == 0xffffffff ? SIZE_MAX : (size_t)x;
+}
+
+static int secp256k1_ecmult_multi_profile_load(secp256k1_ecmult_multi_profile *profile, const unsigned char *in, size_t len) {
+    secp256k1_ecmult_multi_profile res;
+    int i;
+
+    if (len != ECMULT_MULTI_PROFILE_SIZE
+        || memcmp(in, ECMULT_MULTI_PROFILE_MAGIC, 8) != 0
+        || secp256k1_ecmult_tables_read_be32(&in[8]) != ECMULT_MULTI_PROFILE_VERSION
+        || secp256k1_ecmult_tables_read_be32(&in[12]) != PIPPENGER_MAX_BUCKET_WINDOW) {
+        return 0;
+    }
+    res.pippenger_threshold = secp256k1_ecmult_multi_profile_read_count(&in[16]);
+    res.affine_threshold = secp256k1_ecmult_multi_profile_read_count(&in[20]);
+    for (i = 0; i < PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        res.bucket_window_max_points[i] = secp256k1_ecmult_multi_profile_read_count(&in[24 + 4*i]);
+        if (i > 0 && res.bucket_window_max_points[i] < res.bucket_window_max_points[i - 1]) {
+            return 0;
+        }
+    }
+    if (res.bucket_window_max_points[PIPPENGER_MAX_BUCKET_WINDOW - 1] != SIZE_MAX) {
+        return 0;
+    }
+
+    *profile = res;
+    return 1;
+}
+
+static void secp256k1_ecmult_context_finalize_memcpy(secp256k1_ecmult_context *dst, const secp256k1_ecmult_context *src) {
+    if (src->built) {
+        /* We cast to void* first to suppress a -Wcast-align warning. */
+        dst->pre_g = (const secp256k1_ge_storage*)(const void*)((const unsigned char*)dst + ((const unsigned char*)src->pre_g - (const unsigned char*)src));
+        dst->pre_g_128 = (const secp256k1_ge_storage*)(const void*)((const unsigned char*)dst + ((const unsigned char*)src->pre_g_128 - (const unsigned char*)src));
+    }
+}
+
+static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context *ctx) {
+    secp256k1_ecmult_context_init(ctx);
+}
+
+static void secp256k1_ecmult_precomp(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_ge_storage *pre, int w, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+    secp256k1_ge tmpa;
+    secp256k1_scalar na_1, na_lam, ng_1, ng_128;
+    int wnaf_na_1[129];
+    int wnaf_na_lam[129];
+    int wnaf_ng_1[129];
+    int wnaf_ng_128[129];
+    int bits_na_1 = 0;
+    int bits_na_lam = 0;
+    int bits_ng_1 = 0;
+    int bits_ng_128 = 0;
+    int bits;
+    int i, n;
+
+    /* Same as secp256k1_ecmult_strauss_wnaf for a single point, except that
+     * the table for A is affine already. The table for lambda*A is obtained
+     * by multiplying the X coordinates with beta on the fly. */
+    if (!secp256k1_scalar_is_zero(na)) {
+        secp256k1_scalar_split_lambda(&na_1, &na_lam, na);
+        bits_na_1 = secp256k1_ecmult_wnaf(wnaf_na_1, 129, &na_1, w);
+        bits_na_lam = secp256k1_ecmult_wnaf(wnaf_na_lam, 129, &na_lam, w);
+    }
+    if (ng) {
+        secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
+        bits_ng_1 = secp256k1_ecmult_wnaf(wnaf_ng_1, 129, &ng_1, ctx->window_g);
+        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, ctx->window_g);
+    }
+    bits = bits_na_1;
+    if (bits_na_lam > bits) {
+        bits = bits_na_lam;
+    }
+    if (bits_ng_1 > bits) {
+        bits = bits_ng_1;
+    }
+    if (bits_ng_128 > bits) {
+        bits = bits_ng_128;
+    }
+
+    secp256k1_gej_set_infinity(r);
+
+    for (i = bits - 1; i >= 0; i--) {
+        secp256k1_gej_double_var(r, r, NULL);
+        if (i < bits_na_1 && (n = wnaf_na_1[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, pre, n, w);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_na_lam && (n = wnaf_na_lam[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, pre, n, w);
+            secp256k1_ge_mul_lambda(&tmpa, &tmpa);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, ctx->pre_g, n, ctx->window_g);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
+            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, ctx->pre_g_128, n, ctx->window_g);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+    }
 }
 
 static size_t secp256k1_strauss_scratch_size(size_t n_points) {
@@ -365,7 +604,7 @@ static size_t secp256k1_strauss_scratch_size(size_t n_points) {
     return n_points*point_size;
 }
 
-static int secp256k1_ecmult_strauss_batch(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+static int secp256k1_ecmult_strauss_batch(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
     secp256k1_gej* points;
     secp256k1_scalar* scalars;
     struct secp256k1_strauss_state state;
@@ -398,14 +637,14 @@ static int secp256k1_ecmult_strauss_batch(const secp256k1_callback* error_callba
         }
         secp256k1_gej_set_ge(&points[i], &point);
     }
-    secp256k1_ecmult_strauss_wnaf(&state, r, n_points, points, scalars, inp_g_sc);
+    secp256k1_ecmult_strauss_wnaf(ctx, &state, r, n_points, points, scalars, inp_g_sc);
     secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
     return 1;
 }
 
 /* Wrapper for secp256k1_ecmult_multi_func interface */
-static int secp256k1_ecmult_strauss_batch_single(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
-    return secp256k1_ecmult_strauss_batch(error_callback, scratch, r, inp_g_sc, cb, cbdata, n, 0);
+static int secp256k1_ecmult_strauss_batch_single(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    return secp256k1_ecmult_strauss_batch(error_callback, ctx, scratch, r, inp_g_sc, cb, cbdata, n, 0);
 }
 
 static size_t secp256k1_strauss_max_points(const secp256k1_callback* error_callback, secp256k1_scratch *scratch) {
@@ -575,55 +814,254 @@ static int secp256k1_ecmult_pippenger_wnaf(secp256k1_gej *buckets, int bucket_wi
     return 1;
 }
 
+struct secp256k1_pippenger_affine_buckets {
+    /* The points added to the buckets of one window, sorted by bucket. */
+    secp256k1_ge *list;
+    /* Denominators of the additions of one round and their inverses. */
+    secp256k1_fe *den;
+    secp256k1_fe *inv;
+    /* Start and number of the points of each bucket in list. */
+    size_t *offsets;
+    size_t *counts;
+};
+
+/* Prepares the affine addition a + b for a round of
+ * secp256k1_ecmult_pippenger_affine_reduce. If the sum needs no inversion it
+ * is stored in a, b is set to infinity and 0 is returned. Otherwise the
+ * denominator of the slope is stored in den, its numerator in b->y, and 1 is
+ * returned. The x coordinates of a and b must have magnitude at most 1 and
+ * their y coordinates at most 2. */
+static int secp256k1_ecmult_pippenger_affine_add_prepare(secp256k1_ge *a, secp256k1_ge *b, secp256k1_fe *den) {
+    secp256k1_fe num;
+
+    if (b->infinity) {
+        return 0;
+    }
+    if (a->infinity) {
+        *a = *b;
+        b->infinity = 1;
+        return 0;
+    }
+    secp256k1_fe_negate(den, &a->x, 1);
+    secp256k1_fe_add(den, &b->x);
+    secp256k1_fe_negate(&num, &a->y, 2);
+    secp256k1_fe_add(&num, &b->y);
+    if (secp256k1_fe_normalizes_to_zero_var(den)) {
+        if (!secp256k1_fe_normalizes_to_zero_var(&num)) {
+            /* b = -a */
+            a->infinity = 1;
+            b->infinity = 1;
+            return 0;
+        }
+        /* b = a, so the slope is 3*x^2 / 2*y */
+        *den = a->y;
+        secp256k1_fe_mul_int(den, 2);
+        secp256k1_fe_sqr(&num, &a->x);
+        secp256k1_fe_mul_int(&num, 3);
+    }
+    secp256k1_fe_normalize_weak(&num);
+    b->y = num;
+    return 1;
+}
+
+/* Completes a prepared addition given the inverse of its denominator, storing
+ * the sum in a. The resulting coordinates have magnitude 1. */
+static void secp256k1_ecmult_pippenger_affine_add_finish(secp256k1_ge *a, const secp256k1_ge *b, const secp256k1_fe *inv) {
+    /* 4 mul, 1 sqr (plus 3 mul for the shared inversion) */
+    secp256k1_fe lambda, x3, t;
+
+    secp256k1_fe_mul(&lambda, &b->y, inv);
+    secp256k1_fe_sqr(&x3, &lambda);
+    secp256k1_fe_negate(&t, &a->x, 1);
+    secp256k1_fe_add(&x3, &t);
+    secp256k1_fe_negate(&t, &b->x, 1);
+    secp256k1_fe_add(&x3, &t);
+    secp256k1_fe_normalize_weak(&x3);
+    secp256k1_fe_negate(&t, &x3, 1);
+    secp256k1_fe_add(&t, &a->x);
+    secp256k1_fe_mul(&t, &t, &lambda);
+    secp256k1_fe_negate(&a->y, &a->y, 2);
+    secp256k1_fe_add(&a->y, &t);
+    secp256k1_fe_normalize_weak(&a->y);
+    a->x = x3;
+}
+
+/* Sums the counts[j] points starting at list[offsets[j]] for every j < n_buckets
+ * and stores the sum in list[offsets[j]], setting counts[j] to at most 1. This
+ * is done in rounds which add adjacent pairs of points of every bucket. All
+ * additions of a round are independent, so they share a single batch
+ * inversion. den and inv need space for half the number of points. */
+static void secp256k1_ecmult_pippenger_affine_reduce(secp256k1_ge *list, const size_t *offsets, size_t *counts, size_t n_buckets, secp256k1_fe *den, secp256k1_fe *inv) {
+    while (1) {
+        size_t n_pairs = 0;
+        size_t n_den = 0;
+        size_t j, k;
+
+        for (j = 0; j < n_buckets; j++) {
+            secp256k1_ge *bucket = &list[offsets[j]];
+            for (k = 0; k + 1 < counts[j]; k += 2) {
+                n_den += secp256k1_ecmult_pippenger_affine_add_prepare(&bucket[k], &bucket[k + 1], &den[n_den]);
+                n_pairs++;
+            }
+        }
+        if (n_pairs == 0) {
+            break;
+        }
+        secp256k1_fe_inv_all_var(inv, den, n_den);
+
+        n_den = 0;
+        for (j = 0; j < n_buckets; j++) {
+            secp256k1_ge *bucket = &list[offsets[j]];
+            if (counts[j] < 2) {
+                continue;
+            }
+            for (k = 0; k + 1 < counts[j]; k += 2) {
+                if (!bucket[k + 1].infinity) {
+                    secp256k1_ecmult_pippenger_affine_add_finish(&bucket[k], &bucket[k + 1], &inv[n_den++]);
+                }
+                bucket[k / 2] = bucket[k];
+            }
+            if (counts[j] & 1) {
+                bucket[counts[j] / 2] = bucket[counts[j] - 1];
+            }
+            counts[j] = (counts[j] + 1) / 2;
+        }
+    }
+}
+
+/*
+ * pippenger_affine_wnaf computes the same result as pippenger_wnaf, but keeps
+ * the buckets in affine coordinates. For every window, the points are first
+ * sorted by the bucket (given by their signed wnaf digit) they are added to.
+ * Then the points of each bucket are summed with
+ * secp256k1_ecmult_pippenger_affine_reduce, which replaces the mixed
+ * Jacobian-affine addition per point (8 mul, 3 sqr) with an affine addition
+ * (5 mul, 1 sqr) whose inversion is shared among all additions of a round.
+ */
+static int secp256k1_ecmult_pippenger_affine_wnaf(struct secp256k1_pippenger_affine_buckets *buckets, int bucket_window, struct secp256k1_pippenger_state *state, secp256k1_gej *r, const secp256k1_scalar *sc, const secp256k1_ge *pt, size_t num) {
+    size_t n_wnaf = WNAF_SIZE(bucket_window+1);
+    size_t n_buckets = ECMULT_TABLE_SIZE(bucket_window+2);
+    size_t np;
+    size_t no = 0;
+    size_t n_skew = 0;
+    size_t j;
+    int i;
+
+    for (np = 0; np < num; ++np) {
+        if (secp256k1_scalar_is_zero(&sc[np]) || secp256k1_ge_is_infinity(&pt[np])) {
+            continue;
+        }
+        state->ps[no].input_pos = np;
+        state->ps[no].skew_na = secp256k1_wnaf_fixed(&state->wnaf_na[no*n_wnaf], &sc[np], bucket_window+1);
+        n_skew += state->ps[no].skew_na;
+        no++;
+    }
+    secp256k1_gej_set_infinity(r);
+
+    if (no == 0) {
+        return 1;
+    }
+
+    for (i = n_wnaf - 1; i >= 0; i--) {
+        secp256k1_gej running_sum;
+        secp256k1_ge skew_sum;
+
+        skew_sum.infinity = 1;
+        if (i == 0 && n_skew > 0) {
+            /* correct for wnaf skew by summing the negated points first */
+            size_t n = 0;
+            for (np = 0; np < no; ++np) {
+                if (state->ps[np].skew_na) {
+                    secp256k1_ge_neg(&buckets->list[n++], &pt[state->ps[np].input_pos]);
+                }
+            }
+            buckets->offsets[0] = 0;
+            buckets->counts[0] = n;
+            secp256k1_ecmult_pippenger_affine_reduce(buckets->list, buckets->offsets, buckets->counts, 1, buckets->den, buckets->inv);
+            skew_sum = buckets->list[0];
+        }
+
+        /* Sort the points by bucket, putting the skew correction first in
+         * bucket 0. */
+        memset(buckets->counts, 0, n_buckets * sizeof(*buckets->counts));
+        buckets->counts[0] = !skew_sum.infinity;
+        for (np = 0; np < no; ++np) {
+            int n = state->wnaf_na[np*n_wnaf + i];
+            if (n > 0) {
+                buckets->counts[(n - 1)/2]++;
+            } else if (n < 0) {
+                buckets->counts[-(n + 1)/2]++;
+            }
+        }
+        buckets->offsets[0] = 0;
+        for (j = 1; j < n_buckets; j++) {
+            buckets->offsets[j] = buckets->offsets[j - 1] + buckets->counts[j - 1];
+        }
+        memset(buckets->counts, 0, n_buckets * sizeof(*buckets->counts));
+        if (!skew_sum.infinity) {
+            buckets->list[0] = skew_sum;
+            buckets->counts[0] = 1;
+        }
+        for (np = 0; np < no; ++np) {
+            int n = state->wnaf_na[np*n_wnaf + i];
+            const secp256k1_ge *p = &pt[state->ps[np].input_pos];
+            size_t idx;
+            if (n > 0) {
+                idx = (n - 1)/2;
+                buckets->list[buckets->offsets[idx] + buckets->counts[idx]++] = *p;
+            } else if (n < 0) {
+                idx = -(n + 1)/2;
+                secp256k1_ge_neg(&buckets->list[buckets->offsets[idx] + buckets->counts[idx]++], p);
+            }
+        }
+
+        secp256k1_ecmult_pippenger_affine_reduce(buckets->list, buckets->offsets, buckets->counts, n_buckets, buckets->den, buckets->inv);
+
+        for (j = 0; j < (size_t)bucket_window; j++) {
+            secp256k1_gej_double_var(r, r, NULL);
+        }
+
+        /* Accumulate the sum of the buckets as in pippenger_wnaf. */
+        secp256k1_gej_set_infinity(&running_sum);
+        for (j = n_buckets - 1; j > 0; j--) {
+            if (buckets->counts[j] != 0) {
+                secp256k1_gej_add_ge_var(&running_sum, &running_sum, &buckets->list[buckets->offsets[j]], NULL);
+            }
+            secp256k1_gej_add_var(r, r, &running_sum, NULL);
+        }
+
+        if (buckets->counts[0] != 0) {
+            secp256k1_gej_add_ge_var(&running_sum, &running_sum, &buckets->list[0], NULL);
+        }
+        secp256k1_gej_double_var(r, r, NULL);
+        secp256k1_gej_add_var(r, r, &running_sum, NULL);
+    }
+    return 1;
+}
+
 /**
  * Returns optimal bucket_window (number of bits of a scalar represented by a
- * set of buckets) for a given number of points.
+ * set of buckets) for a given number of points according to profile.
  */
-static int secp256k1_pippenger_bucket_window(size_t n) {
-    if (n <= 1) {
-        return 1;
-    } else if (n <= 4) {
-        return 2;
-    } else if (n <= 20) {
-        return 3;
-    } else if (n <= 57) {
-        return 4;
-    } else if (n <= 136) {
-        return 5;
-    } else if (n <= 235) {
-        return 6;
-    } else if (n <= 1260) {
-        return 7;
-    } else if (n <= 4420) {
-        return 9;
-    } else if (n <= 7880) {
-        return 10;
-    } else if (n <= 16050) {
-        return 11;
-    } else {
-        return PIPPENGER_MAX_BUCKET_WINDOW;
+static int secp256k1_pippenger_bucket_window(const secp256k1_ecmult_multi_profile *profile, size_t n) {
+    int i;
+    for (i = 0; i < PIPPENGER_MAX_BUCKET_WINDOW - 1; i++) {
+        if (n <= profile->bucket_window_max_points[i]) {
+            break;
+        }
     }
+    return i + 1;
 }
 
 /**
- * Returns the maximum optimal number of points for a bucket_window.
+ * Returns the maximum optimal number of points for a bucket_window according
+ * to profile.
  */
-static size_t secp256k1_pippenger_bucket_window_inv(int bucket_window) {
-    switch(bucket_window) {
-        case 1: return 1;
-        case 2: return 4;
-        case 3: return 20;
-        case 4: return 57;
-        case 5: return 136;
-        case 6: return 235;
-        case 7: return 1260;
-        case 8: return 1260;
-        case 9: return 4420;
-        case 10: return 7880;
-        case 11: return 16050;
-        case PIPPENGER_MAX_BUCKET_WINDOW: return SIZE_MAX;
+static size_t secp256k1_pippenger_bucket_window_inv(const secp256k1_ecmult_multi_profile *profile, int bucket_window) {
+    if (bucket_window < 1 || bucket_window > PIPPENGER_MAX_BUCKET_WINDOW) {
+        return 0;
     }
-    return 0;
+    return profile->bucket_window_max_points[bucket_window - 1];
 }
 
 
@@ -642,17 +1080,47 @@ SECP256K1_INLINE static void secp256k1_ecmult_endo_split(secp256k1_scalar *s1, s
     }
 }
 
+/**
+ * Returns the scratch size required per entry (a point or, with the
+ * endomorphism, half a point) by pippenger_batch, or by pippenger_affine_batch
+ * if affine is set.
+ */
+static size_t secp256k1_pippenger_entry_size(int bucket_window, int affine) {
+    size_t entry_size = sizeof(secp256k1_ge) + sizeof(secp256k1_scalar) + sizeof(struct secp256k1_pippenger_point_state) + (WNAF_SIZE(bucket_window+1)+1)*sizeof(int);
+    if (affine) {
+        /* the sorted point list, and a denominator and inverse per pair */
+        entry_size += sizeof(secp256k1_ge) + sizeof(secp256k1_fe);
+    }
+    return entry_size;
+}
+
+/**
+ * Returns the scratch size required by pippenger_batch, or by
+ * pippenger_affine_batch if affine is set, independent of the number of points.
+ */
+static size_t secp256k1_pippenger_overhead_size(int bucket_window, int affine) {
+    if (affine) {
+        return (2*sizeof(size_t) << bucket_window) + sizeof(struct secp256k1_pippenger_state) + sizeof(secp256k1_ge) + 2*sizeof(secp256k1_fe);
+    }
+    return (sizeof(secp256k1_gej) << bucket_window) + sizeof(struct secp256k1_pippenger_state);
+}
+
 /**
  * Returns the scratch size required for a given number of points (excluding
  * base point G) without considering alignment.
  */
 static size_t secp256k1_pippenger_scratch_size(size_t n_points, int bucket_window) {
     size_t entries = 2*n_points + 2;
-    size_t entry_size = sizeof(secp256k1_ge) + sizeof(secp256k1_scalar) + sizeof(struct secp256k1_pippenger_point_state) + (WNAF_SIZE(bucket_window+1)+1)*sizeof(int);
-    return (sizeof(secp256k1_gej) << bucket_window) + sizeof(struct secp256k1_pippenger_state) + entries * entry_size;
+    return secp256k1_pippenger_overhead_size(bucket_window, 0) + entries * secp256k1_pippenger_entry_size(bucket_window, 0);
 }
 
-static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+/** Same as secp256k1_pippenger_scratch_size, but for pippenger_affine_batch. */
+static size_t secp256k1_pippenger_affine_scratch_size(size_t n_points, int bucket_window) {
+    size_t entries = 2*n_points + 2;
+    return secp256k1_pippenger_overhead_size(bucket_window, 1) + entries * secp256k1_pippenger_entry_size(bucket_window, 1);
+}
+
+static int secp256k1_ecmult_pippenger_batch_internal(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset, int affine) {
     const size_t scratch_checkpoint = secp256k1_scratch_checkpoint(error_callback, scratch);
     /* Use 2(n+1) with the endomorphism, when calculating batch
      * sizes. The reason for +1 is that we add the G scalar to the list of
@@ -660,7 +1128,8 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
     size_t entries = 2*n_points + 2;
     secp256k1_ge *points;
     secp256k1_scalar *scalars;
-    secp256k1_gej *buckets;
+    secp256k1_gej *buckets = NULL;
+    struct secp256k1_pippenger_affine_buckets affine_buckets = {NULL, NULL, NULL, NULL, NULL};
     struct secp256k1_pippenger_state *state_space;
     size_t idx = 0;
     size_t point_idx = 0;
@@ -672,7 +1141,7 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
         return 1;
     }
 
-    bucket_window = secp256k1_pippenger_bucket_window(n_points);
+    bucket_window = secp256k1_pippenger_bucket_window(&ctx->multi, n_points);
     points = (secp256k1_ge *) secp256k1_scratch_alloc(error_callback, scratch, entries * sizeof(*points));
     scalars = (secp256k1_scalar *) secp256k1_scratch_alloc(error_callback, scratch, entries * sizeof(*scalars));
     state_space = (struct secp256k1_pippenger_state *) secp256k1_scratch_alloc(error_callback, scratch, sizeof(*state_space));
@@ -683,8 +1152,23 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
 
     state_space->ps = (struct secp256k1_pippenger_point_state *) secp256k1_scratch_alloc(error_callback, scratch, entries * sizeof(*state_space->ps));
     state_space->wnaf_na = (int *) secp256k1_scratch_alloc(error_callback, scratch, entries*(WNAF_SIZE(bucket_window+1)) * sizeof(int));
-    buckets = (secp256k1_gej *) secp256k1_scratch_alloc(error_callback, scratch, (1<<bucket_window) * sizeof(*buckets));
-    if (state_space->ps == NULL || state_space->wnaf_na == NULL || buckets == NULL) {
+    if (affine) {
+        /* The point list holds the entries and the skew correction, and every
+         * round of secp256k1_ecmult_pippenger_affine_reduce adds at most half
+         * of them. */
+        affine_buckets.list = (secp256k1_ge *) secp256k1_scratch_alloc(error_callback, scratch, (entries + 1) * sizeof(secp256k1_ge));
+        affine_buckets.den = (secp256k1_fe *) secp256k1_scratch_alloc(error_callback, scratch, 2 * (entries/2 + 1) * sizeof(secp256k1_fe));
+        affine_buckets.offsets = (size_t *) secp256k1_scratch_alloc(error_callback, scratch, (2*sizeof(size_t)) << bucket_window);
+        if (affine_buckets.list == NULL || affine_buckets.den == NULL || affine_buckets.offsets == NULL) {
+            secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
+            return 0;
+        }
+        affine_buckets.inv = &affine_buckets.den[entries/2 + 1];
+        affine_buckets.counts = &affine_buckets.offsets[(size_t)1 << bucket_window];
+    } else {
+        buckets = (secp256k1_gej *) secp256k1_scratch_alloc(error_callback, scratch, (1<<bucket_window) * sizeof(*buckets));
+    }
+    if (state_space->ps == NULL || state_space->wnaf_na == NULL || (!affine && buckets == NULL)) {
         secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
         return 0;
     }
@@ -708,7 +1192,11 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
         point_idx++;
     }
 
-    secp256k1_ecmult_pippenger_wnaf(buckets, bucket_window, state_space, r, scalars, points, idx);
+    if (affine) {
+        secp256k1_ecmult_pippenger_affine_wnaf(&affine_buckets, bucket_window, state_space, r, scalars, points, idx);
+    } else {
+        secp256k1_ecmult_pippenger_wnaf(buckets, bucket_window, state_space, r, scalars, points, idx);
+    }
 
     /* Clear data */
     for(i = 0; (size_t)i < idx; i++) {
@@ -718,37 +1206,53 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
             state_space->wnaf_na[i * WNAF_SIZE(bucket_window+1) + j] = 0;
         }
     }
-    for(i = 0; i < 1<<bucket_window; i++) {
-        secp256k1_gej_clear(&buckets[i]);
+    if (affine) {
+        for(i = 0; (size_t)i <= idx; i++) {
+            secp256k1_ge_clear(&affine_buckets.list[i]);
+        }
+    } else {
+        for(i = 0; i < 1<<bucket_window; i++) {
+            secp256k1_gej_clear(&buckets[i]);
+        }
     }
     secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
     return 1;
 }
 
+static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+    return secp256k1_ecmult_pippenger_batch_internal(error_callback, ctx, scratch, r, inp_g_sc, cb, cbdata, n_points, cb_offset, 0);
+}
+
+/* Same as secp256k1_ecmult_pippenger_batch, but with affine buckets (see
+ * pippenger_affine_wnaf). */
+static int secp256k1_ecmult_pippenger_affine_batch(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+    return secp256k1_ecmult_pippenger_batch_internal(error_callback, ctx, scratch, r, inp_g_sc, cb, cbdata, n_points, cb_offset, 1);
+}
+
 /* Wrapper for secp256k1_ecmult_multi_func interface */
-static int secp256k1_ecmult_pippenger_batch_single(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
-    return secp256k1_ecmult_pippenger_batch(error_callback, scratch, r, inp_g_sc, cb, cbdata, n, 0);
+static int secp256k1_ecmult_pippenger_batch_single(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    return secp256k1_ecmult_pippenger_batch(error_callback, ctx, scratch, r, inp_g_sc, cb, cbdata, n, 0);
 }
 
-/**
- * Returns the maximum number of points in addition to G that can be used with
- * a given scratch space. The function ensures that fewer points may also be
- * used.
- */
-static size_t secp256k1_pippenger_max_points(const secp256k1_callback* error_callback, secp256k1_scratch *scratch) {
-    size_t max_alloc = secp256k1_scratch_max_allocation(error_callback, scratch, PIPPENGER_SCRATCH_OBJECTS);
+/* Wrapper for secp256k1_ecmult_multi_func interface */
+static int secp256k1_ecmult_pippenger_affine_batch_single(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    return secp256k1_ecmult_pippenger_affine_batch(error_callback, ctx, scratch, r, inp_g_sc, cb, cbdata, n, 0);
+}
+
+static size_t secp256k1_pippenger_max_points_internal(const secp256k1_callback* error_callback, const secp256k1_ecmult_multi_profile *profile, secp256k1_scratch *scratch, int affine) {
+    size_t max_alloc = secp256k1_scratch_max_allocation(error_callback, scratch, affine ? PIPPENGER_AFFINE_SCRATCH_OBJECTS : PIPPENGER_SCRATCH_OBJECTS);
     int bucket_window;
     size_t res = 0;
 
     for (bucket_window = 1; bucket_window <= PIPPENGER_MAX_BUCKET_WINDOW; bucket_window++) {
         size_t n_points;
-        size_t max_points = secp256k1_pippenger_bucket_window_inv(bucket_window);
+        size_t max_points = secp256k1_pippenger_bucket_window_inv(profile, bucket_window);
         size_t space_for_points;
         size_t space_overhead;
-        size_t entry_size = sizeof(secp256k1_ge) + sizeof(secp256k1_scalar) + sizeof(struct secp256k1_pippenger_point_state) + (WNAF_SIZE(bucket_window+1)+1)*sizeof(int);
+        size_t entry_size = secp256k1_pippenger_entry_size(bucket_window, affine);
 
         entry_size = 2*entry_size;
-        space_overhead = (sizeof(secp256k1_gej) << bucket_window) + entry_size + sizeof(struct secp256k1_pippenger_state);
+        space_overhead = secp256k1_pippenger_overhead_size(bucket_window, affine) + entry_size;
         if (space_overhead > max_alloc) {
             break;
         }
@@ -769,9 +1273,23 @@ static size_t secp256k1_pippenger_max_points(const secp256k1_callback* error_cal
     return res;
 }
 
+/**
+ * Returns the maximum number of points in addition to G that can be used with
+ * a given scratch space and the bucket windows of profile. The function
+ * ensures that fewer points may also be used.
+ */
+static size_t secp256k1_pippenger_max_points(const secp256k1_callback* error_callback, const secp256k1_ecmult_multi_profile *profile, secp256k1_scratch *scratch) {
+    return secp256k1_pippenger_max_points_internal(error_callback, profile, scratch, 0);
+}
+
+/** Same as secp256k1_pippenger_max_points, but for pippenger_affine_batch. */
+static size_t secp256k1_pippenger_affine_max_points(const secp256k1_callback* error_callback, const secp256k1_ecmult_multi_profile *profile, secp256k1_scratch *scratch) {
+    return secp256k1_pippenger_max_points_internal(error_callback, profile, scratch, 1);
+}
+
 /* Computes ecmult_multi by simply multiplying and adding each point. Does not
  * require a scratch space */
-static int secp256k1_ecmult_multi_simple_var(secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points) {
+static int secp256k1_ecmult_multi_simple_var(const secp256k1_ecmult_context *ctx, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
     size_t point_idx;
     secp256k1_scalar szero;
     secp256k1_gej tmpj;
@@ -780,17 +1298,17 @@ static int secp256k1_ecmult_multi_simple_var(secp256k1_gej *r, const secp256k1_s
     secp256k1_gej_set_infinity(r);
     secp256k1_gej_set_infinity(&tmpj);
     /* r = inp_g_sc*G */
-    secp256k1_ecmult(r, &tmpj, &szero, inp_g_sc);
+    secp256k1_ecmult(ctx, r, &tmpj, &szero, inp_g_sc);
     for (point_idx = 0; point_idx < n_points; point_idx++) {
         secp256k1_ge point;
         secp256k1_gej pointj;
         secp256k1_scalar scalar;
-        if (!cb(&scalar, &point, point_idx, cbdata)) {
+        if (!cb(&scalar, &point, point_idx + cb_offset, cbdata)) {
             return 0;
         }
         /* r += scalar*point */
         secp256k1_gej_set_ge(&pointj, &point);
-        secp256k1_ecmult(&tmpj, &pointj, &scalar, NULL);
+        secp256k1_ecmult(ctx, &tmpj, &pointj, &scalar, NULL);
         secp256k1_gej_add_var(r, r, &tmpj, NULL);
     }
     return 1;
@@ -816,11 +1334,12 @@ static int secp256k1_ecmult_multi_batch_size_helper(size_t *n_batches, size_t *n
     return 1;
 }
 
-typedef int (*secp256k1_ecmult_multi_func)(const secp256k1_callback* error_callback, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t);
-static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+typedef int (*secp256k1_ecmult_multi_func)(const secp256k1_callback* error_callback, const secp256k1_ecmult_context*, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t);
+/* Computes ecmult_multi for the points cb_offset, ..., cb_offset + n - 1 */
+static int secp256k1_ecmult_multi_var_offset(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n, size_t cb_offset) {
     size_t i;
 
-    int (*f)(const secp256k1_callback* error_callback, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t, size_t);
+    int (*f)(const secp256k1_callback* error_callback, const secp256k1_ecmult_context*, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t, size_t);
     size_t n_batches;
     size_t n_batch_points;
 
@@ -830,33 +1349,43 @@ static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback,
     } else if (n == 0) {
         secp256k1_scalar szero;
         secp256k1_scalar_set_int(&szero, 0);
-        secp256k1_ecmult(r, r, &szero, inp_g_sc);
+        secp256k1_ecmult(ctx, r, r, &szero, inp_g_sc);
         return 1;
     }
     if (scratch == NULL) {
-        return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, cb, cbdata, n);
+        return secp256k1_ecmult_multi_simple_var(ctx, r, inp_g_sc, cb, cbdata, n, cb_offset);
     }
 
     /* Compute the batch sizes for Pippenger's algorithm given a scratch space. If it's greater than
      * a threshold use Pippenger's algorithm. Otherwise use Strauss' algorithm.
      * As a first step check if there's enough space for Pippenger's algo (which requires less space
      * than Strauss' algo) and if not, use the simple algorithm. */
-    if (!secp256k1_ecmult_multi_batch_size_helper(&n_batches, &n_batch_points, secp256k1_pippenger_max_points(error_callback, scratch), n)) {
-        return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, cb, cbdata, n);
+    if (!secp256k1_ecmult_multi_batch_size_helper(&n_batches, &n_batch_points, secp256k1_pippenger_max_points(error_callback, &ctx->multi, scratch), n)) {
+        return secp256k1_ecmult_multi_simple_var(ctx, r, inp_g_sc, cb, cbdata, n, cb_offset);
     }
-    if (n_batch_points >= ECMULT_PIPPENGER_THRESHOLD) {
+    if (n_batch_points >= ctx->multi.pippenger_threshold) {
         f = secp256k1_ecmult_pippenger_batch;
+        /* Affine buckets need more scratch space per point, so only use them
+         * if the batches remain large enough. */
+        if (n_batch_points >= ctx->multi.affine_threshold) {
+            size_t n_affine_batches, n_affine_batch_points;
+            if (secp256k1_ecmult_multi_batch_size_helper(&n_affine_batches, &n_affine_batch_points, secp256k1_pippenger_affine_max_points(error_callback, &ctx->multi, scratch), n) && n_affine_batch_points >= ctx->multi.affine_threshold) {
+                n_batches = n_affine_batches;
+                n_batch_points = n_affine_batch_points;
+                f = secp256k1_ecmult_pippenger_affine_batch;
+            }
+        }
     } else {
         if (!secp256k1_ecmult_multi_batch_size_helper(&n_batches, &n_batch_points, secp256k1_strauss_max_points(error_callback, scratch), n)) {
-            return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, cb, cbdata, n);
+            return secp256k1_ecmult_multi_simple_var(ctx, r, inp_g_sc, cb, cbdata, n, cb_offset);
         }
         f = secp256k1_ecmult_strauss_batch;
     }
     for(i = 0; i < n_batches; i++) {
         size_t nbp = n < n_batch_points ? n : n_batch_points;
-        size_t offset = n_batch_points*i;
+        size_t offset = cb_offset + n_batch_points*i;
         secp256k1_gej tmp;
-        if (!f(error_callback, scratch, &tmp, i == 0 ? inp_g_sc : NULL, cb, cbdata, nbp, offset)) {
+        if (!f(error_callback, ctx, scratch, &tmp, i == 0 ? inp_g_sc : NULL, cb, cbdata, nbp, offset)) {
             return 0;
         }
         secp256k1_gej_add_var(r, r, &tmp, NULL);
@@ -865,4 +1394,79 @@ static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback,
     return 1;
 }
 
+static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    return secp256k1_ecmult_multi_var_offset(error_callback, ctx, scratch, r, inp_g_sc, cb, cbdata, n, 0);
+}
+
+typedef struct {
+    const secp256k1_callback* error_callback;
+    const secp256k1_ecmult_context *ctx;
+    secp256k1_scratch *scratches;
+    secp256k1_gej *results;
+    int *ret;
+    const secp256k1_scalar *inp_g_sc;
+    secp256k1_ecmult_multi_callback *cb;
+    void *cbdata;
+    size_t n;
+    size_t n_task_points;
+} secp256k1_ecmult_multi_parallel_data;
+
+static void secp256k1_ecmult_multi_parallel_task(size_t idx, void *data) {
+    secp256k1_ecmult_multi_parallel_data *pdata = (secp256k1_ecmult_multi_parallel_data *) data;
+    size_t offset = pdata->n_task_points*idx;
+    size_t n = pdata->n - offset < pdata->n_task_points ? pdata->n - offset : pdata->n_task_points;
+
+    pdata->ret[idx] = secp256k1_ecmult_multi_var_offset(pdata->error_callback, pdata->ctx, &pdata->scratches[idx], &pdata->results[idx], idx == 0 ? pdata->inp_g_sc : NULL, pdata->cb, pdata->cbdata, n, offset);
+}
+
+static int secp256k1_ecmult_multi_var_parallel(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n, secp256k1_ecmult_multi_dispatch *dispatch, void *dispatch_data, size_t n_tasks) {
+    secp256k1_ecmult_multi_parallel_data pdata;
+    size_t scratch_checkpoint;
+    size_t task_scratch_size;
+    size_t i;
+    int ret = 1;
+
+    if (scratch == NULL || n_tasks < 2 || n < 2) {
+        return secp256k1_ecmult_multi_var(error_callback, ctx, scratch, r, inp_g_sc, cb, cbdata, n);
+    }
+    /* Every task gets ceil(n/n_tasks) points, so fewer tasks may be needed
+     * to cover all points. */
+    if (n_tasks > n) {
+        n_tasks = n;
+    }
+    secp256k1_ecmult_multi_batch_size_helper(&n_tasks, &pdata.n_task_points, 1 + (n - 1) / n_tasks, n);
+
+    scratch_checkpoint = secp256k1_scratch_checkpoint(error_callback, scratch);
+    pdata.scratches = (secp256k1_scratch *) secp256k1_scratch_alloc(error_callback, scratch, n_tasks * sizeof(secp256k1_scratch));
+    pdata.results = (secp256k1_gej *) secp256k1_scratch_alloc(error_callback, scratch, n_tasks * sizeof(secp256k1_gej));
+    pdata.ret = (int *) secp256k1_scratch_alloc(error_callback, scratch, n_tasks * sizeof(int));
+    if (pdata.scratches == NULL || pdata.results == NULL || pdata.ret == NULL) {
+        secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
+        return secp256k1_ecmult_multi_var(error_callback, ctx, scratch, r, inp_g_sc, cb, cbdata, n);
+    }
+    /* Split the remaining scratch space evenly between the tasks */
+    task_scratch_size = secp256k1_scratch_max_allocation(error_callback, scratch, n_tasks) / n_tasks;
+    for (i = 0; i < n_tasks; i++) {
+        int alloc_ret = secp256k1_scratch_alloc_child(error_callback, scratch, &pdata.scratches[i], task_scratch_size);
+        VERIFY_CHECK(alloc_ret);
+        (void)alloc_ret;
+    }
+    pdata.error_callback = error_callback;
+    pdata.ctx = ctx;
+    pdata.inp_g_sc = inp_g_sc;
+    pdata.cb = cb;
+    pdata.cbdata = cbdata;
+    pdata.n = n;
+
+    dispatch(secp256k1_ecmult_multi_parallel_task, &pdata, n_tasks, dispatch_data);
+
+    secp256k1_gej_set_infinity(r);
+    for (i = 0; i < n_tasks; i++) {
+        ret &= pdata.ret[i];
+        secp256k1_gej_add_var(r, r, &pdata.results[i], NULL);
+    }
+    secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
+    return ret;
+}
+
 #endif /* SECP256K1_ECMULT_IMPL_H */
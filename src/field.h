@@ -115,6 +115,12 @@ static void secp256k1_fe_sqr(secp256k1_fe *r, const secp256k1_fe *a);
  *  itself. */
 static int secp256k1_fe_sqrt(secp256k1_fe *r, const secp256k1_fe *a);
 
+/** Computes the square roots of len field elements like secp256k1_fe_sqrt,
+ *  storing the return value of secp256k1_fe_sqrt for a[i] in ret[i]. The
+ *  exponentiations of independent inputs are interleaved, which is faster
+ *  than computing them one after another. r and a must not overlap. */
+static void secp256k1_fe_sqrt_batch(secp256k1_fe *r, int *ret, const secp256k1_fe *a, size_t len);
+
 /** Sets a field element to be the (modular) inverse of another. Requires the input's magnitude to be
  *  at most 8. The output magnitude is 1 (but not guaranteed to be normalized). */
 static void secp256k1_fe_inv(secp256k1_fe *r, const secp256k1_fe *a);
@@ -122,6 +128,15 @@ static void secp256k1_fe_inv(secp256k1_fe *r, const secp256k1_fe *a);
 /** Potentially faster version of secp256k1_fe_inv, without constant-time guarantee. */
 static void secp256k1_fe_inv_var(secp256k1_fe *r, const secp256k1_fe *a);
 
+/** Sets r[i] to the inverse of a[i] for i < len, or to zero if a[i] is zero, using a
+ *  single inversion and 3 multiplications per element (Montgomery's trick). Requires
+ *  the inputs' magnitudes to be at most 8. The output magnitudes are at most 1. r and
+ *  a must not overlap. */
+static void secp256k1_fe_inv_all(secp256k1_fe *r, const secp256k1_fe *a, size_t len);
+
+/** Potentially faster version of secp256k1_fe_inv_all, without constant-time guarantee. */
+static void secp256k1_fe_inv_all_var(secp256k1_fe *r, const secp256k1_fe *a, size_t len);
+
 /** Convert a field element to the storage type. */
 static void secp256k1_fe_to_storage(secp256k1_fe_storage *r, const secp256k1_fe *a);
 
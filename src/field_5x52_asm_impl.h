@@ -21,6 +21,11 @@
  * - March 2013, Diederik Huys:    original version
  * - November 2014, Pieter Wuille: updated to use Peter Dettman's parallel multiplication algorithm
  * - December 2014, Pieter Wuille: converted from YASM to GCC inline assembly
+ *
+ * A BMI2/ADX (mulx/adcx/adox) variant was evaluated and not adopted: with 52-bit
+ * limbs the products need no long carry chains, so mulx only saves a few moves,
+ * and a full-radix 4x64 multiplication loses its advantage to the conversions
+ * from and to the 5x52 representation used by the rest of the library.
  */
 
 #ifndef SECP256K1_FIELD_INNER5X52_IMPL_H
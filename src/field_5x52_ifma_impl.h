@@ -0,0 +1,247 @@
+// © Licensed Authorship: Manuel J. Nieves (See LICENSE for terms)
+/*
+ * Copyright (c) 2008–2025 Manuel J. Nieves (a.k.a. Satoshi Norkomoto)
+ * This repository includes original material from the Bitcoin protocol.
+ *
+ * Redistribution requires this notice remain intact.
+ * Derivative works must state derivative status.
+ * Commercial use requires licensing.
+ *
+ * GPG Signed: B4EC 7343 AB0D BF24
+ * Contact: Fordamboy1@gmail.com
+ */
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_FIELD_LANES_IMPL_H
+#define SECP256K1_FIELD_LANES_IMPL_H
+
+/** Multi-lane field arithmetic using AVX-512 IFMA.
+ *
+ *  A secp256k1_fe_lanes holds SECP256K1_FE_LANES independent field elements
+ *  in the 5x52 representation, with limb i of every element in vector n[i].
+ *  The vpmadd52luq/vpmadd52huq instructions compute the low and high 52 bits
+ *  of 52x52-bit limb products, so one multiplication of secp256k1_fe_lanes
+ *  performs SECP256K1_FE_LANES field multiplications at once.
+ *
+ *  The instructions only use the low 52 bits of their operands, so all
+ *  limbs of lane inputs must be below 2^52. Loading weakly normalizes the
+ *  elements, and the results of the lane operations satisfy this as well.
+ *
+ *  The functions are compiled for the AVX-512 IFMA target regardless of the
+ *  compiler flags, and must only be called if
+ *  secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA) returns 1.
+ */
+
+#include <immintrin.h>
+
+#include "cpu.h"
+
+#define SECP256K1_FE_LANES 8
+#define SECP256K1_FE_LANES_TARGET __attribute__((target("avx512f,avx512ifma")))
+
+typedef struct {
+    __m512i n[5];
+} secp256k1_fe_lanes;
+
+SECP256K1_FE_LANES_TARGET static void secp256k1_fe_lanes_load_limbs(secp256k1_fe_lanes *r, const uint64_t *limbs) {
+    int j;
+    for (j = 0; j < 5; j++) {
+        r->n[j] = _mm512_loadu_si512(&limbs[j * SECP256K1_FE_LANES]);
+    }
+}
+
+SECP256K1_FE_LANES_TARGET static void secp256k1_fe_lanes_store_limbs(uint64_t *limbs, const secp256k1_fe_lanes *a) {
+    int j;
+    for (j = 0; j < 5; j++) {
+        _mm512_storeu_si512(&limbs[j * SECP256K1_FE_LANES], a->n[j]);
+    }
+}
+
+/** Sets r to the first len elements of a, and the remaining lanes to zero. */
+static void secp256k1_fe_lanes_load(secp256k1_fe_lanes *r, const secp256k1_fe *a, size_t len) {
+    uint64_t limbs[5 * SECP256K1_FE_LANES];
+    secp256k1_fe t;
+    size_t i, j;
+
+    VERIFY_CHECK(len <= SECP256K1_FE_LANES);
+    for (i = 0; i < SECP256K1_FE_LANES; i++) {
+        if (i < len) {
+            t = a[i];
+            secp256k1_fe_normalize_weak(&t);
+        } else {
+            secp256k1_fe_clear(&t);
+        }
+        for (j = 0; j < 5; j++) {
+            limbs[j * SECP256K1_FE_LANES + i] = t.n[j];
+        }
+    }
+    secp256k1_fe_lanes_load_limbs(r, limbs);
+}
+
+/** Sets r[i] to lane i of a, for i < len. The outputs have magnitude 1. */
+static void secp256k1_fe_lanes_store(secp256k1_fe *r, const secp256k1_fe_lanes *a, size_t len) {
+    uint64_t limbs[5 * SECP256K1_FE_LANES];
+    size_t i, j;
+
+    VERIFY_CHECK(len <= SECP256K1_FE_LANES);
+    secp256k1_fe_lanes_store_limbs(limbs, a);
+    for (i = 0; i < len; i++) {
+        for (j = 0; j < 5; j++) {
+            r[i].n[j] = limbs[j * SECP256K1_FE_LANES + i];
+        }
+#ifdef VERIFY
+        r[i].magnitude = 1;
+        r[i].normalized = 0;
+        secp256k1_fe_verify(&r[i]);
+#endif
+    }
+}
+
+/* The column accumulation steps of the products below: t += lo52(x*y) and
+ * u += hi52(x*y), i.e. the low and high halves of the 104-bit product go to
+ * adjacent columns t and u. */
+#define LANES_MADD(t, u, x, y) do { \
+    t = _mm512_madd52lo_epu64(t, x, y); \
+    u = _mm512_madd52hi_epu64(u, x, y); \
+} while(0)
+
+/* Moves the bits of t above 52 into u. */
+#define LANES_CARRY(t, u) do { \
+    u = _mm512_add_epi64(u, _mm512_srli_epi64(t, 52)); \
+    t = _mm512_and_si512(t, M); \
+} while(0)
+
+/* Reduces the 10 columns t0..t9 of a product, each below 2^57, into r.
+ * Column k has weight 2^(52*k), and 2^260 = R (mod p), so column k >= 5 is
+ * folded into columns k-5 and k-4 by multiplying with R. */
+SECP256K1_FE_LANES_TARGET static void secp256k1_fe_lanes_reduce(secp256k1_fe_lanes *r,
+    __m512i t0, __m512i t1, __m512i t2, __m512i t3, __m512i t4,
+    __m512i t5, __m512i t6, __m512i t7, __m512i t8, __m512i t9) {
+    const __m512i M = _mm512_set1_epi64(0xFFFFFFFFFFFFFULL), R = _mm512_set1_epi64(0x1000003D10ULL);
+    __m512i c = _mm512_setzero_si512(), u = _mm512_setzero_si512();
+
+    /* Bring t5..t9 below 2^52, leaving a small carry c in column 10. */
+    LANES_CARRY(t5, t6);
+    LANES_CARRY(t6, t7);
+    LANES_CARRY(t7, t8);
+    LANES_CARRY(t8, t9);
+    LANES_CARRY(t9, c);
+    /* Fold t5..t9 into the lower columns. The high half of t9*R lands in
+     * column 5 again as u, together with c*R (from column 10). As u is below
+     * 2^43, folding it once more only touches t0 and t1. */
+    LANES_MADD(t0, t1, t5, R);
+    LANES_MADD(t1, t2, t6, R);
+    LANES_MADD(t2, t3, t7, R);
+    LANES_MADD(t3, t4, t8, R);
+    LANES_MADD(t4, u, t9, R);
+    u = _mm512_madd52lo_epu64(u, c, R);
+    LANES_MADD(t0, t1, u, R);
+    /* Carry through the lower columns, fold the bits of t4 above 2^48 (i.e.
+     * above 2^256) back into t0 using 2^256 = R >> 4 (mod p), and carry once
+     * more. */
+    LANES_CARRY(t0, t1);
+    LANES_CARRY(t1, t2);
+    LANES_CARRY(t2, t3);
+    LANES_CARRY(t3, t4);
+    t0 = _mm512_madd52lo_epu64(t0, _mm512_srli_epi64(t4, 48), _mm512_srli_epi64(R, 4));
+    t4 = _mm512_and_si512(t4, _mm512_srli_epi64(M, 4));
+    LANES_CARRY(t0, t1);
+    LANES_CARRY(t1, t2);
+    LANES_CARRY(t2, t3);
+    LANES_CARRY(t3, t4);
+    /* Now t0..t3 are below 2^52 and t4 is at most 2^48. */
+    r->n[0] = t0;
+    r->n[1] = t1;
+    r->n[2] = t2;
+    r->n[3] = t3;
+    r->n[4] = t4;
+}
+
+/** Sets every lane of r to the product of the corresponding lanes of a and b.
+ *  r may alias a or b. */
+SECP256K1_FE_LANES_TARGET static void secp256k1_fe_lanes_mul(secp256k1_fe_lanes *r, const secp256k1_fe_lanes *a, const secp256k1_fe_lanes *b) {
+    __m512i a0 = a->n[0], a1 = a->n[1], a2 = a->n[2], a3 = a->n[3], a4 = a->n[4];
+    __m512i b0 = b->n[0], b1 = b->n[1], b2 = b->n[2], b3 = b->n[3], b4 = b->n[4];
+    __m512i t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+
+    t0 = t1 = t2 = t3 = t4 = t5 = t6 = t7 = t8 = t9 = _mm512_setzero_si512();
+    LANES_MADD(t0, t1, a0, b0);
+    LANES_MADD(t1, t2, a0, b1);
+    LANES_MADD(t1, t2, a1, b0);
+    LANES_MADD(t2, t3, a0, b2);
+    LANES_MADD(t2, t3, a1, b1);
+    LANES_MADD(t2, t3, a2, b0);
+    LANES_MADD(t3, t4, a0, b3);
+    LANES_MADD(t3, t4, a1, b2);
+    LANES_MADD(t3, t4, a2, b1);
+    LANES_MADD(t3, t4, a3, b0);
+    LANES_MADD(t4, t5, a0, b4);
+    LANES_MADD(t4, t5, a1, b3);
+    LANES_MADD(t4, t5, a2, b2);
+    LANES_MADD(t4, t5, a3, b1);
+    LANES_MADD(t4, t5, a4, b0);
+    LANES_MADD(t5, t6, a1, b4);
+    LANES_MADD(t5, t6, a2, b3);
+    LANES_MADD(t5, t6, a3, b2);
+    LANES_MADD(t5, t6, a4, b1);
+    LANES_MADD(t6, t7, a2, b4);
+    LANES_MADD(t6, t7, a3, b3);
+    LANES_MADD(t6, t7, a4, b2);
+    LANES_MADD(t7, t8, a3, b4);
+    LANES_MADD(t7, t8, a4, b3);
+    LANES_MADD(t8, t9, a4, b4);
+    secp256k1_fe_lanes_reduce(r, t0, t1, t2, t3, t4, t5, t6, t7, t8, t9);
+}
+
+/** Sets every lane of r to the square of the corresponding lane of a. r may
+ *  alias a. */
+SECP256K1_FE_LANES_TARGET static void secp256k1_fe_lanes_sqr(secp256k1_fe_lanes *r, const secp256k1_fe_lanes *a) {
+    __m512i a0 = a->n[0], a1 = a->n[1], a2 = a->n[2], a3 = a->n[3], a4 = a->n[4];
+    __m512i t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+
+    /* The products a[i]*a[j] with i != j appear twice; sum them once and
+     * double the columns before adding the squares. */
+    t0 = t1 = t2 = t3 = t4 = t5 = t6 = t7 = t8 = t9 = _mm512_setzero_si512();
+    LANES_MADD(t1, t2, a0, a1);
+    LANES_MADD(t2, t3, a0, a2);
+    LANES_MADD(t3, t4, a0, a3);
+    LANES_MADD(t3, t4, a1, a2);
+    LANES_MADD(t4, t5, a0, a4);
+    LANES_MADD(t4, t5, a1, a3);
+    LANES_MADD(t5, t6, a1, a4);
+    LANES_MADD(t5, t6, a2, a3);
+    LANES_MADD(t6, t7, a2, a4);
+    LANES_MADD(t7, t8, a3, a4);
+    t1 = _mm512_add_epi64(t1, t1);
+    t2 = _mm512_add_epi64(t2, t2);
+    t3 = _mm512_add_epi64(t3, t3);
+    t4 = _mm512_add_epi64(t4, t4);
+    t5 = _mm512_add_epi64(t5, t5);
+    t6 = _mm512_add_epi64(t6, t6);
+    t7 = _mm512_add_epi64(t7, t7);
+    t8 = _mm512_add_epi64(t8, t8);
+    LANES_MADD(t0, t1, a0, a0);
+    LANES_MADD(t2, t3, a1, a1);
+    LANES_MADD(t4, t5, a2, a2);
+    LANES_MADD(t6, t7, a3, a3);
+    LANES_MADD(t8, t9, a4, a4);
+    secp256k1_fe_lanes_reduce(r, t0, t1, t2, t3, t4, t5, t6, t7, t8, t9);
+}
+
+#undef LANES_MADD
+#undef LANES_CARRY
+
+/** Sets r = a^(2^n) * b, lane by lane. r may alias a or b. */
+SECP256K1_FE_LANES_TARGET static void secp256k1_fe_lanes_sqr_n_mul(secp256k1_fe_lanes *r, const secp256k1_fe_lanes *a, int n, const secp256k1_fe_lanes *b) {
+    secp256k1_fe_lanes t = *a;
+    int j;
+    for (j = 0; j < n; j++) {
+        secp256k1_fe_lanes_sqr(&t, &t);
+    }
+    secp256k1_fe_lanes_mul(r, &t, b);
+}
+
+#endif /* SECP256K1_FIELD_LANES_IMPL_H */
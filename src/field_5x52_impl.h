@@ -587,4 +587,8 @@ static void secp256k1_fe_inv_var(secp256k1_fe *r, const secp256k1_fe *x) {
 #endif
 }
 
+#if defined(USE_FIELD_LANES_AVX512IFMA)
+#include "field_5x52_ifma_impl.h"
+#endif
+
 #endif /* SECP256K1_FIELD_REPR_IMPL_H */
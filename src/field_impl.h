@@ -147,6 +147,190 @@ static int secp256k1_fe_sqrt(secp256k1_fe *r, const secp256k1_fe *a) {
     return secp256k1_fe_equal(&t1, a);
 }
 
+/** Number of square roots computed in lockstep by secp256k1_fe_sqrt_batch. */
+#define FE_SQRT_BATCH_SIZE 2
+
+/** Minimum number of square roots for which secp256k1_fe_sqrt_batch uses the
+ *  multi-lane field arithmetic, if available. */
+#define FE_SQRT_LANES_MIN 2
+
+/* Sets r[i] = a[i]^(2^n) * b[i] for i < len */
+static void secp256k1_fe_sqr_n_mul_batch(secp256k1_fe *r, const secp256k1_fe *a, int n, const secp256k1_fe *b, size_t len) {
+    size_t i;
+    int j;
+    for (i = 0; i < len; i++) {
+        r[i] = a[i];
+    }
+    for (j = 0; j < n; j++) {
+        for (i = 0; i < len; i++) {
+            secp256k1_fe_sqr(&r[i], &r[i]);
+        }
+    }
+    for (i = 0; i < len; i++) {
+        secp256k1_fe_mul(&r[i], &r[i], &b[i]);
+    }
+}
+
+#ifdef SECP256K1_FE_LANES
+/* Same as secp256k1_fe_sqrt_batch for len <= SECP256K1_FE_LANES, with the
+ * exponentiations of all inputs computed in the lanes of the multi-lane field
+ * arithmetic. */
+SECP256K1_FE_LANES_TARGET static void secp256k1_fe_sqrt_lanes(secp256k1_fe *r, int *ret, const secp256k1_fe *a, size_t len) {
+    secp256k1_fe_lanes x1, x2, x3, x6, x11, x22, x44, x88, t1;
+    secp256k1_fe t;
+    size_t i;
+
+    secp256k1_fe_lanes_load(&x1, a, len);
+    secp256k1_fe_lanes_sqr_n_mul(&x2, &x1, 1, &x1);
+    secp256k1_fe_lanes_sqr_n_mul(&x3, &x2, 1, &x1);
+    secp256k1_fe_lanes_sqr_n_mul(&x6, &x3, 3, &x3);
+    secp256k1_fe_lanes_sqr_n_mul(&t1, &x6, 3, &x3);       /* x9 */
+    secp256k1_fe_lanes_sqr_n_mul(&x11, &t1, 2, &x2);
+    secp256k1_fe_lanes_sqr_n_mul(&x22, &x11, 11, &x11);
+    secp256k1_fe_lanes_sqr_n_mul(&x44, &x22, 22, &x22);
+    secp256k1_fe_lanes_sqr_n_mul(&x88, &x44, 44, &x44);
+    secp256k1_fe_lanes_sqr_n_mul(&t1, &x88, 88, &x88);    /* x176 */
+    secp256k1_fe_lanes_sqr_n_mul(&x6, &t1, 44, &x44);     /* x220 */
+    secp256k1_fe_lanes_sqr_n_mul(&t1, &x6, 3, &x3);       /* x223 */
+    secp256k1_fe_lanes_sqr_n_mul(&x6, &t1, 23, &x22);
+    secp256k1_fe_lanes_sqr_n_mul(&t1, &x6, 6, &x2);
+    secp256k1_fe_lanes_sqr(&t1, &t1);
+    secp256k1_fe_lanes_sqr(&t1, &t1);
+    secp256k1_fe_lanes_store(r, &t1, len);
+    for (i = 0; i < len; i++) {
+        /* Check that a square root was actually calculated */
+        secp256k1_fe_sqr(&t, &r[i]);
+        ret[i] = secp256k1_fe_equal(&t, &a[i]);
+    }
+}
+#endif
+
+static void secp256k1_fe_sqrt_batch(secp256k1_fe *r, int *ret, const secp256k1_fe *a, size_t len) {
+    secp256k1_fe x2[FE_SQRT_BATCH_SIZE], x3[FE_SQRT_BATCH_SIZE], x6[FE_SQRT_BATCH_SIZE];
+    secp256k1_fe x11[FE_SQRT_BATCH_SIZE], x22[FE_SQRT_BATCH_SIZE], x44[FE_SQRT_BATCH_SIZE];
+    secp256k1_fe x88[FE_SQRT_BATCH_SIZE], t1[FE_SQRT_BATCH_SIZE];
+    size_t i, n;
+
+    VERIFY_CHECK(r != a);
+#ifdef SECP256K1_FE_LANES
+    if (len >= FE_SQRT_LANES_MIN && secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA)) {
+        while (len > 0) {
+            n = len < SECP256K1_FE_LANES ? len : SECP256K1_FE_LANES;
+            secp256k1_fe_sqrt_lanes(r, ret, a, n);
+            r += n;
+            ret += n;
+            a += n;
+            len -= n;
+        }
+        return;
+    }
+#endif
+    /* Same addition chain as in secp256k1_fe_sqrt, with every step applied to
+     * all elements of a chunk before moving on to the next step. Some of the
+     * intermediate values are stored in the same arrays once they are not
+     * needed anymore. */
+    while (len > 0) {
+        n = len < FE_SQRT_BATCH_SIZE ? len : FE_SQRT_BATCH_SIZE;
+        secp256k1_fe_sqr_n_mul_batch(x2, a, 1, a, n);
+        secp256k1_fe_sqr_n_mul_batch(x3, x2, 1, a, n);
+        secp256k1_fe_sqr_n_mul_batch(x6, x3, 3, x3, n);
+        secp256k1_fe_sqr_n_mul_batch(t1, x6, 3, x3, n);       /* x9 */
+        secp256k1_fe_sqr_n_mul_batch(x11, t1, 2, x2, n);
+        secp256k1_fe_sqr_n_mul_batch(x22, x11, 11, x11, n);
+        secp256k1_fe_sqr_n_mul_batch(x44, x22, 22, x22, n);
+        secp256k1_fe_sqr_n_mul_batch(x88, x44, 44, x44, n);
+        secp256k1_fe_sqr_n_mul_batch(t1, x88, 88, x88, n);    /* x176 */
+        secp256k1_fe_sqr_n_mul_batch(x6, t1, 44, x44, n);     /* x220 */
+        secp256k1_fe_sqr_n_mul_batch(t1, x6, 3, x3, n);       /* x223 */
+        secp256k1_fe_sqr_n_mul_batch(x6, t1, 23, x22, n);
+        secp256k1_fe_sqr_n_mul_batch(t1, x6, 6, x2, n);
+        for (i = 0; i < n; i++) {
+            secp256k1_fe_sqr(&t1[i], &t1[i]);
+            secp256k1_fe_sqr(&r[i], &t1[i]);
+            /* Check that a square root was actually calculated */
+            secp256k1_fe_sqr(&t1[i], &r[i]);
+            ret[i] = secp256k1_fe_equal(&t1[i], &a[i]);
+        }
+        r += n;
+        ret += n;
+        a += n;
+        len -= n;
+    }
+}
+
 static const secp256k1_fe secp256k1_fe_one = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1);
 
+static void secp256k1_fe_inv_all(secp256k1_fe *r, const secp256k1_fe *a, size_t len) {
+    secp256k1_fe u, t;
+    size_t i;
+    int zero;
+
+    VERIFY_CHECK(r != a || len == 0);
+    if (len == 0) {
+        return;
+    }
+    /* Compute the prefix products r[i] = a[0]*...*a[i] with zero inputs
+     * replaced by one, so that their product can be inverted. */
+    for (i = 0; i < len; i++) {
+        t = a[i];
+        secp256k1_fe_cmov(&t, &secp256k1_fe_one, secp256k1_fe_normalizes_to_zero(&t));
+        if (i == 0) {
+            r[0] = t;
+        } else {
+            secp256k1_fe_mul(&r[i], &r[i - 1], &t);
+        }
+    }
+    secp256k1_fe_inv(&u, &r[len - 1]);
+
+    /* u = 1/(a[0]*...*a[i]) at the start of every iteration. */
+    for (i = len - 1; i > 0; i--) {
+        t = a[i];
+        zero = secp256k1_fe_normalizes_to_zero(&t);
+        secp256k1_fe_cmov(&t, &secp256k1_fe_one, zero);
+        secp256k1_fe_mul(&r[i], &r[i - 1], &u);
+        secp256k1_fe_mul(&u, &u, &t);
+        secp256k1_fe_clear(&t);
+        secp256k1_fe_cmov(&r[i], &t, zero);
+    }
+    secp256k1_fe_clear(&t);
+    secp256k1_fe_cmov(&u, &t, secp256k1_fe_normalizes_to_zero(&a[0]));
+    r[0] = u;
+}
+
+static void secp256k1_fe_inv_all_var(secp256k1_fe *r, const secp256k1_fe *a, size_t len) {
+    secp256k1_fe u;
+    size_t i;
+    size_t last_i = SIZE_MAX;
+
+    VERIFY_CHECK(r != a || len == 0);
+    /* Compute the prefix products of the nonzero inputs. */
+    for (i = 0; i < len; i++) {
+        if (secp256k1_fe_normalizes_to_zero_var(&a[i])) {
+            secp256k1_fe_clear(&r[i]);
+        } else {
+            if (last_i == SIZE_MAX) {
+                r[i] = a[i];
+            } else {
+                secp256k1_fe_mul(&r[i], &r[last_i], &a[i]);
+            }
+            last_i = i;
+        }
+    }
+    if (last_i == SIZE_MAX) {
+        return;
+    }
+    secp256k1_fe_inv_var(&u, &r[last_i]);
+
+    i = last_i;
+    while (i > 0) {
+        i--;
+        if (!secp256k1_fe_normalizes_to_zero_var(&a[i])) {
+            secp256k1_fe_mul(&r[last_i], &r[i], &u);
+            secp256k1_fe_mul(&u, &u, &a[last_i]);
+            last_i = i;
+        }
+    }
+    r[last_i] = u;
+}
+
 #endif /* SECP256K1_FIELD_IMPL_H */
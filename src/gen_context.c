@@ -16,9 +16,9 @@
  * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
  ***********************************************************************/
 
-/* Autotools creates libsecp256k1-config.h, of which ECMULT_GEN_PREC_BITS is needed.
+/* Autotools creates libsecp256k1-config.h, of which ECMULT_GEN_COMB_BLOCKS and ECMULT_GEN_COMB_TEETH are needed.
    ifndef guard so downstream users can define their own if they do not use autotools. */
-#if !defined(ECMULT_GEN_PREC_BITS)
+#if !defined(ECMULT_GEN_COMB_BLOCKS) || !defined(ECMULT_GEN_COMB_TEETH)
 #include "libsecp256k1-config.h"
 #endif
 
@@ -70,26 +70,26 @@ int main(int argc, char **argv) {
     fprintf(fp, "#define SECP256K1_ECMULT_STATIC_CONTEXT_H\n");
     fprintf(fp, "#include \"src/group.h\"\n");
     fprintf(fp, "#define SC SECP256K1_GE_STORAGE_CONST\n");
-    fprintf(fp, "#if ECMULT_GEN_PREC_N != %d || ECMULT_GEN_PREC_G != %d\n", ECMULT_GEN_PREC_N, ECMULT_GEN_PREC_G);
-    fprintf(fp, "   #error configuration mismatch, invalid ECMULT_GEN_PREC_N, ECMULT_GEN_PREC_G. Try deleting ecmult_static_context.h before the build.\n");
+    fprintf(fp, "#if ECMULT_GEN_COMB_BLOCKS != %d || ECMULT_GEN_COMB_TEETH != %d\n", ECMULT_GEN_COMB_BLOCKS, ECMULT_GEN_COMB_TEETH);
+    fprintf(fp, "   #error configuration mismatch, invalid ECMULT_GEN_COMB_BLOCKS, ECMULT_GEN_COMB_TEETH. Try deleting ecmult_static_context.h before the build.\n");
     fprintf(fp, "#endif\n");
-    fprintf(fp, "static const secp256k1_ge_storage secp256k1_ecmult_static_context[ECMULT_GEN_PREC_N][ECMULT_GEN_PREC_G] = {\n");
+    fprintf(fp, "static const secp256k1_ge_storage secp256k1_ecmult_static_context[ECMULT_GEN_COMB_BLOCKS][ECMULT_GEN_COMB_POINTS] = {\n");
 
     base = checked_malloc(&default_error_callback, SECP256K1_ECMULT_GEN_CONTEXT_PREALLOCATED_SIZE);
     prealloc = base;
     secp256k1_ecmult_gen_context_init(&ctx);
     secp256k1_ecmult_gen_context_build(&ctx, &prealloc);
-    for(outer = 0; outer != ECMULT_GEN_PREC_N; outer++) {
+    for(outer = 0; outer != ECMULT_GEN_COMB_BLOCKS; outer++) {
         fprintf(fp,"{\n");
-        for(inner = 0; inner != ECMULT_GEN_PREC_G; inner++) {
+        for(inner = 0; inner != ECMULT_GEN_COMB_POINTS; inner++) {
             fprintf(fp,"    SC(%uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu, %uu)", SECP256K1_GE_STORAGE_CONST_GET((*ctx.prec)[outer][inner]));
-            if (inner != ECMULT_GEN_PREC_G - 1) {
+            if (inner != ECMULT_GEN_COMB_POINTS - 1) {
                 fprintf(fp,",\n");
             } else {
                 fprintf(fp,"\n");
             }
         }
-        if (outer != ECMULT_GEN_PREC_N - 1) {
+        if (outer != ECMULT_GEN_COMB_BLOCKS - 1) {
             fprintf(fp,"},\n");
         } else {
             fprintf(fp,"}\n");
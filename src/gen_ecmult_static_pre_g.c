@@ -18,6 +18,8 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* Autotools creates libsecp256k1-config.h, of which ECMULT_WINDOW_SIZE is needed.
    ifndef guard so downstream users can define their own if they do not use autotools. */
@@ -36,6 +38,7 @@
 #include "util.h"
 #include "field_impl.h"
 #include "group_impl.h"
+#include "hash_impl.h"
 #include "ecmult.h"
 
 void print_table(FILE *fp, const char *name, int window_g, const secp256k1_gej *gen, int with_conditionals) {
@@ -91,7 +94,80 @@ void print_two_tables(FILE *fp, int window_g, const secp256k1_ge *g, int with_co
     print_table(fp, "secp256k1_pre_g_128", window_g, &gj, with_conditionals);
 }
 
-int main(void) {
+static int write_table(FILE *fp, secp256k1_sha256 *hash, int window_g, const secp256k1_gej *gen) {
+    secp256k1_gej gj;
+    secp256k1_ge ge, dgen;
+    secp256k1_ge_storage ges;
+    long j;
+
+    gj = *gen;
+    secp256k1_ge_set_gej_var(&ge, &gj);
+    secp256k1_gej_double_var(&gj, gen, NULL);
+    secp256k1_ge_set_gej_var(&dgen, &gj);
+    for (j = 0; j < ECMULT_TABLE_SIZE(window_g); ++j) {
+        if (j > 0) {
+            secp256k1_gej_set_ge(&gj, &ge);
+            secp256k1_gej_add_ge_var(&gj, &gj, &dgen, NULL);
+            secp256k1_ge_set_gej_var(&ge, &gj);
+        }
+        secp256k1_ge_to_storage(&ges, &ge);
+        secp256k1_sha256_write(hash, (const unsigned char *)&ges, sizeof(ges));
+        if (fwrite(&ges, sizeof(ges), 1, fp) != 1) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void write_be32(unsigned char *p, uint32_t x) {
+    p[0] = x >> 24;
+    p[1] = x >> 16;
+    p[2] = x >> 8;
+    p[3] = x;
+}
+
+/* Writes tables of the given window size for secp256k1_context_set_ecmult_tables
+ * to the file at path in the format described in ecmult.h. */
+static int write_tables(const char *path, int window_g) {
+    const secp256k1_ge g = SECP256K1_G;
+    unsigned char header[ECMULT_TABLES_HEADER_SIZE] = {0};
+    secp256k1_sha256 hash;
+    secp256k1_gej gj;
+    FILE* fp;
+    int i;
+    int ret = 1;
+
+    memcpy(header, ECMULT_TABLES_MAGIC, 8);
+    write_be32(&header[8], ECMULT_TABLES_VERSION);
+    write_be32(&header[12], window_g);
+    write_be32(&header[16], sizeof(secp256k1_ge_storage));
+    secp256k1_sha256_initialize(&hash);
+    secp256k1_sha256_write(&hash, header, 32);
+
+    fp = fopen(path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Could not open %s for writing!\n", path);
+        return 0;
+    }
+    /* The checksum is filled in after the tables have been written. */
+    ret &= fwrite(header, sizeof(header), 1, fp) == 1;
+    secp256k1_gej_set_ge(&gj, &g);
+    ret &= write_table(fp, &hash, window_g, &gj);
+    for (i = 0; i < 128; ++i) {
+        secp256k1_gej_double_var(&gj, &gj, NULL);
+    }
+    ret &= write_table(fp, &hash, window_g, &gj);
+    secp256k1_sha256_finalize(&hash, &header[32]);
+    ret &= fseek(fp, 32, SEEK_SET) == 0;
+    ret &= fwrite(&header[32], 32, 1, fp) == 1;
+    ret &= fclose(fp) == 0;
+    if (!ret) {
+        fprintf(stderr, "Could not write %s!\n", path);
+    }
+    return ret;
+}
+
+int main(int argc, char **argv) {
     const secp256k1_ge g = SECP256K1_G;
     const secp256k1_ge g_13 = SECP256K1_G_ORDER_13;
     const secp256k1_ge g_199 = SECP256K1_G_ORDER_199;
@@ -99,6 +175,19 @@ int main(void) {
     const int window_g_199 = 8;
     FILE* fp;
 
+    if (argc == 3) {
+        int window_g = atoi(argv[1]);
+        if (window_g < 2 || window_g > 24) {
+            fprintf(stderr, "Window size must be in range [2..24].\n");
+            return -1;
+        }
+        return write_tables(argv[2], window_g) ? 0 : -1;
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [window_size output_file]\n", argv[0]);
+        fprintf(stderr, "Without arguments, src/ecmult_static_pre_g.h is generated.\n");
+        return -1;
+    }
+
     fp = fopen("src/ecmult_static_pre_g.h","w");
     if (fp == NULL) {
         fprintf(stderr, "Could not open src/ecmult_static_pre_g.h for writing!\n");
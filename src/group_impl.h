@@ -130,6 +130,32 @@ static void secp256k1_ge_set_gej_var(secp256k1_ge *r, secp256k1_gej *a) {
     secp256k1_ge_set_xy(r, &a->x, &a->y);
 }
 
+static void secp256k1_ge_set_all_gej(secp256k1_ge *r, const secp256k1_gej *a, size_t len) {
+    secp256k1_fe u;
+    size_t i;
+
+    if (len == 0) {
+        return;
+    }
+    /* Use destination's x coordinates as scratch space */
+    r[0].x = a[0].z;
+    for (i = 1; i < len; i++) {
+        secp256k1_fe_mul(&r[i].x, &r[i - 1].x, &a[i].z);
+    }
+    secp256k1_fe_inv(&u, &r[len - 1].x);
+
+    for (i = len - 1; i > 0; i--) {
+        secp256k1_fe_mul(&r[i].x, &r[i - 1].x, &u);
+        secp256k1_fe_mul(&u, &u, &a[i].z);
+    }
+    r[0].x = u;
+
+    for (i = 0; i < len; i++) {
+        VERIFY_CHECK(!a[i].infinity);
+        secp256k1_ge_set_gej_zinv(&r[i], &a[i], &r[i].x);
+    }
+}
+
 static void secp256k1_ge_set_all_gej_var(secp256k1_ge *r, const secp256k1_gej *a, size_t len) {
     secp256k1_fe u;
     size_t i;
@@ -241,6 +267,45 @@ static int secp256k1_ge_set_xo_var(secp256k1_ge *r, const secp256k1_fe *x, int o
 
 }
 
+/** Number of square roots secp256k1_ge_set_xo_batch_var passes to
+ *  secp256k1_fe_sqrt_batch at once, enough to fill all lanes of the
+ *  multi-lane field arithmetic. */
+#ifdef SECP256K1_FE_LANES
+#define GE_SET_XO_BATCH_SIZE SECP256K1_FE_LANES
+#else
+#define GE_SET_XO_BATCH_SIZE FE_SQRT_BATCH_SIZE
+#endif
+
+static void secp256k1_ge_set_xo_batch_var(secp256k1_ge *r, int *ret, const secp256k1_fe *x, const int *odd, size_t len) {
+    secp256k1_fe x3[GE_SET_XO_BATCH_SIZE];
+    secp256k1_fe y[GE_SET_XO_BATCH_SIZE];
+    size_t i, n;
+
+    while (len > 0) {
+        n = len < GE_SET_XO_BATCH_SIZE ? len : GE_SET_XO_BATCH_SIZE;
+        for (i = 0; i < n; i++) {
+            r[i].x = x[i];
+            secp256k1_fe_sqr(&x3[i], &x[i]);
+            secp256k1_fe_mul(&x3[i], &x3[i], &x[i]);
+            secp256k1_fe_add(&x3[i], &secp256k1_fe_const_b);
+            r[i].infinity = 0;
+        }
+        secp256k1_fe_sqrt_batch(y, ret, x3, n);
+        for (i = 0; i < n; i++) {
+            r[i].y = y[i];
+            secp256k1_fe_normalize_var(&r[i].y);
+            if (secp256k1_fe_is_odd(&r[i].y) != odd[i]) {
+                secp256k1_fe_negate(&r[i].y, &r[i].y, 1);
+            }
+        }
+        r += n;
+        ret += n;
+        x += n;
+        odd += n;
+        len -= n;
+    }
+}
+
 static void secp256k1_gej_set_ge(secp256k1_gej *r, const secp256k1_ge *a) {
    r->infinity = a->infinity;
    r->x = a->x;
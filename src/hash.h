@@ -31,6 +31,8 @@ typedef struct {
 static void secp256k1_sha256_initialize(secp256k1_sha256 *hash);
 static void secp256k1_sha256_write(secp256k1_sha256 *hash, const unsigned char *data, size_t size);
 static void secp256k1_sha256_finalize(secp256k1_sha256 *hash, unsigned char *out32);
+/* Computes the hashes of n messages, each continuing from the state in hash, to out32 (32*n bytes). */
+static void secp256k1_sha256_batch(const secp256k1_sha256 *hash, unsigned char *out32, const unsigned char *const *data, const size_t *len, size_t n);
 
 typedef struct {
     secp256k1_sha256 inner, outer;
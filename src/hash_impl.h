@@ -21,6 +21,7 @@
 
 #include "hash.h"
 #include "util.h"
+#include "cpu.h"
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -46,6 +47,12 @@
 #define BE32(p) ((((p) & 0xFF) << 24) | (((p) & 0xFF00) << 8) | (((p) & 0xFF0000) >> 8) | (((p) & 0xFF000000) >> 24))
 #endif
 
+#if defined(USE_RUNTIME_CPU_DISPATCH) && (defined(__x86_64__) || defined(__i386__))
+#define SECP256K1_SHA256_SHANI
+#define SECP256K1_SHA256_LANES
+#include "hash_shani_impl.h"
+#endif
+
 static void secp256k1_sha256_initialize(secp256k1_sha256 *hash) {
     hash->s[0] = 0x6a09e667ul;
     hash->s[1] = 0xbb67ae85ul;
@@ -63,6 +70,13 @@ static void secp256k1_sha256_transform(uint32_t* s, const uint32_t* chunk) {
     uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
     uint32_t w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
 
+#ifdef SECP256K1_SHA256_SHANI
+    if (secp256k1_cpu_has(SECP256K1_CPU_SHA)) {
+        secp256k1_sha256_transform_shani(s, chunk);
+        return;
+    }
+#endif
+
     Round(a, b, c, d, e, f, g, h, 0x428a2f98, w0 = BE32(chunk[0]));
     Round(h, a, b, c, d, e, f, g, 0x71374491, w1 = BE32(chunk[1]));
     Round(g, h, a, b, c, d, e, f, 0xb5c0fbcf, w2 = BE32(chunk[2]));
@@ -189,6 +203,74 @@ static void secp256k1_sha256_initialize_tagged(secp256k1_sha256 *hash, const uns
     secp256k1_sha256_write(hash, buf, 32);
 }
 
+/* Returns a pointer to block j of the padded message data (of length len),
+ * where the message continues a hash after the given number of bytes. Blocks
+ * that contain padding are written to buf64. Returns NULL if the padded
+ * message has fewer than j + 1 blocks. */
+static const unsigned char *secp256k1_sha256_batch_block(unsigned char *buf64, const unsigned char *data, size_t len, uint64_t bytes, size_t j) {
+    size_t nblocks = (len + 8) / 64 + 1;
+    size_t off = j * 64;
+    if (j >= nblocks) {
+        return NULL;
+    }
+    if (off + 64 <= len) {
+        return data + off;
+    }
+    memset(buf64, 0, 64);
+    if (off < len) {
+        memcpy(buf64, data + off, len - off);
+    }
+    if (off <= len) {
+        buf64[len - off] = 0x80;
+    }
+    if (j == nblocks - 1) {
+        uint64_t bits = (bytes + len) << 3;
+        int i;
+        for (i = 0; i < 8; i++) {
+            buf64[56 + i] = (bits >> (56 - 8*i)) & 0xFF;
+        }
+    }
+    return buf64;
+}
+
+#ifdef SECP256K1_SHA256_LANES
+#include "hash_lanes_impl.h"
+
+/* Minimum number of messages for which the multi-buffer implementations are
+ * faster than hashing the messages one by one, without and with the SHA
+ * extensions. */
+#define SHA256_LANES_MIN 2
+#define SHA256_LANES_MIN_SHANI 8
+#endif
+
+static void secp256k1_sha256_batch(const secp256k1_sha256 *hash, unsigned char *out32, const unsigned char *const *data, const size_t *len, size_t n) {
+    size_t i = 0;
+#ifdef SECP256K1_SHA256_LANES
+    if ((hash->bytes & 0x3F) == 0) {
+        size_t min = secp256k1_cpu_has(SECP256K1_CPU_SHA) ? SHA256_LANES_MIN_SHANI : SHA256_LANES_MIN;
+        if (secp256k1_cpu_has(SECP256K1_CPU_AVX512F)) {
+            while (n - i >= min) {
+                size_t k = n - i < 16 ? n - i : 16;
+                secp256k1_sha256_lanes16(hash, out32 + 32 * i, data + i, len + i, k);
+                i += k;
+            }
+        } else if (secp256k1_cpu_has(SECP256K1_CPU_AVX2) && !secp256k1_cpu_has(SECP256K1_CPU_SHA)) {
+            /* On CPUs without AVX-512, the SHA extensions are preferable. */
+            while (n - i >= min) {
+                size_t k = n - i < 8 ? n - i : 8;
+                secp256k1_sha256_lanes8(hash, out32 + 32 * i, data + i, len + i, k);
+                i += k;
+            }
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        secp256k1_sha256 sha = *hash;
+        secp256k1_sha256_write(&sha, data[i], len[i]);
+        secp256k1_sha256_finalize(&sha, out32 + 32 * i);
+    }
+}
+
 static void secp256k1_hmac_sha256_initialize(secp256k1_hmac_sha256 *hash, const unsigned char *key, size_t keylen) {
     size_t n;
     unsigned char rkey[64];
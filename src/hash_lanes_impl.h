@@ -0,0 +1,277 @@
+// © Licensed Authorship: Manuel J. Nieves (See LICENSE for terms)
+/*
+ * Copyright (c) 2008–2025 Manuel J. Nieves (a.k.a. Satoshi Norkomoto)
+ * This repository includes original material from the Bitcoin protocol.
+ *
+ * Redistribution requires this notice remain intact.
+ * Derivative works must state derivative status.
+ * Commercial use requires licensing.
+ *
+ * GPG Signed: B4EC 7343 AB0D BF24
+ * Contact: Fordamboy1@gmail.com
+ */
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_HASH_LANES_IMPL_H
+#define SECP256K1_HASH_LANES_IMPL_H
+
+/** Multi-buffer SHA-256 using AVX2 and AVX-512.
+ *
+ *  These functions hash up to 8 (AVX2) or 16 (AVX-512) independent messages
+ *  at once, with word i of every message's state in one lane of vector s[i].
+ *  All messages continue from the same state hash, which must be at a block
+ *  boundary. Messages that are shorter than others stop updating their lane
+ *  once their final block has been processed.
+ *
+ *  The functions are compiled for their target regardless of the compiler
+ *  flags, and must only be called if secp256k1_cpu_has reports the
+ *  corresponding feature.
+ */
+
+#include <immintrin.h>
+
+#include "cpu.h"
+
+static const uint32_t secp256k1_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/* Block hashed in lanes without a message, whose result is discarded. */
+static const unsigned char secp256k1_sha256_lanes_unused[64] = { 0 };
+
+/* Round and message schedule for LANES_* vector primitives defined by the callers. */
+#define LANES_ROUND(a,b,c,d,e,f,g,h,i) do { \
+    t1 = LANES_ADD(LANES_ADD(LANES_ADD(h, LANES_XOR3(LANES_ROR(e, 6), LANES_ROR(e, 11), LANES_ROR(e, 25))), \
+                             LANES_ADD(LANES_CH(e, f, g), LANES_SET1(secp256k1_sha256_k[i]))), w[(i) & 15]); \
+    t2 = LANES_ADD(LANES_XOR3(LANES_ROR(a, 2), LANES_ROR(a, 13), LANES_ROR(a, 22)), LANES_MAJ(a, b, c)); \
+    d = LANES_ADD(d, t1); \
+    h = LANES_ADD(t1, t2); \
+} while(0)
+
+#define LANES_SCHEDULE(i) do { \
+    w[(i) & 15] = LANES_ADD(LANES_ADD(w[(i) & 15], w[((i) + 9) & 15]), \
+                            LANES_ADD(LANES_XOR3(LANES_ROR(w[((i) + 14) & 15], 17), LANES_ROR(w[((i) + 14) & 15], 19), LANES_SHR(w[((i) + 14) & 15], 10)), \
+                                      LANES_XOR3(LANES_ROR(w[((i) + 1) & 15], 7), LANES_ROR(w[((i) + 1) & 15], 18), LANES_SHR(w[((i) + 1) & 15], 3)))); \
+} while(0)
+
+/* Run the 64 rounds on the state in s and the message words in w, leaving the result in a..h. */
+#define LANES_TRANSFORM() do { \
+    a = s[0]; b = s[1]; c = s[2]; d = s[3]; e = s[4]; f = s[5]; g = s[6]; h = s[7]; \
+    for (i = 0; i < 64; i += 8) { \
+        if (i >= 16) { \
+            LANES_SCHEDULE(i); LANES_SCHEDULE(i + 1); LANES_SCHEDULE(i + 2); LANES_SCHEDULE(i + 3); \
+            LANES_SCHEDULE(i + 4); LANES_SCHEDULE(i + 5); LANES_SCHEDULE(i + 6); LANES_SCHEDULE(i + 7); \
+        } \
+        LANES_ROUND(a, b, c, d, e, f, g, h, i); \
+        LANES_ROUND(h, a, b, c, d, e, f, g, i + 1); \
+        LANES_ROUND(g, h, a, b, c, d, e, f, i + 2); \
+        LANES_ROUND(f, g, h, a, b, c, d, e, i + 3); \
+        LANES_ROUND(e, f, g, h, a, b, c, d, i + 4); \
+        LANES_ROUND(d, e, f, g, h, a, b, c, i + 5); \
+        LANES_ROUND(c, d, e, f, g, h, a, b, i + 6); \
+        LANES_ROUND(b, c, d, e, f, g, h, a, i + 7); \
+    } \
+} while(0)
+
+/* Write the big endian hash of lane l of the state, stored in words[i * lanes + l], to out32. */
+static void secp256k1_sha256_lanes_output(unsigned char *out32, const uint32_t *words, size_t lanes, size_t l) {
+    int i;
+    for (i = 0; i < 8; i++) {
+        uint32_t x = words[i * lanes + l];
+        out32[4*i] = x >> 24;
+        out32[4*i + 1] = x >> 16;
+        out32[4*i + 2] = x >> 8;
+        out32[4*i + 3] = x;
+    }
+}
+
+#define LANES_ADD(x, y) _mm256_add_epi32(x, y)
+#define LANES_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define LANES_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define LANES_SHR(x, n) _mm256_srli_epi32(x, n)
+#define LANES_CH(x, y, z) _mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z)))
+#define LANES_MAJ(x, y, z) _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_or_si256(x, y)))
+#define LANES_SET1(x) _mm256_set1_epi32((int)(x))
+
+__attribute__((target("avx2"))) static void secp256k1_sha256_lanes8(const secp256k1_sha256 *hash, unsigned char *out32, const unsigned char *const *data, const size_t *len, size_t n) {
+    const __m256i bswap = _mm256_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL, 0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+    unsigned char buf[8][64];
+    uint32_t words[8 * 8];
+    __m256i s[8], w[16], r[8], t[8], a, b, c, d, e, f, g, h, t1, t2, active;
+    int32_t mask[8];
+    const unsigned char *blk[8];
+    size_t l, j;
+    int i, k, more;
+
+    VERIFY_CHECK(n <= 8);
+    VERIFY_CHECK((hash->bytes & 0x3F) == 0);
+
+    for (i = 0; i < 8; i++) {
+        s[i] = LANES_SET1(hash->s[i]);
+    }
+    for (j = 0; ; j++) {
+        more = 0;
+        for (l = 0; l < 8; l++) {
+            blk[l] = l < n ? secp256k1_sha256_batch_block(buf[l], data[l], len[l], hash->bytes, j) : NULL;
+            mask[l] = -(blk[l] != NULL);
+            more |= mask[l];
+            if (blk[l] == NULL) {
+                blk[l] = secp256k1_sha256_lanes_unused;
+            }
+        }
+        if (!more) {
+            break;
+        }
+        /* Transpose the two 8x8 halves of the blocks, so that w[i] holds word i of every lane. */
+        for (k = 0; k < 2; k++) {
+            for (i = 0; i < 8; i++) {
+                r[i] = _mm256_shuffle_epi8(_mm256_loadu_si256((const void*)(blk[i] + 32 * k)), bswap);
+            }
+            for (i = 0; i < 8; i += 2) {
+                t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+                t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+            }
+            for (i = 0; i < 8; i += 4) {
+                r[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+                r[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+                r[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+                r[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+            }
+            for (i = 0; i < 4; i++) {
+                w[8 * k + i] = _mm256_permute2x128_si256(r[i], r[i + 4], 0x20);
+                w[8 * k + i + 4] = _mm256_permute2x128_si256(r[i], r[i + 4], 0x31);
+            }
+        }
+        LANES_TRANSFORM();
+        active = _mm256_loadu_si256((const void*)mask);
+        s[0] = _mm256_blendv_epi8(s[0], LANES_ADD(s[0], a), active);
+        s[1] = _mm256_blendv_epi8(s[1], LANES_ADD(s[1], b), active);
+        s[2] = _mm256_blendv_epi8(s[2], LANES_ADD(s[2], c), active);
+        s[3] = _mm256_blendv_epi8(s[3], LANES_ADD(s[3], d), active);
+        s[4] = _mm256_blendv_epi8(s[4], LANES_ADD(s[4], e), active);
+        s[5] = _mm256_blendv_epi8(s[5], LANES_ADD(s[5], f), active);
+        s[6] = _mm256_blendv_epi8(s[6], LANES_ADD(s[6], g), active);
+        s[7] = _mm256_blendv_epi8(s[7], LANES_ADD(s[7], h), active);
+    }
+    for (i = 0; i < 8; i++) {
+        _mm256_storeu_si256((void*)&words[8 * i], s[i]);
+    }
+    for (l = 0; l < n; l++) {
+        secp256k1_sha256_lanes_output(out32 + 32 * l, words, 8, l);
+    }
+}
+
+#undef LANES_ADD
+#undef LANES_XOR3
+#undef LANES_ROR
+#undef LANES_SHR
+#undef LANES_CH
+#undef LANES_MAJ
+#undef LANES_SET1
+
+#define LANES_ADD(x, y) _mm512_add_epi32(x, y)
+#define LANES_XOR3(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#define LANES_ROR(x, n) _mm512_ror_epi32(x, n)
+#define LANES_SHR(x, n) _mm512_srli_epi32(x, n)
+#define LANES_CH(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xca)
+#define LANES_MAJ(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xe8)
+#define LANES_SET1(x) _mm512_set1_epi32((int)(x))
+
+__attribute__((target("avx512f"))) static void secp256k1_sha256_lanes16(const secp256k1_sha256 *hash, unsigned char *out32, const unsigned char *const *data, const size_t *len, size_t n) {
+    const __m512i bytes02 = _mm512_set1_epi32(0x00ff00ff);
+    unsigned char buf[16][64];
+    uint32_t words[8 * 16];
+    __m512i s[8], w[16], t[16], a, b, c, d, e, f, g, h, t1, t2;
+    const unsigned char *blk[16];
+    __mmask16 active;
+    size_t l, j;
+    int i;
+
+    VERIFY_CHECK(n <= 16);
+    VERIFY_CHECK((hash->bytes & 0x3F) == 0);
+
+    for (i = 0; i < 8; i++) {
+        s[i] = LANES_SET1(hash->s[i]);
+    }
+    for (j = 0; ; j++) {
+        active = 0;
+        for (l = 0; l < 16; l++) {
+            blk[l] = l < n ? secp256k1_sha256_batch_block(buf[l], data[l], len[l], hash->bytes, j) : NULL;
+            if (blk[l] != NULL) {
+                active |= (__mmask16)(1 << l);
+            } else {
+                blk[l] = secp256k1_sha256_lanes_unused;
+            }
+        }
+        if (!active) {
+            break;
+        }
+        /* Transpose the blocks, so that w[i] holds word i of every lane. */
+        for (i = 0; i < 16; i += 2) {
+            __m512i x = _mm512_loadu_si512((const void*)blk[i]);
+            __m512i y = _mm512_loadu_si512((const void*)blk[i + 1]);
+            t[i] = _mm512_unpacklo_epi32(x, y);
+            t[i + 1] = _mm512_unpackhi_epi32(x, y);
+        }
+        for (i = 0; i < 16; i += 4) {
+            w[i] = _mm512_unpacklo_epi64(t[i], t[i + 2]);
+            w[i + 1] = _mm512_unpackhi_epi64(t[i], t[i + 2]);
+            w[i + 2] = _mm512_unpacklo_epi64(t[i + 1], t[i + 3]);
+            w[i + 3] = _mm512_unpackhi_epi64(t[i + 1], t[i + 3]);
+        }
+        for (i = 0; i < 4; i++) {
+            t[i] = _mm512_shuffle_i32x4(w[i], w[i + 4], 0x88);
+            t[i + 4] = _mm512_shuffle_i32x4(w[i], w[i + 4], 0xdd);
+            t[i + 8] = _mm512_shuffle_i32x4(w[i + 8], w[i + 12], 0x88);
+            t[i + 12] = _mm512_shuffle_i32x4(w[i + 8], w[i + 12], 0xdd);
+        }
+        for (i = 0; i < 4; i++) {
+            w[i] = _mm512_shuffle_i32x4(t[i], t[i + 8], 0x88);
+            w[i + 8] = _mm512_shuffle_i32x4(t[i], t[i + 8], 0xdd);
+            w[i + 4] = _mm512_shuffle_i32x4(t[i + 4], t[i + 12], 0x88);
+            w[i + 12] = _mm512_shuffle_i32x4(t[i + 4], t[i + 12], 0xdd);
+        }
+        for (i = 0; i < 16; i++) {
+            /* Swap the bytes of each word by combining its rotations by 8 and 24 bits. */
+            w[i] = _mm512_ternarylogic_epi32(_mm512_ror_epi32(w[i], 8), _mm512_ror_epi32(w[i], 24), bytes02, 0xd8);
+        }
+        LANES_TRANSFORM();
+        s[0] = _mm512_mask_add_epi32(s[0], active, s[0], a);
+        s[1] = _mm512_mask_add_epi32(s[1], active, s[1], b);
+        s[2] = _mm512_mask_add_epi32(s[2], active, s[2], c);
+        s[3] = _mm512_mask_add_epi32(s[3], active, s[3], d);
+        s[4] = _mm512_mask_add_epi32(s[4], active, s[4], e);
+        s[5] = _mm512_mask_add_epi32(s[5], active, s[5], f);
+        s[6] = _mm512_mask_add_epi32(s[6], active, s[6], g);
+        s[7] = _mm512_mask_add_epi32(s[7], active, s[7], h);
+    }
+    for (i = 0; i < 8; i++) {
+        _mm512_storeu_si512((void*)&words[16 * i], s[i]);
+    }
+    for (l = 0; l < n; l++) {
+        secp256k1_sha256_lanes_output(out32 + 32 * l, words, 16, l);
+    }
+}
+
+#undef LANES_ADD
+#undef LANES_XOR3
+#undef LANES_ROR
+#undef LANES_SHR
+#undef LANES_CH
+#undef LANES_MAJ
+#undef LANES_SET1
+#undef LANES_ROUND
+#undef LANES_SCHEDULE
+#undef LANES_TRANSFORM
+
+#endif /* SECP256K1_HASH_LANES_IMPL_H */
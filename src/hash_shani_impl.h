@@ -0,0 +1,114 @@
+// © Licensed Authorship: Manuel J. Nieves (See LICENSE for terms)
+/*
+ * Copyright (c) 2008–2025 Manuel J. Nieves (a.k.a. Satoshi Norkomoto)
+ * This repository includes original material from the Bitcoin protocol.
+ *
+ * Redistribution requires this notice remain intact.
+ * Derivative works must state derivative status.
+ * Commercial use requires licensing.
+ *
+ * GPG Signed: B4EC 7343 AB0D BF24
+ * Contact: Fordamboy1@gmail.com
+ */
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_HASH_SHANI_IMPL_H
+#define SECP256K1_HASH_SHANI_IMPL_H
+
+/** SHA-256 transformation using the x86 SHA extensions.
+ *
+ *  The state is kept in the two registers in the order expected by
+ *  sha256rnds2 (ABEF and CDGH), and every sha256rnds2 performs two rounds.
+ *  The function is compiled for the SHA target regardless of the compiler
+ *  flags, and must only be called if secp256k1_cpu_has(SECP256K1_CPU_SHA)
+ *  returns 1.
+ */
+
+#include <immintrin.h>
+
+#include "cpu.h"
+
+#define SECP256K1_SHA256_SHANI_TARGET __attribute__((target("sha,sse4.1")))
+
+/* Four rounds on the message words m, with the round constants packed into k1:k0. */
+#define SHANI_QUADROUND(m, k1, k0) do { \
+    __m128i msg = _mm_add_epi32((m), _mm_set_epi64x((long long)(k1), (long long)(k0))); \
+    s1 = _mm_sha256rnds2_epu32(s1, s0, msg); \
+    s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(msg, 0x0e)); \
+} while(0)
+
+/* Message schedule steps: A applies sha256msg1 to m0, C completes the next four
+ * words in m2 using sha256msg2, and B does both. */
+#define SHANI_SCHEDULE_A(m0, m1) ((m0) = _mm_sha256msg1_epu32((m0), (m1)))
+#define SHANI_SCHEDULE_C(m0, m1, m2) ((m2) = _mm_sha256msg2_epu32(_mm_add_epi32((m2), _mm_alignr_epi8((m1), (m0), 4)), (m1)))
+#define SHANI_SCHEDULE_B(m0, m1, m2) do { \
+    SHANI_SCHEDULE_C(m0, m1, m2); \
+    SHANI_SCHEDULE_A(m0, m1); \
+} while(0)
+
+SECP256K1_SHA256_SHANI_TARGET static void secp256k1_sha256_transform_shani(uint32_t* s, const uint32_t* chunk) {
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+    __m128i s0, s1, so0, so1, t0, t1, m0, m1, m2, m3;
+
+    /* Rearrange the state from ABCD EFGH into ABEF CDGH. */
+    t0 = _mm_shuffle_epi32(_mm_loadu_si128((const void*)s), 0xb1);
+    t1 = _mm_shuffle_epi32(_mm_loadu_si128((const void*)(s + 4)), 0x1b);
+    s0 = _mm_alignr_epi8(t0, t1, 8);
+    s1 = _mm_blend_epi16(t1, t0, 0xf0);
+    so0 = s0;
+    so1 = s1;
+
+    m0 = _mm_shuffle_epi8(_mm_loadu_si128((const void*)chunk), bswap);
+    SHANI_QUADROUND(m0, 0xe9b5dba5b5c0fbcfULL, 0x71374491428a2f98ULL);
+    m1 = _mm_shuffle_epi8(_mm_loadu_si128((const void*)(chunk + 4)), bswap);
+    SHANI_QUADROUND(m1, 0xab1c5ed5923f82a4ULL, 0x59f111f13956c25bULL);
+    SHANI_SCHEDULE_A(m0, m1);
+    m2 = _mm_shuffle_epi8(_mm_loadu_si128((const void*)(chunk + 8)), bswap);
+    SHANI_QUADROUND(m2, 0x550c7dc3243185beULL, 0x12835b01d807aa98ULL);
+    SHANI_SCHEDULE_A(m1, m2);
+    m3 = _mm_shuffle_epi8(_mm_loadu_si128((const void*)(chunk + 12)), bswap);
+    SHANI_QUADROUND(m3, 0xc19bf1749bdc06a7ULL, 0x80deb1fe72be5d74ULL);
+    SHANI_SCHEDULE_B(m2, m3, m0);
+    SHANI_QUADROUND(m0, 0x240ca1cc0fc19dc6ULL, 0xefbe4786e49b69c1ULL);
+    SHANI_SCHEDULE_B(m3, m0, m1);
+    SHANI_QUADROUND(m1, 0x76f988da5cb0a9dcULL, 0x4a7484aa2de92c6fULL);
+    SHANI_SCHEDULE_B(m0, m1, m2);
+    SHANI_QUADROUND(m2, 0xbf597fc7b00327c8ULL, 0xa831c66d983e5152ULL);
+    SHANI_SCHEDULE_B(m1, m2, m3);
+    SHANI_QUADROUND(m3, 0x1429296706ca6351ULL, 0xd5a79147c6e00bf3ULL);
+    SHANI_SCHEDULE_B(m2, m3, m0);
+    SHANI_QUADROUND(m0, 0x53380d134d2c6dfcULL, 0x2e1b213827b70a85ULL);
+    SHANI_SCHEDULE_B(m3, m0, m1);
+    SHANI_QUADROUND(m1, 0x92722c8581c2c92eULL, 0x766a0abb650a7354ULL);
+    SHANI_SCHEDULE_B(m0, m1, m2);
+    SHANI_QUADROUND(m2, 0xc76c51a3c24b8b70ULL, 0xa81a664ba2bfe8a1ULL);
+    SHANI_SCHEDULE_B(m1, m2, m3);
+    SHANI_QUADROUND(m3, 0x106aa070f40e3585ULL, 0xd6990624d192e819ULL);
+    SHANI_SCHEDULE_B(m2, m3, m0);
+    SHANI_QUADROUND(m0, 0x34b0bcb52748774cULL, 0x1e376c0819a4c116ULL);
+    SHANI_SCHEDULE_B(m3, m0, m1);
+    SHANI_QUADROUND(m1, 0x682e6ff35b9cca4fULL, 0x4ed8aa4a391c0cb3ULL);
+    SHANI_SCHEDULE_C(m0, m1, m2);
+    SHANI_QUADROUND(m2, 0x8cc7020884c87814ULL, 0x78a5636f748f82eeULL);
+    SHANI_SCHEDULE_C(m1, m2, m3);
+    SHANI_QUADROUND(m3, 0xc67178f2bef9a3f7ULL, 0xa4506ceb90befffaULL);
+
+    s0 = _mm_add_epi32(s0, so0);
+    s1 = _mm_add_epi32(s1, so1);
+
+    /* Rearrange the state back into ABCD EFGH. */
+    t0 = _mm_shuffle_epi32(s0, 0x1b);
+    t1 = _mm_shuffle_epi32(s1, 0xb1);
+    _mm_storeu_si128((void*)s, _mm_blend_epi16(t0, t1, 0xf0));
+    _mm_storeu_si128((void*)(s + 4), _mm_alignr_epi8(t1, t0, 8));
+}
+
+#undef SHANI_QUADROUND
+#undef SHANI_SCHEDULE_A
+#undef SHANI_SCHEDULE_B
+#undef SHANI_SCHEDULE_C
+
+#endif /* SECP256K1_HASH_SHANI_IMPL_H */
@@ -201,6 +201,99 @@ int secp256k1_schnorrsig_sign(const secp256k1_context* ctx, unsigned char *sig64
     return secp256k1_schnorrsig_sign_internal(ctx, sig64, msg32, 32, keypair, secp256k1_nonce_function_bip340, aux_rand32);
 }
 
+int secp256k1_schnorrsig_sign_batch(const secp256k1_context* ctx, unsigned char *sig64, const unsigned char *const *msg32, size_t n, const secp256k1_keypair *keypair, unsigned char *const *aux_rand32) {
+    secp256k1_gej rj[SECP256K1_SIGN_BATCH_CHUNK];
+    secp256k1_ge r[SECP256K1_SIGN_BATCH_CHUNK];
+    secp256k1_scalar k[SECP256K1_SIGN_BATCH_CHUNK];
+    int valid[SECP256K1_SIGN_BATCH_CHUNK];
+    unsigned char chal[SECP256K1_SIGN_BATCH_CHUNK][96];
+    const unsigned char *chal_ptr[SECP256K1_SIGN_BATCH_CHUNK];
+    size_t chal_len[SECP256K1_SIGN_BATCH_CHUNK];
+    unsigned char e32[SECP256K1_SIGN_BATCH_CHUNK * 32];
+    secp256k1_sha256 sha;
+    secp256k1_scalar sk;
+    secp256k1_scalar e;
+    secp256k1_ge pk;
+    unsigned char buf[32];
+    unsigned char pk_buf[32];
+    unsigned char seckey[32];
+    int ret = 1;
+    int all = 1;
+    size_t i, j, m;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(sig64 != NULL || n == 0);
+    ARG_CHECK(msg32 != NULL || n == 0);
+    ARG_CHECK(keypair != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(msg32[i] != NULL);
+    }
+
+    /* The keypair is loaded and the secret key negated only once for all
+     * messages, see secp256k1_schnorrsig_sign_internal. */
+    ret &= secp256k1_keypair_load(ctx, &sk, &pk, keypair);
+    if (secp256k1_fe_is_odd(&pk.y)) {
+        secp256k1_scalar_negate(&sk, &sk);
+    }
+    secp256k1_scalar_get_b32(seckey, &sk);
+    secp256k1_fe_get_b32(pk_buf, &pk.x);
+    secp256k1_schnorrsig_sha256_tagged(&sha);
+
+    for (i = 0; i < n; i += m) {
+        m = n - i < SECP256K1_SIGN_BATCH_CHUNK ? n - i : SECP256K1_SIGN_BATCH_CHUNK;
+        for (j = 0; j < m; j++) {
+            memset(buf, 0, sizeof(buf));
+            valid[j] = !!nonce_function_bip340(buf, msg32[i + j], 32, seckey, pk_buf, bip340_algo, sizeof(bip340_algo), aux_rand32 != NULL ? aux_rand32[i + j] : NULL);
+            secp256k1_scalar_set_b32(&k[j], buf, NULL);
+            valid[j] &= !secp256k1_scalar_is_zero(&k[j]);
+            secp256k1_scalar_cmov(&k[j], &secp256k1_scalar_one, !valid[j]);
+            secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &rj[j], &k[j]);
+        }
+        /* None of the nonces is zero, so none of the points is infinity. */
+        secp256k1_ge_set_all_gej(r, rj, m);
+
+        for (j = 0; j < m; j++) {
+            /* We declassify r to allow using it as a branch point. This is fine
+             * because r is not a secret. */
+            secp256k1_declassify(ctx, &r[j], sizeof(r[j]));
+            secp256k1_fe_normalize_var(&r[j].y);
+            if (secp256k1_fe_is_odd(&r[j].y)) {
+                secp256k1_scalar_negate(&k[j], &k[j]);
+            }
+            secp256k1_fe_normalize_var(&r[j].x);
+            secp256k1_fe_get_b32(&chal[j][0], &r[j].x);
+            memcpy(&chal[j][32], pk_buf, 32);
+            memcpy(&chal[j][64], msg32[i + j], 32);
+            chal_ptr[j] = chal[j];
+            chal_len[j] = sizeof(chal[j]);
+        }
+        /* tagged hash(r.x, pk.x, msg) for all messages of the chunk */
+        secp256k1_sha256_batch(&sha, e32, chal_ptr, chal_len, m);
+
+        for (j = 0; j < m; j++) {
+            unsigned char *out = &sig64[64 * (i + j)];
+            int ok = ret & valid[j];
+            secp256k1_scalar_set_b32(&e, &e32[32 * j], NULL);
+            secp256k1_scalar_mul(&e, &e, &sk);
+            secp256k1_scalar_add(&e, &e, &k[j]);
+            memcpy(&out[0], &chal[j][0], 32);
+            secp256k1_scalar_get_b32(&out[32], &e);
+            secp256k1_memczero(out, 64, !ok);
+            all &= ok;
+        }
+    }
+
+    memset(k, 0, sizeof(k));
+    memset(rj, 0, sizeof(rj));
+    memset(buf, 0, sizeof(buf));
+    secp256k1_scalar_clear(&e);
+    secp256k1_scalar_clear(&sk);
+    memset(seckey, 0, sizeof(seckey));
+
+    return all;
+}
+
 int secp256k1_schnorrsig_sign_custom(const secp256k1_context* ctx, unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_keypair *keypair, secp256k1_schnorrsig_extraparams *extraparams) {
     secp256k1_nonce_function_hardened noncefp = NULL;
     void *ndata = NULL;
@@ -252,7 +345,58 @@ int secp256k1_schnorrsig_verify(const secp256k1_context* ctx, const unsigned cha
     /* Compute rj =  s*G + (-e)*pkj */
     secp256k1_scalar_negate(&e, &e);
     secp256k1_gej_set_ge(&pkj, &pk);
-    secp256k1_ecmult(&rj, &pkj, &e, &s);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &rj, &pkj, &e, &s);
+
+    secp256k1_ge_set_gej_var(&r, &rj);
+    if (secp256k1_ge_is_infinity(&r)) {
+        return 0;
+    }
+
+    secp256k1_fe_normalize_var(&r.y);
+    return !secp256k1_fe_is_odd(&r.y) &&
+           secp256k1_fe_equal_var(&rx, &r.x);
+}
+
+int secp256k1_schnorrsig_verify_precomp(const secp256k1_context* ctx, const unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_pubkey_precomp *precomp) {
+    secp256k1_scalar s;
+    secp256k1_scalar e;
+    secp256k1_gej rj;
+    secp256k1_ge pk;
+    secp256k1_fe rx;
+    secp256k1_ge r;
+    unsigned char buf[32];
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(sig64 != NULL);
+    ARG_CHECK(msg != NULL || msglen == 0);
+    ARG_CHECK(precomp != NULL);
+
+    if (!secp256k1_fe_set_b32(&rx, &sig64[0])) {
+        return 0;
+    }
+
+    secp256k1_scalar_set_b32(&s, &sig64[32], &overflow);
+    if (overflow) {
+        return 0;
+    }
+
+    if (!secp256k1_pubkey_load(ctx, &pk, &precomp->pubkey)) {
+        return 0;
+    }
+
+    /* Compute e. */
+    secp256k1_fe_get_b32(buf, &pk.x);
+    secp256k1_schnorrsig_challenge(&e, &sig64[0], msg, msglen, buf);
+
+    /* Compute rj =  s*G + (-e)*pkj, where pkj is the x-only public key, i.e.,
+     * the precomputed point if its Y coordinate is even and its negation
+     * otherwise. */
+    secp256k1_fe_normalize_var(&pk.y);
+    if (!secp256k1_fe_is_odd(&pk.y)) {
+        secp256k1_scalar_negate(&e, &e);
+    }
+    secp256k1_ecmult_precomp(&ctx->ecmult_ctx, &rj, precomp->pre, precomp->window, &e, &s);
 
     secp256k1_ge_set_gej_var(&r, &rj);
     if (secp256k1_ge_is_infinity(&r)) {
@@ -264,4 +408,207 @@ int secp256k1_schnorrsig_verify(const secp256k1_context* ctx, const unsigned cha
            secp256k1_fe_equal_var(&rx, &r.x);
 }
 
+/* Tag used to derive the seed of the batch verification randomizers. */
+static const unsigned char schnorrsig_batch_tag[13] = "BIP0340/batch";
+
+/* Data that is used by the batch verification ecmult callback */
+typedef struct {
+    const secp256k1_context *ctx;
+    /* Seed from which the randomizers are derived */
+    unsigned char seed[32];
+    /* Signature, message, public key tuples to verify */
+    const unsigned char *const *sig64;
+    const unsigned char *const *msg;
+    const size_t *msglen;
+    const secp256k1_xonly_pubkey *const *pubkey;
+    size_t n_sigs;
+    /* Randomizers, nonce points, public keys and the randomizers multiplied
+     * by the challenges of the VERIFY_BATCH_BLOCK signatures starting at index
+     * block, which is SIZE_MAX before the first block is loaded. */
+    size_t block;
+    secp256k1_scalar a[VERIFY_BATCH_BLOCK];
+    secp256k1_ge r[VERIFY_BATCH_BLOCK];
+    int r_valid[VERIFY_BATCH_BLOCK];
+    secp256k1_scalar ae[VERIFY_BATCH_BLOCK];
+    secp256k1_ge p[VERIFY_BATCH_BLOCK];
+    int p_valid[VERIFY_BATCH_BLOCK];
+} secp256k1_schnorrsig_verify_batch_ecmult_data;
+
+/* Messages up to this length have their challenges computed together with the
+ * multi-buffer SHA-256. Longer messages are hashed one by one. */
+#define SCHNORRSIG_VERIFY_BATCH_MAX_MSGLEN 64
+
+/* Computes the randomizers, nonce points, public keys and challenges of the
+ * block of signatures which contains the idx-th signature. */
+static void secp256k1_schnorrsig_verify_batch_load_block(secp256k1_schnorrsig_verify_batch_ecmult_data *ecmult_data, size_t idx) {
+    secp256k1_fe rx[VERIFY_BATCH_BLOCK];
+    secp256k1_ge rp[VERIFY_BATCH_BLOCK];
+    /* R is the point with x coordinate rx and even y */
+    int odd[VERIFY_BATCH_BLOCK] = {0};
+    int ok[VERIFY_BATCH_BLOCK];
+    size_t pos[VERIFY_BATCH_BLOCK];
+    unsigned char chal[VERIFY_BATCH_BLOCK][64 + SCHNORRSIG_VERIFY_BATCH_MAX_MSGLEN];
+    const unsigned char *chal_ptr[VERIFY_BATCH_BLOCK] = {NULL};
+    size_t chal_len[VERIFY_BATCH_BLOCK] = {0};
+    unsigned char e32[VERIFY_BATCH_BLOCK * 32];
+    secp256k1_sha256 sha;
+    secp256k1_scalar e;
+    size_t start = idx - idx % VERIFY_BATCH_BLOCK;
+    size_t n = ecmult_data->n_sigs - start < VERIFY_BATCH_BLOCK ? ecmult_data->n_sigs - start : VERIFY_BATCH_BLOCK;
+    size_t j, n_points = 0, n_chal = 0;
+
+    secp256k1_verify_batch_randomizers(ecmult_data->a, ecmult_data->seed, start, n);
+
+    /* tagged hash(r.x, pk.x, msg) for all signatures of the block with a
+     * valid public key */
+    for (j = 0; j < n; j++) {
+        size_t i = start + j;
+        unsigned char buf[32];
+        ecmult_data->p_valid[j] = secp256k1_xonly_pubkey_load(ecmult_data->ctx, &ecmult_data->p[j], ecmult_data->pubkey[i]);
+        if (!ecmult_data->p_valid[j]) {
+            continue;
+        }
+        secp256k1_fe_get_b32(buf, &ecmult_data->p[j].x);
+        if (ecmult_data->msglen[i] > SCHNORRSIG_VERIFY_BATCH_MAX_MSGLEN) {
+            secp256k1_schnorrsig_challenge(&e, &ecmult_data->sig64[i][0], ecmult_data->msg[i], ecmult_data->msglen[i], buf);
+            secp256k1_scalar_mul(&ecmult_data->ae[j], &ecmult_data->a[j], &e);
+            continue;
+        }
+        memcpy(&chal[n_chal][0], &ecmult_data->sig64[i][0], 32);
+        memcpy(&chal[n_chal][32], buf, 32);
+        if (ecmult_data->msglen[i] > 0) {
+            memcpy(&chal[n_chal][64], ecmult_data->msg[i], ecmult_data->msglen[i]);
+        }
+        chal_ptr[n_chal] = chal[n_chal];
+        chal_len[n_chal] = 64 + ecmult_data->msglen[i];
+        pos[n_chal] = j;
+        n_chal++;
+    }
+    secp256k1_schnorrsig_sha256_tagged(&sha);
+    secp256k1_sha256_batch(&sha, e32, chal_ptr, chal_len, n_chal);
+    for (j = 0; j < n_chal; j++) {
+        /* Set scalar e to the challenge hash modulo the curve order as per
+         * BIP340. */
+        secp256k1_scalar_set_b32(&e, &e32[32 * j], NULL);
+        secp256k1_scalar_mul(&ecmult_data->ae[pos[j]], &ecmult_data->a[pos[j]], &e);
+    }
+
+    for (j = 0; j < n; j++) {
+        ecmult_data->r_valid[j] = 0;
+        if (secp256k1_fe_set_b32(&rx[n_points], &ecmult_data->sig64[start + j][0])) {
+            pos[n_points] = j;
+            n_points++;
+        }
+    }
+    secp256k1_ge_set_xo_batch_var(rp, ok, rx, odd, n_points);
+    for (j = 0; j < n_points; j++) {
+        ecmult_data->r[pos[j]] = rp[j];
+        ecmult_data->r_valid[pos[j]] = ok[j];
+    }
+    ecmult_data->block = start;
+}
+
+/* Callback function which is called by ecmult_multi in order to convert the
+ * signature, message and public key tuples into scalars and points. Every
+ * signature i corresponds to two (scalar, point) tuples:
+ * (a_i, R_i) at index 2*i and (a_i*e_i, P_i) at index 2*i + 1. */
+static int secp256k1_schnorrsig_verify_batch_ecmult_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    secp256k1_schnorrsig_verify_batch_ecmult_data *ecmult_data = (secp256k1_schnorrsig_verify_batch_ecmult_data *) data;
+    size_t i = idx / 2;
+
+    if (ecmult_data->block == SIZE_MAX || i - ecmult_data->block >= VERIFY_BATCH_BLOCK) {
+        secp256k1_schnorrsig_verify_batch_load_block(ecmult_data, i);
+    }
+    if (idx % 2 == 0) {
+        if (!ecmult_data->r_valid[i - ecmult_data->block]) {
+            return 0;
+        }
+        *sc = ecmult_data->a[i - ecmult_data->block];
+        *pt = ecmult_data->r[i - ecmult_data->block];
+    } else {
+        if (!ecmult_data->p_valid[i - ecmult_data->block]) {
+            return 0;
+        }
+        *sc = ecmult_data->ae[i - ecmult_data->block];
+        *pt = ecmult_data->p[i - ecmult_data->block];
+    }
+    return 1;
+}
+
+int secp256k1_schnorrsig_verify_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, const unsigned char *const *sig64, const unsigned char *const *msg, const size_t *msglen, const secp256k1_xonly_pubkey *const *pubkey, size_t n_sigs) {
+    secp256k1_schnorrsig_verify_batch_ecmult_data ecmult_data;
+    secp256k1_sha256 sha;
+    secp256k1_scalar s;
+    secp256k1_gej rj;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(scratch != NULL);
+    /* The number of points given to ecmult_multi is 2*n_sigs. Also limit
+     * n_sigs to 2^31 to ensure the same behavior on 32-bit and 64-bit
+     * platforms. */
+    ARG_CHECK(n_sigs <= SIZE_MAX / 2);
+    ARG_CHECK(n_sigs < ((size_t)1 << 31));
+    if (n_sigs > 0) {
+        ARG_CHECK(sig64 != NULL);
+        ARG_CHECK(msg != NULL);
+        ARG_CHECK(msglen != NULL);
+        ARG_CHECK(pubkey != NULL);
+    }
+
+    /* Seed the randomizers with all inputs, such that an attacker can not
+     * choose invalid signatures which cancel each other out. */
+    secp256k1_sha256_initialize_tagged(&sha, schnorrsig_batch_tag, sizeof(schnorrsig_batch_tag));
+    for (i = 0; i < n_sigs; i++) {
+        unsigned char buf[32];
+        uint64_t len64;
+        int j;
+        ARG_CHECK(sig64[i] != NULL);
+        ARG_CHECK(msg[i] != NULL || msglen[i] == 0);
+        ARG_CHECK(pubkey[i] != NULL);
+
+        if (!secp256k1_xonly_pubkey_serialize(ctx, buf, pubkey[i])) {
+            return 0;
+        }
+        secp256k1_sha256_write(&sha, sig64[i], 64);
+        secp256k1_sha256_write(&sha, buf, 32);
+        len64 = msglen[i];
+        for (j = 0; j < 8; j++) {
+            buf[j] = (len64 >> (56 - 8*j)) & 0xFF;
+        }
+        secp256k1_sha256_write(&sha, buf, 8);
+        secp256k1_sha256_write(&sha, msg[i], msglen[i]);
+    }
+    secp256k1_sha256_finalize(&sha, ecmult_data.seed);
+    ecmult_data.ctx = ctx;
+    ecmult_data.sig64 = sig64;
+    ecmult_data.msg = msg;
+    ecmult_data.msglen = msglen;
+    ecmult_data.pubkey = pubkey;
+    ecmult_data.n_sigs = n_sigs;
+    ecmult_data.block = SIZE_MAX;
+
+    /* Compute s = -(a_0*s_0 + a_1*s_1 + ...) */
+    secp256k1_scalar_clear(&s);
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_scalar term;
+        int overflow;
+        secp256k1_scalar_set_b32(&term, &sig64[i][32], &overflow);
+        if (overflow) {
+            return 0;
+        }
+        if (i % VERIFY_BATCH_BLOCK == 0) {
+            secp256k1_verify_batch_randomizers(ecmult_data.a, ecmult_data.seed, i, n_sigs - i < VERIFY_BATCH_BLOCK ? n_sigs - i : VERIFY_BATCH_BLOCK);
+        }
+        secp256k1_scalar_mul(&term, &term, &ecmult_data.a[i % VERIFY_BATCH_BLOCK]);
+        secp256k1_scalar_add(&s, &s, &term);
+    }
+    secp256k1_scalar_negate(&s, &s);
+
+    /* Check that s*G + a_0*R_0 + (a_0*e_0)*P_0 + a_1*R_1 + (a_1*e_1)*P_1 + ...
+     * is the point at infinity. */
+    return secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &rj, &s, secp256k1_schnorrsig_verify_batch_ecmult_callback, (void *) &ecmult_data, 2 * n_sigs)
+            && secp256k1_gej_is_infinity(&rj);
+}
+
 #endif
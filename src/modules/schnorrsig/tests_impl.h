@@ -135,6 +135,11 @@ void test_schnorrsig_api(void) {
     unsigned char sig[64];
     secp256k1_schnorrsig_extraparams extraparams = SECP256K1_SCHNORRSIG_EXTRAPARAMS_INIT;
     secp256k1_schnorrsig_extraparams invalid_extraparams = {{ 0 }, NULL, NULL};
+    const unsigned char *sig_ptr[1];
+    const unsigned char *msg_ptr[1];
+    size_t msglen[1];
+    const secp256k1_xonly_pubkey *pk_ptr[1];
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 2000);
 
     /** setup **/
     secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
@@ -222,6 +227,44 @@ void test_schnorrsig_api(void) {
     CHECK(secp256k1_schnorrsig_verify(vrfy, sig, msg, sizeof(msg), &zero_pk) == 0);
     CHECK(ecount == 4);
 
+    ecount = 0;
+    sig_ptr[0] = sig;
+    msg_ptr[0] = msg;
+    msglen[0] = sizeof(msg);
+    pk_ptr[0] = &pk[0];
+    CHECK(secp256k1_schnorrsig_verify_batch(none, scratch, sig_ptr, msg_ptr, msglen, pk_ptr, 1) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, sig_ptr, msg_ptr, msglen, pk_ptr, 1) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, NULL, sig_ptr, msg_ptr, msglen, pk_ptr, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, NULL, msg_ptr, msglen, pk_ptr, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, sig_ptr, NULL, msglen, pk_ptr, 1) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, sig_ptr, msg_ptr, NULL, pk_ptr, 1) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, sig_ptr, msg_ptr, msglen, NULL, 1) == 0);
+    CHECK(ecount == 5);
+    msg_ptr[0] = NULL;
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, sig_ptr, msg_ptr, msglen, pk_ptr, 1) == 0);
+    CHECK(ecount == 6);
+    msglen[0] = 0;
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, sig_ptr, msg_ptr, msglen, pk_ptr, 1) == 0);
+    CHECK(ecount == 6);
+    msg_ptr[0] = msg;
+    msglen[0] = sizeof(msg);
+    pk_ptr[0] = &zero_pk;
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, sig_ptr, msg_ptr, msglen, pk_ptr, 1) == 0);
+    CHECK(ecount == 7);
+    pk_ptr[0] = &pk[0];
+    CHECK(secp256k1_schnorrsig_verify_batch(vrfy, scratch, sig_ptr, msg_ptr, msglen, pk_ptr, (size_t)1 << 31) == 0);
+    CHECK(ecount == 8);
+
+    secp256k1_scratch_space_destroy(ctx, scratch);
+
     secp256k1_context_destroy(none);
     secp256k1_context_destroy(sign);
     secp256k1_context_destroy(vrfy);
@@ -258,12 +301,24 @@ void test_schnorrsig_bip_vectors_check_signing(const unsigned char *sk, const un
 }
 
 /* Helper function for schnorrsig_bip_vectors
- * Checks that both verify and verify_batch (TODO) return the same value as expected. */
+ * Checks that both verify and verify_batch return the same value as expected. */
 void test_schnorrsig_bip_vectors_check_verify(const unsigned char *pk_serialized, const unsigned char *msg32, const unsigned char *sig, int expected) {
     secp256k1_xonly_pubkey pk;
+    const secp256k1_xonly_pubkey *pk_arr[1];
+    const unsigned char *msg_arr[1];
+    const unsigned char *sig_arr[1];
+    size_t msglen_arr[1];
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 2000);
 
     CHECK(secp256k1_xonly_pubkey_parse(ctx, &pk, pk_serialized));
     CHECK(expected == secp256k1_schnorrsig_verify(ctx, sig, msg32, 32, &pk));
+
+    pk_arr[0] = &pk;
+    msg_arr[0] = msg32;
+    sig_arr[0] = sig;
+    msglen_arr[0] = 32;
+    CHECK(expected == secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, 1));
+    secp256k1_scratch_space_destroy(ctx, scratch);
 }
 
 /* Test vectors according to BIP-340 ("Schnorr Signatures for secp256k1"). See
@@ -769,18 +824,85 @@ void test_schnorrsig_sign(void) {
     CHECK(secp256k1_memcmp_var(sig, sig2, sizeof(sig)) == 0);
 }
 
+#define N_BATCH_SIGS 40
+void test_schnorrsig_sign_batch(void) {
+    unsigned char sk[32];
+    secp256k1_xonly_pubkey pk;
+    secp256k1_keypair keypair;
+    unsigned char msgs[N_BATCH_SIGS][32];
+    const unsigned char *msg_ptr[N_BATCH_SIGS];
+    unsigned char aux_rand[N_BATCH_SIGS][32];
+    unsigned char *aux_ptr[N_BATCH_SIGS];
+    unsigned char sigs[N_BATCH_SIGS * 64];
+    unsigned char sig[64];
+    unsigned char zeros64[64] = { 0 };
+    size_t n = secp256k1_testrand_int(N_BATCH_SIGS + 1);
+    size_t i;
+    int ecount = 0;
+
+    secp256k1_testrand256(sk);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk));
+    CHECK(secp256k1_keypair_xonly_pub(ctx, &pk, NULL, &keypair));
+    for (i = 0; i < n; i++) {
+        secp256k1_testrand256(msgs[i]);
+        secp256k1_testrand256(aux_rand[i]);
+        msg_ptr[i] = msgs[i];
+        aux_ptr[i] = secp256k1_testrand_bits(1) ? aux_rand[i] : NULL;
+    }
+
+    /* Batch signing creates the same signatures as signing individually */
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sigs, msg_ptr, n, &keypair, aux_ptr) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_schnorrsig_sign(ctx, sig, msgs[i], &keypair, aux_ptr[i]) == 1);
+        CHECK(secp256k1_memcmp_var(sig, &sigs[64 * i], sizeof(sig)) == 0);
+        CHECK(secp256k1_schnorrsig_verify(ctx, &sigs[64 * i], msgs[i], 32, &pk));
+    }
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sigs, msg_ptr, n, &keypair, NULL) == 1);
+    for (i = 0; i < n; i++) {
+        CHECK(secp256k1_schnorrsig_sign(ctx, sig, msgs[i], &keypair, NULL) == 1);
+        CHECK(secp256k1_memcmp_var(sig, &sigs[64 * i], sizeof(sig)) == 0);
+    }
+
+    /* Illegal arguments */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, NULL, NULL, 0, &keypair, NULL) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, NULL, msg_ptr, 1, &keypair, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sigs, NULL, 1, &keypair, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sigs, msg_ptr, 0, NULL, NULL) == 0);
+    CHECK(ecount == 3);
+    memset(&keypair, 0, sizeof(keypair));
+    memset(sigs, 1, 64);
+    msg_ptr[0] = msgs[0];
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sigs, msg_ptr, 1, &keypair, NULL) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_memcmp_var(sigs, zeros64, sizeof(zeros64)) == 0);
+    msg_ptr[0] = NULL;
+    CHECK(secp256k1_schnorrsig_sign_batch(ctx, sigs, msg_ptr, 1, &keypair, NULL) == 0);
+    CHECK(ecount == 5);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+#undef N_BATCH_SIGS
+
 #define N_SIGS 3
 /* Creates N_SIGS valid signatures and verifies them with verify and
- * verify_batch (TODO). Then flips some bits and checks that verification now
+ * verify_batch. Then flips some bits and checks that verification now
  * fails. */
 void test_schnorrsig_sign_verify(void) {
     unsigned char sk[32];
     unsigned char msg[N_SIGS][32];
     unsigned char sig[N_SIGS][64];
+    const unsigned char *sig_arr[N_SIGS];
+    const unsigned char *msg_arr[N_SIGS];
+    size_t msglen_arr[N_SIGS];
+    const secp256k1_xonly_pubkey *pk_arr[N_SIGS];
     size_t i;
     secp256k1_keypair keypair;
     secp256k1_xonly_pubkey pk;
     secp256k1_scalar s;
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 1024 * 16);
 
     secp256k1_testrand256(sk);
     CHECK(secp256k1_keypair_create(ctx, &keypair, sk));
@@ -790,30 +912,58 @@ void test_schnorrsig_sign_verify(void) {
         secp256k1_testrand256(msg[i]);
         CHECK(secp256k1_schnorrsig_sign(ctx, sig[i], msg[i], &keypair, NULL));
         CHECK(secp256k1_schnorrsig_verify(ctx, sig[i], msg[i], sizeof(msg[i]), &pk));
+        sig_arr[i] = sig[i];
+        msg_arr[i] = msg[i];
+        msglen_arr[i] = sizeof(msg[i]);
+        pk_arr[i] = &pk;
     }
+    CHECK(secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, N_SIGS));
 
     {
         /* Flip a few bits in the signature and in the message and check that
-         * verify and verify_batch (TODO) fail */
+         * verify and verify_batch fail */
         size_t sig_idx = secp256k1_testrand_int(N_SIGS);
         size_t byte_idx = secp256k1_testrand_int(32);
         unsigned char xorbyte = secp256k1_testrand_int(254)+1;
         sig[sig_idx][byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(ctx, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, N_SIGS));
         sig[sig_idx][byte_idx] ^= xorbyte;
 
         byte_idx = secp256k1_testrand_int(32);
         sig[sig_idx][32+byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(ctx, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, N_SIGS));
         sig[sig_idx][32+byte_idx] ^= xorbyte;
 
         byte_idx = secp256k1_testrand_int(32);
         msg[sig_idx][byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(ctx, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, N_SIGS));
         msg[sig_idx][byte_idx] ^= xorbyte;
 
         /* Check that above bitflips have been reversed correctly */
         CHECK(secp256k1_schnorrsig_verify(ctx, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, N_SIGS));
+    }
+
+    {
+        /* Two invalid signatures whose errors cancel out in the plain sum of
+         * the verification equations must not pass batch verification. */
+        secp256k1_scalar t;
+        CHECK(N_SIGS >= 2);
+        secp256k1_scalar_set_int(&t, 1);
+        secp256k1_scalar_set_b32(&s, &sig[0][32], NULL);
+        secp256k1_scalar_add(&s, &s, &t);
+        secp256k1_scalar_get_b32(&sig[0][32], &s);
+        secp256k1_scalar_set_b32(&s, &sig[1][32], NULL);
+        secp256k1_scalar_negate(&t, &t);
+        secp256k1_scalar_add(&s, &s, &t);
+        secp256k1_scalar_get_b32(&sig[1][32], &s);
+        CHECK(!secp256k1_schnorrsig_verify(ctx, sig[0], msg[0], sizeof(msg[0]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify(ctx, sig[1], msg[1], sizeof(msg[1]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, N_SIGS));
+        CHECK(secp256k1_schnorrsig_verify_batch(ctx, scratch, &sig_arr[2], &msg_arr[2], &msglen_arr[2], &pk_arr[2], N_SIGS - 2));
     }
 
     /* Test overflowing s */
@@ -847,6 +997,62 @@ void test_schnorrsig_sign_verify(void) {
         msglen = (msglen + (sizeof(msg_large) - 1)) % sizeof(msg_large);
         CHECK(secp256k1_schnorrsig_verify(ctx, sig[0], msg_large, msglen, &pk) == 0);
     }
+    secp256k1_scratch_space_destroy(ctx, scratch);
+}
+#undef N_SIGS
+
+/* Batch verifies a random number of signatures of varying message lengths
+ * under different keys, such that both the Strauss and the Pippenger
+ * algorithm are exercised. */
+#define N_SIGS 64
+void test_schnorrsig_verify_batch(void) {
+    /* Messages both shorter and longer than the ones whose challenges are
+     * hashed together */
+    unsigned char msg[N_SIGS][2 * SCHNORRSIG_VERIFY_BATCH_MAX_MSGLEN];
+    unsigned char sig[N_SIGS][64];
+    secp256k1_xonly_pubkey pk[N_SIGS];
+    const unsigned char *sig_arr[N_SIGS];
+    const unsigned char *msg_arr[N_SIGS];
+    size_t msglen_arr[N_SIGS];
+    const secp256k1_xonly_pubkey *pk_arr[N_SIGS];
+    size_t n_sigs = 1 + secp256k1_testrand_int(N_SIGS);
+    size_t i;
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 1024 * 256);
+    secp256k1_scratch_space *scratch_small;
+
+    for (i = 0; i < n_sigs; i++) {
+        unsigned char sk[32];
+        secp256k1_keypair keypair;
+        secp256k1_testrand256(sk);
+        secp256k1_testrand_bytes_test(msg[i], sizeof(msg[i]));
+        msglen_arr[i] = secp256k1_testrand_int(sizeof(msg[i]) + 1);
+        CHECK(secp256k1_keypair_create(ctx, &keypair, sk));
+        CHECK(secp256k1_keypair_xonly_pub(ctx, &pk[i], NULL, &keypair));
+        CHECK(secp256k1_schnorrsig_sign_custom(ctx, sig[i], msg[i], msglen_arr[i], &keypair, NULL));
+        sig_arr[i] = sig[i];
+        msg_arr[i] = msg[i];
+        pk_arr[i] = &pk[i];
+    }
+    CHECK(secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, n_sigs));
+    /* Verification without enough scratch space for Pippenger or Strauss
+     * falls back to individual multiplications. */
+    scratch_small = secp256k1_scratch_space_create(ctx, 0);
+    CHECK(secp256k1_schnorrsig_verify_batch(ctx, scratch_small, sig_arr, msg_arr, msglen_arr, pk_arr, n_sigs));
+    secp256k1_scratch_space_destroy(ctx, scratch_small);
+
+    {
+        /* A wrong message length makes the batch fail */
+        size_t sig_idx = secp256k1_testrand_int(n_sigs);
+        msglen_arr[sig_idx] = (msglen_arr[sig_idx] + 1) % (sizeof(msg[sig_idx]) + 1);
+        CHECK(!secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, n_sigs));
+        msglen_arr[sig_idx] = (msglen_arr[sig_idx] + sizeof(msg[sig_idx])) % (sizeof(msg[sig_idx]) + 1);
+        CHECK(secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, n_sigs));
+
+        /* So does an R whose x coordinate is not on the curve or overflows */
+        memset(sig[sig_idx], 0xFF, 32);
+        CHECK(!secp256k1_schnorrsig_verify_batch(ctx, scratch, sig_arr, msg_arr, msglen_arr, pk_arr, n_sigs));
+    }
+    secp256k1_scratch_space_destroy(ctx, scratch);
 }
 #undef N_SIGS
 
@@ -886,6 +1092,56 @@ void test_schnorrsig_taproot(void) {
     CHECK(secp256k1_xonly_pubkey_tweak_add_check(ctx, output_pk_bytes, pk_parity, &internal_pk, tweak) == 1);
 }
 
+/* Checks that verify_precomp agrees with verify for a public key and its
+ * negation, which share the same x-only public key. */
+void test_schnorrsig_verify_precomp(void) {
+    unsigned char sk[32];
+    unsigned char msg[32];
+    unsigned char sig[64];
+    secp256k1_keypair keypair;
+    secp256k1_xonly_pubkey pk;
+    secp256k1_pubkey pubkey;
+    secp256k1_pubkey_precomp *precomp;
+    int window = 2 + secp256k1_testrand_int(11);
+    int ecount = 0;
+    int i;
+
+    secp256k1_testrand256(sk);
+    secp256k1_testrand256(msg);
+    CHECK(secp256k1_keypair_create(ctx, &keypair, sk));
+    CHECK(secp256k1_keypair_xonly_pub(ctx, &pk, NULL, &keypair));
+    CHECK(secp256k1_keypair_pub(ctx, &pubkey, &keypair));
+    CHECK(secp256k1_schnorrsig_sign(ctx, sig, msg, &keypair, NULL));
+
+    for (i = 0; i < 2; i++) {
+        size_t byte_idx = secp256k1_testrand_int(64);
+        unsigned char xorbyte = secp256k1_testrand_int(254)+1;
+        precomp = secp256k1_pubkey_precomp_create(ctx, &pubkey, window);
+        CHECK(precomp != NULL);
+        CHECK(secp256k1_schnorrsig_verify_precomp(ctx, sig, msg, sizeof(msg), precomp));
+        sig[byte_idx] ^= xorbyte;
+        CHECK(!secp256k1_schnorrsig_verify_precomp(ctx, sig, msg, sizeof(msg), precomp));
+        CHECK(!secp256k1_schnorrsig_verify(ctx, sig, msg, sizeof(msg), &pk));
+        sig[byte_idx] ^= xorbyte;
+        msg[byte_idx % 32] ^= xorbyte;
+        CHECK(!secp256k1_schnorrsig_verify_precomp(ctx, sig, msg, sizeof(msg), precomp));
+        msg[byte_idx % 32] ^= xorbyte;
+
+        secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+        CHECK(!secp256k1_schnorrsig_verify_precomp(ctx, NULL, msg, sizeof(msg), precomp));
+        CHECK(ecount == 1);
+        CHECK(!secp256k1_schnorrsig_verify_precomp(ctx, sig, NULL, sizeof(msg), precomp));
+        CHECK(ecount == 2);
+        CHECK(!secp256k1_schnorrsig_verify_precomp(ctx, sig, msg, sizeof(msg), NULL));
+        CHECK(ecount == 3);
+        secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+        ecount = 0;
+
+        secp256k1_pubkey_precomp_destroy(ctx, precomp);
+        CHECK(secp256k1_ec_pubkey_negate(ctx, &pubkey));
+    }
+}
+
 void run_schnorrsig_tests(void) {
     int i;
     run_nonce_function_bip340_tests();
@@ -895,7 +1151,10 @@ void run_schnorrsig_tests(void) {
     test_schnorrsig_bip_vectors();
     for (i = 0; i < count; i++) {
         test_schnorrsig_sign();
+        test_schnorrsig_sign_batch();
         test_schnorrsig_sign_verify();
+        test_schnorrsig_verify_batch();
+        test_schnorrsig_verify_precomp();
     }
     test_schnorrsig_taproot();
 }
@@ -80,6 +80,13 @@ static void secp256k1_scalar_inverse(secp256k1_scalar *r, const secp256k1_scalar
 /** Compute the inverse of a scalar (modulo the group order), without constant-time guarantee. */
 static void secp256k1_scalar_inverse_var(secp256k1_scalar *r, const secp256k1_scalar *a);
 
+/** Set r[i] to the inverse of a[i] for i < len, or to zero if a[i] is zero, using a single
+ *  inversion and 3 multiplications per element. r and a must not overlap. */
+static void secp256k1_scalar_inverse_all(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len);
+
+/** Same as secp256k1_scalar_inverse_all, without constant-time guarantee. */
+static void secp256k1_scalar_inverse_all_var(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len);
+
 /** Compute the complement of a scalar (modulo the group order). */
 static void secp256k1_scalar_negate(secp256k1_scalar *r, const secp256k1_scalar *a);
 
@@ -49,6 +49,79 @@ static int secp256k1_scalar_set_b32_seckey(secp256k1_scalar *r, const unsigned c
     return (!overflow) & (!secp256k1_scalar_is_zero(r));
 }
 
+static void secp256k1_scalar_inverse_all(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len) {
+    secp256k1_scalar u, t;
+    size_t i;
+    int zero;
+
+    VERIFY_CHECK(r != a || len == 0);
+    if (len == 0) {
+        return;
+    }
+    /* Compute the prefix products r[i] = a[0]*...*a[i] with zero inputs
+     * replaced by one, so that their product can be inverted. */
+    for (i = 0; i < len; i++) {
+        t = a[i];
+        secp256k1_scalar_cmov(&t, &secp256k1_scalar_one, secp256k1_scalar_is_zero(&t));
+        if (i == 0) {
+            r[0] = t;
+        } else {
+            secp256k1_scalar_mul(&r[i], &r[i - 1], &t);
+        }
+    }
+    secp256k1_scalar_inverse(&u, &r[len - 1]);
+
+    /* u = 1/(a[0]*...*a[i]) at the start of every iteration. */
+    for (i = len - 1; i > 0; i--) {
+        t = a[i];
+        zero = secp256k1_scalar_is_zero(&t);
+        secp256k1_scalar_cmov(&t, &secp256k1_scalar_one, zero);
+        secp256k1_scalar_mul(&r[i], &r[i - 1], &u);
+        secp256k1_scalar_mul(&u, &u, &t);
+        secp256k1_scalar_cmov(&r[i], &secp256k1_scalar_zero, zero);
+    }
+    secp256k1_scalar_cmov(&u, &secp256k1_scalar_zero, secp256k1_scalar_is_zero(&a[0]));
+    r[0] = u;
+    secp256k1_scalar_clear(&u);
+    secp256k1_scalar_clear(&t);
+}
+
+static void secp256k1_scalar_inverse_all_var(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len) {
+    secp256k1_scalar u;
+    size_t i;
+    size_t last_i = SIZE_MAX;
+
+    VERIFY_CHECK(r != a || len == 0);
+    /* Compute the prefix products of the nonzero inputs. */
+    for (i = 0; i < len; i++) {
+        if (secp256k1_scalar_is_zero(&a[i])) {
+            r[i] = secp256k1_scalar_zero;
+        } else {
+            if (last_i == SIZE_MAX) {
+                r[i] = a[i];
+            } else {
+                secp256k1_scalar_mul(&r[i], &r[last_i], &a[i]);
+            }
+            last_i = i;
+        }
+    }
+    if (last_i == SIZE_MAX) {
+        return;
+    }
+    secp256k1_scalar_inverse_var(&u, &r[last_i]);
+
+    i = last_i;
+    while (i > 0) {
+        i--;
+        if (!secp256k1_scalar_is_zero(&a[i])) {
+            secp256k1_scalar_mul(&r[last_i], &r[i], &u);
+            secp256k1_scalar_mul(&u, &u, &a[last_i]);
+            last_i = i;
+        }
+    }
+    r[last_i] = u;
+}
+
 /* These parameters are generated using sage/gen_exhaustive_groups.sage. */
 #if defined(EXHAUSTIVE_TEST_ORDER)
 #  if EXHAUSTIVE_TEST_ORDER == 13
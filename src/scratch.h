@@ -51,4 +51,10 @@ static size_t secp256k1_scratch_max_allocation(const secp256k1_callback* error_c
 /** Returns a pointer into the most recently allocated frame, or NULL if there is insufficient available space */
 static void *secp256k1_scratch_alloc(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, size_t n);
 
+/** Allocates n bytes from scratch and initializes child as a scratch space
+ *  which is backed by this allocation. The child must not be destroyed; it
+ *  becomes invalid when the allocation is undone by applying a checkpoint to
+ *  scratch. Returns 0 if there is insufficient available space. */
+static int secp256k1_scratch_alloc_child(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, secp256k1_scratch* child, size_t n);
+
 #endif
@@ -85,13 +85,21 @@ static const secp256k1_callback default_error_callback = {
 };
 
 struct secp256k1_context_struct {
+    secp256k1_ecmult_context ecmult_ctx;
     secp256k1_ecmult_gen_context ecmult_gen_ctx;
     secp256k1_callback illegal_callback;
     secp256k1_callback error_callback;
     int declassify;
 };
 
+struct secp256k1_pubkey_precomp_struct {
+    secp256k1_pubkey pubkey;
+    int window;
+    secp256k1_ge_storage *pre;
+};
+
 static const secp256k1_context secp256k1_context_no_precomp_ = {
+    { WINDOW_G, 0, secp256k1_pre_g, secp256k1_pre_g_128, ECMULT_MULTI_PROFILE_DEFAULT },
     { 0 },
     { secp256k1_default_illegal_callback_fn, 0 },
     { secp256k1_default_error_callback_fn, 0 },
@@ -100,6 +108,10 @@ static const secp256k1_context secp256k1_context_no_precomp_ = {
 const secp256k1_context *secp256k1_context_no_precomp = &secp256k1_context_no_precomp_;
 
 size_t secp256k1_context_preallocated_size(unsigned int flags) {
+    return secp256k1_context_preallocated_size_ecmult_window(flags, WINDOW_G);
+}
+
+size_t secp256k1_context_preallocated_size_ecmult_window(unsigned int flags, int window) {
     size_t ret = ROUND_TO_ALIGN(sizeof(secp256k1_context));
     /* A return value of 0 is reserved as an indicator for errors when we call this function internally. */
     VERIFY_CHECK(ret != 0);
@@ -110,9 +122,16 @@ size_t secp256k1_context_preallocated_size(unsigned int flags) {
             return 0;
     }
 
+    if (EXPECT(window < SECP256K1_ECMULT_WINDOW_MIN || window > SECP256K1_ECMULT_WINDOW_MAX, 0)) {
+            secp256k1_callback_call(&default_illegal_callback,
+                                    "Invalid ecmult window");
+            return 0;
+    }
+
     if (flags & SECP256K1_FLAGS_BIT_CONTEXT_SIGN) {
         ret += SECP256K1_ECMULT_GEN_CONTEXT_PREALLOCATED_SIZE;
     }
+    ret += secp256k1_ecmult_context_prealloc_size(window);
     return ret;
 }
 
@@ -122,10 +141,17 @@ size_t secp256k1_context_preallocated_clone_size(const secp256k1_context* ctx) {
     if (secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx)) {
         ret += SECP256K1_ECMULT_GEN_CONTEXT_PREALLOCATED_SIZE;
     }
+    if (ctx->ecmult_ctx.built) {
+        ret += secp256k1_ecmult_context_prealloc_size(ctx->ecmult_ctx.window_g);
+    }
     return ret;
 }
 
 secp256k1_context* secp256k1_context_preallocated_create(void* prealloc, unsigned int flags) {
+    return secp256k1_context_preallocated_create_ecmult_window(prealloc, flags, WINDOW_G);
+}
+
+secp256k1_context* secp256k1_context_preallocated_create_ecmult_window(void* prealloc, unsigned int flags, int window) {
     void* const base = prealloc;
     size_t prealloc_size;
     secp256k1_context* ret;
@@ -134,7 +160,7 @@ secp256k1_context* secp256k1_context_preallocated_create(void* prealloc, unsigne
         secp256k1_callback_call(&default_error_callback, "self test failed");
     }
 
-    prealloc_size = secp256k1_context_preallocated_size(flags);
+    prealloc_size = secp256k1_context_preallocated_size_ecmult_window(flags, window);
     if (prealloc_size == 0) {
         return NULL;
     }
@@ -145,20 +171,29 @@ secp256k1_context* secp256k1_context_preallocated_create(void* prealloc, unsigne
 
     secp256k1_ecmult_gen_context_init(&ret->ecmult_gen_ctx);
 
-    /* Flags have been checked by secp256k1_context_preallocated_size. */
+    /* Flags and window have been checked by secp256k1_context_preallocated_size_ecmult_window. */
     VERIFY_CHECK((flags & SECP256K1_FLAGS_TYPE_MASK) == SECP256K1_FLAGS_TYPE_CONTEXT);
     if (flags & SECP256K1_FLAGS_BIT_CONTEXT_SIGN) {
         secp256k1_ecmult_gen_context_build(&ret->ecmult_gen_ctx, &prealloc);
     }
+    secp256k1_ecmult_context_build(&ret->ecmult_ctx, window, &prealloc);
     ret->declassify = !!(flags & SECP256K1_FLAGS_BIT_CONTEXT_DECLASSIFY);
 
     return (secp256k1_context*) ret;
 }
 
 secp256k1_context* secp256k1_context_create(unsigned int flags) {
-    size_t const prealloc_size = secp256k1_context_preallocated_size(flags);
-    secp256k1_context* ctx = (secp256k1_context*)checked_malloc(&default_error_callback, prealloc_size);
-    if (EXPECT(secp256k1_context_preallocated_create(ctx, flags) == NULL, 0)) {
+    return secp256k1_context_create_ecmult_window(flags, WINDOW_G);
+}
+
+secp256k1_context* secp256k1_context_create_ecmult_window(unsigned int flags, int window) {
+    size_t const prealloc_size = secp256k1_context_preallocated_size_ecmult_window(flags, window);
+    secp256k1_context* ctx;
+    if (prealloc_size == 0) {
+        return NULL;
+    }
+    ctx = (secp256k1_context*)checked_malloc(&default_error_callback, prealloc_size);
+    if (EXPECT(secp256k1_context_preallocated_create_ecmult_window(ctx, flags, window) == NULL, 0)) {
         free(ctx);
         return NULL;
     }
@@ -175,6 +210,7 @@ secp256k1_context* secp256k1_context_preallocated_clone(const secp256k1_context*
     prealloc_size = secp256k1_context_preallocated_clone_size(ctx);
     ret = (secp256k1_context*)prealloc;
     memcpy(ret, ctx, prealloc_size);
+    secp256k1_ecmult_context_finalize_memcpy(&ret->ecmult_ctx, &ctx->ecmult_ctx);
     secp256k1_ecmult_gen_context_finalize_memcpy(&ret->ecmult_gen_ctx, &ctx->ecmult_gen_ctx);
     return ret;
 }
@@ -193,6 +229,7 @@ secp256k1_context* secp256k1_context_clone(const secp256k1_context* ctx) {
 void secp256k1_context_preallocated_destroy(secp256k1_context* ctx) {
     ARG_CHECK_NO_RETURN(ctx != secp256k1_context_no_precomp);
     if (ctx != NULL) {
+        secp256k1_ecmult_context_clear(&ctx->ecmult_ctx);
         secp256k1_ecmult_gen_context_clear(&ctx->ecmult_gen_ctx);
     }
 }
@@ -222,6 +259,20 @@ void secp256k1_context_set_error_callback(secp256k1_context* ctx, void (*fun)(co
     ctx->error_callback.data = data;
 }
 
+int secp256k1_context_set_ecmult_tables(secp256k1_context* ctx, const unsigned char *tables, size_t tableslen) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(ctx != secp256k1_context_no_precomp);
+    ARG_CHECK(tables != NULL);
+    return secp256k1_ecmult_context_load(&ctx->ecmult_ctx, tables, tableslen);
+}
+
+int secp256k1_context_set_ecmult_multi_profile(secp256k1_context* ctx, const unsigned char *profile, size_t profilelen) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(ctx != secp256k1_context_no_precomp);
+    ARG_CHECK(profile != NULL);
+    return secp256k1_ecmult_multi_profile_load(&ctx->ecmult_ctx.multi, profile, profilelen);
+}
+
 secp256k1_scratch_space* secp256k1_scratch_space_create(const secp256k1_context* ctx, size_t max_size) {
     VERIFY_CHECK(ctx != NULL);
     return secp256k1_scratch_create(&ctx->error_callback, max_size);
@@ -320,6 +371,100 @@ int secp256k1_ec_pubkey_serialize(const secp256k1_context* ctx, unsigned char *o
     return ret;
 }
 
+/* Number of public keys which are parsed together in
+ * secp256k1_ec_pubkey_parse_batch. */
+#define PUBKEY_PARSE_BATCH_SIZE 16
+
+int secp256k1_ec_pubkey_parse_batch(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, int *valid, const unsigned char * const *inputs, const size_t *inputlens, size_t n) {
+    secp256k1_ge Q[PUBKEY_PARSE_BATCH_SIZE];
+    secp256k1_fe x[PUBKEY_PARSE_BATCH_SIZE];
+    int odd[PUBKEY_PARSE_BATCH_SIZE];
+    int ok[PUBKEY_PARSE_BATCH_SIZE];
+    size_t idx[PUBKEY_PARSE_BATCH_SIZE];
+    size_t i, j, n_batch, n_compressed;
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkeys != NULL || n == 0);
+    if (n > 0) {
+        memset(pubkeys, 0, n * sizeof(*pubkeys));
+    }
+    ARG_CHECK(inputs != NULL || n == 0);
+    ARG_CHECK(inputlens != NULL || n == 0);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(inputs[i] != NULL);
+    }
+
+    for (i = 0; i < n; i += n_batch) {
+        n_batch = n - i < PUBKEY_PARSE_BATCH_SIZE ? n - i : PUBKEY_PARSE_BATCH_SIZE;
+        /* Parse uncompressed keys directly and collect the compressed ones,
+         * whose square roots are computed together. */
+        n_compressed = 0;
+        for (j = 0; j < n_batch; j++) {
+            const unsigned char *input = inputs[i + j];
+            int item_valid;
+            if (inputlens[i + j] == 33 && (input[0] == SECP256K1_TAG_PUBKEY_EVEN || input[0] == SECP256K1_TAG_PUBKEY_ODD)) {
+                if (secp256k1_fe_set_b32(&x[n_compressed], &input[1])) {
+                    odd[n_compressed] = input[0] == SECP256K1_TAG_PUBKEY_ODD;
+                    idx[n_compressed] = i + j;
+                    n_compressed++;
+                    continue;
+                }
+                item_valid = 0;
+            } else {
+                item_valid = secp256k1_eckey_pubkey_parse(&Q[0], input, inputlens[i + j])
+                    && secp256k1_ge_is_in_correct_subgroup(&Q[0]);
+                if (item_valid) {
+                    secp256k1_pubkey_save(&pubkeys[i + j], &Q[0]);
+                }
+            }
+            if (valid != NULL) {
+                valid[i + j] = item_valid;
+            }
+            ret &= item_valid;
+        }
+        secp256k1_ge_set_xo_batch_var(Q, ok, x, odd, n_compressed);
+        for (j = 0; j < n_compressed; j++) {
+            int item_valid = ok[j] && secp256k1_ge_is_in_correct_subgroup(&Q[j]);
+            if (item_valid) {
+                secp256k1_pubkey_save(&pubkeys[idx[j]], &Q[j]);
+            }
+            if (valid != NULL) {
+                valid[idx[j]] = item_valid;
+            }
+            ret &= item_valid;
+        }
+    }
+    return ret;
+}
+
+int secp256k1_ec_pubkey_serialize_batch(const secp256k1_context* ctx, unsigned char *output, size_t *outputlen, const secp256k1_pubkey *pubkeys, size_t n, unsigned int flags) {
+    size_t len, keylen, i;
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(outputlen != NULL);
+    keylen = (flags & SECP256K1_FLAGS_BIT_COMPRESSION) ? 33u : 65u;
+    ARG_CHECK(*outputlen / keylen >= n);
+    len = *outputlen;
+    *outputlen = 0;
+    ARG_CHECK(output != NULL);
+    memset(output, 0, len);
+    ARG_CHECK(pubkeys != NULL || n == 0);
+    ARG_CHECK((flags & SECP256K1_FLAGS_TYPE_MASK) == SECP256K1_FLAGS_TYPE_COMPRESSION);
+
+    for (i = 0; i < n; i++) {
+        secp256k1_ge Q;
+        size_t outlen = keylen;
+        if (!secp256k1_pubkey_load(ctx, &Q, &pubkeys[i])
+            || !secp256k1_eckey_pubkey_serialize(&Q, &output[i * keylen], &outlen, flags & SECP256K1_FLAGS_BIT_COMPRESSION)) {
+            ret = 0;
+        }
+    }
+    *outputlen = n * keylen;
+    return ret;
+}
+
 int secp256k1_ec_pubkey_cmp(const secp256k1_context* ctx, const secp256k1_pubkey* pubkey0, const secp256k1_pubkey* pubkey1) {
     unsigned char out[2][33];
     const secp256k1_pubkey* pk[2];
@@ -464,7 +609,333 @@ int secp256k1_ecdsa_verify(const secp256k1_context* ctx, const secp256k1_ecdsa_s
     secp256k1_ecdsa_signature_load(ctx, &r, &s, sig);
     return (!secp256k1_scalar_is_high(&s) &&
             secp256k1_pubkey_load(ctx, &q, pubkey) &&
-            secp256k1_ecdsa_sig_verify(&r, &s, &q, &m));
+            secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &r, &s, &q, &m));
+}
+
+secp256k1_pubkey_precomp* secp256k1_pubkey_precomp_create(const secp256k1_context* ctx, const secp256k1_pubkey *pubkey, int window) {
+    const size_t base_alloc = ROUND_TO_ALIGN(sizeof(secp256k1_pubkey_precomp));
+    size_t table_size;
+    secp256k1_pubkey_precomp *ret;
+    void *prealloc;
+    secp256k1_ge q;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkey != NULL);
+    ARG_CHECK(window >= 2 && window <= SECP256K1_PUBKEY_PRECOMP_MAX_WINDOW);
+    if (!secp256k1_pubkey_load(ctx, &q, pubkey)) {
+        return NULL;
+    }
+
+    table_size = ECMULT_TABLE_SIZE(window) * sizeof(secp256k1_ge_storage);
+    prealloc = checked_malloc(&ctx->error_callback, base_alloc + table_size);
+    if (prealloc == NULL) {
+        return NULL;
+    }
+    ret = (secp256k1_pubkey_precomp *)manual_alloc(&prealloc, sizeof(secp256k1_pubkey_precomp), prealloc, base_alloc);
+    ret->pubkey = *pubkey;
+    ret->window = window;
+    ret->pre = (secp256k1_ge_storage *)manual_alloc(&prealloc, table_size, ret, base_alloc + table_size);
+    secp256k1_ecmult_precomp_table(ret->pre, &q, window);
+    return ret;
+}
+
+void secp256k1_pubkey_precomp_destroy(const secp256k1_context* ctx, secp256k1_pubkey_precomp *precomp) {
+    VERIFY_CHECK(ctx != NULL);
+    free(precomp);
+}
+
+int secp256k1_ecdsa_verify_precomp(const secp256k1_context* ctx, const secp256k1_ecdsa_signature *sig, const unsigned char *msghash32, const secp256k1_pubkey_precomp *precomp) {
+    secp256k1_scalar r, s;
+    secp256k1_scalar m;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(msghash32 != NULL);
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(precomp != NULL);
+
+    secp256k1_scalar_set_b32(&m, msghash32, NULL);
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, sig);
+    return (!secp256k1_scalar_is_high(&s) &&
+            secp256k1_ecdsa_sig_verify_precomp(&ctx->ecmult_ctx, &r, &s, precomp->pre, precomp->window, &m));
+}
+
+/* Number of consecutive signatures whose randomizers and nonce points batch
+ * verification computes together, with the multi-buffer SHA-256 and the
+ * batched square roots. */
+#define VERIFY_BATCH_BLOCK 16
+
+/* Derives the randomizers for the n signatures starting at index idx of a
+ * batch verification from a 32-byte seed which commits to all signatures of
+ * the batch. The first randomizer is always 1, which saves a scalar
+ * multiplication, while all other randomizers are SHA256(seed || idx) with
+ * idx encoded as 64-bit big endian integer. Because a randomizer only depends
+ * on its index, ecmult callbacks using it do not rely on being called in any
+ * particular order. */
+static void secp256k1_verify_batch_randomizers(secp256k1_scalar *r, const unsigned char *seed32, size_t idx, size_t n) {
+    unsigned char buf[VERIFY_BATCH_BLOCK][40];
+    unsigned char out32[VERIFY_BATCH_BLOCK * 32];
+    const unsigned char *data[VERIFY_BATCH_BLOCK] = {NULL};
+    size_t len[VERIFY_BATCH_BLOCK] = {0};
+    secp256k1_sha256 sha;
+    size_t j;
+    int i;
+
+    VERIFY_CHECK(n <= VERIFY_BATCH_BLOCK);
+    for (j = 0; j < n; j++) {
+        uint64_t idx64 = idx + j;
+        memcpy(buf[j], seed32, 32);
+        for (i = 0; i < 8; i++) {
+            buf[j][32 + i] = (idx64 >> (56 - 8*i)) & 0xFF;
+        }
+        data[j] = buf[j];
+        len[j] = sizeof(buf[j]);
+    }
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_batch(&sha, out32, data, len, n);
+    for (j = 0; j < n; j++) {
+        secp256k1_scalar_set_b32(&r[j], &out32[32 * j], NULL);
+    }
+    if (idx == 0 && n > 0) {
+        secp256k1_scalar_set_int(&r[0], 1);
+    }
+}
+
+/* Tag used to derive the seed of the ECDSA batch verification randomizers. */
+static const unsigned char ecdsa_batch_tag[11] = "ECDSA/batch";
+
+/* Data that is used by the ECDSA batch verification ecmult callback */
+typedef struct {
+    const secp256k1_context *ctx;
+    /* Seed from which the randomizers are derived */
+    unsigned char seed[32];
+    /* Signature, recovery id, public key tuples to verify */
+    const secp256k1_ecdsa_signature *const *sig;
+    const int *recid;
+    const secp256k1_pubkey *const *pubkey;
+    size_t n_sigs;
+    /* Randomizers and nonce points of the VERIFY_BATCH_BLOCK signatures
+     * starting at index block, which is SIZE_MAX before the first block is
+     * loaded. */
+    size_t block;
+    secp256k1_scalar a[VERIFY_BATCH_BLOCK];
+    secp256k1_ge r[VERIFY_BATCH_BLOCK];
+    int r_valid[VERIFY_BATCH_BLOCK];
+} secp256k1_ecdsa_verify_batch_ecmult_data;
+
+/* Returns whether the idx-th signature of a batch has a recovery id and is
+ * therefore included in the batch equation. */
+static int secp256k1_ecdsa_verify_batch_is_batched(const int *recid, size_t idx) {
+    return recid != NULL && recid[idx] >= 0;
+}
+
+/* Computes the seed of the randomizers of a batch verification. The seed
+ * commits to the recovery id of every signature and to the signature, message
+ * and public key of every batched signature. The recovery id selects the
+ * nonce point R among R and -R, so leaving it out would let an attacker pick
+ * the sign of every R_i after learning the randomizers, and find invalid
+ * signatures which cancel each other out. */
+static int secp256k1_ecdsa_verify_batch_seed(const secp256k1_context *ctx, unsigned char *seed32, const secp256k1_ecdsa_signature *const *sig, const int *recid, const unsigned char *const *msghash32, const secp256k1_pubkey *const *pubkey, size_t n_sigs) {
+    secp256k1_sha256 sha;
+    size_t i;
+
+    secp256k1_sha256_initialize_tagged(&sha, ecdsa_batch_tag, sizeof(ecdsa_batch_tag));
+    for (i = 0; i < n_sigs; i++) {
+        unsigned char buf[33];
+        size_t buflen = sizeof(buf);
+        secp256k1_scalar r, s;
+        secp256k1_ge q;
+
+        /* 0xff marks a signature without recovery id */
+        buf[0] = secp256k1_ecdsa_verify_batch_is_batched(recid, i) ? recid[i] : 0xff;
+        secp256k1_sha256_write(&sha, buf, 1);
+        if (!secp256k1_ecdsa_verify_batch_is_batched(recid, i)) {
+            continue;
+        }
+        if (!secp256k1_pubkey_load(ctx, &q, pubkey[i])) {
+            return 0;
+        }
+        secp256k1_ecdsa_signature_load(ctx, &r, &s, sig[i]);
+        secp256k1_scalar_get_b32(buf, &r);
+        secp256k1_sha256_write(&sha, buf, 32);
+        secp256k1_scalar_get_b32(buf, &s);
+        secp256k1_sha256_write(&sha, buf, 32);
+        secp256k1_sha256_write(&sha, msghash32[i], 32);
+        secp256k1_eckey_pubkey_serialize(&q, buf, &buflen, 1);
+        secp256k1_sha256_write(&sha, buf, 33);
+    }
+    secp256k1_sha256_finalize(&sha, seed32);
+    return 1;
+}
+
+/* Computes the randomizers and nonce points of the block of signatures which
+ * contains the idx-th signature. */
+static void secp256k1_ecdsa_verify_batch_load_block(secp256k1_ecdsa_verify_batch_ecmult_data *ecmult_data, size_t idx) {
+    secp256k1_fe rx[VERIFY_BATCH_BLOCK];
+    secp256k1_ge rp[VERIFY_BATCH_BLOCK];
+    int odd[VERIFY_BATCH_BLOCK] = {0};
+    int ok[VERIFY_BATCH_BLOCK];
+    size_t pos[VERIFY_BATCH_BLOCK];
+    size_t start = idx - idx % VERIFY_BATCH_BLOCK;
+    size_t n = ecmult_data->n_sigs - start < VERIFY_BATCH_BLOCK ? ecmult_data->n_sigs - start : VERIFY_BATCH_BLOCK;
+    size_t j, n_points = 0;
+
+    secp256k1_verify_batch_randomizers(ecmult_data->a, ecmult_data->seed, start, n);
+    /* If the recovery id does not yield a point, it does not belong to the
+     * signature. */
+    for (j = 0; j < n; j++) {
+        ecmult_data->r_valid[j] = 0;
+        if (secp256k1_ecdsa_verify_batch_is_batched(ecmult_data->recid, start + j)) {
+            secp256k1_scalar r, s;
+            int recid = ecmult_data->recid[start + j];
+            secp256k1_ecdsa_signature_load(ecmult_data->ctx, &r, &s, ecmult_data->sig[start + j]);
+            if (secp256k1_ecdsa_sig_r_x_var(&rx[n_points], &r, recid)) {
+                odd[n_points] = recid & 1;
+                pos[n_points] = j;
+                n_points++;
+            }
+        }
+    }
+    secp256k1_ge_set_xo_batch_var(rp, ok, rx, odd, n_points);
+    for (j = 0; j < n_points; j++) {
+        ecmult_data->r[pos[j]] = rp[j];
+        ecmult_data->r_valid[pos[j]] = ok[j];
+    }
+    ecmult_data->block = start;
+}
+
+/* Callback function which is called by ecmult_multi in order to convert the
+ * signatures into scalars and points. A signature (r, s) for message m under
+ * public key Q with nonce point R is valid if s*R = m*G + r*Q. Every signature
+ * i corresponds to two (scalar, point) tuples: (a_i*s_i, R_i) at index 2*i and
+ * (-a_i*r_i, Q_i) at index 2*i + 1. Signatures without a recovery id are
+ * skipped by returning zero scalars. */
+static int secp256k1_ecdsa_verify_batch_ecmult_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    secp256k1_ecdsa_verify_batch_ecmult_data *ecmult_data = (secp256k1_ecdsa_verify_batch_ecmult_data *) data;
+    size_t i = idx / 2;
+    secp256k1_scalar r, s;
+
+    if (!secp256k1_ecdsa_verify_batch_is_batched(ecmult_data->recid, i)) {
+        secp256k1_scalar_clear(sc);
+        *pt = secp256k1_ge_const_g;
+        return 1;
+    }
+    if (ecmult_data->block == SIZE_MAX || i - ecmult_data->block >= VERIFY_BATCH_BLOCK) {
+        secp256k1_ecdsa_verify_batch_load_block(ecmult_data, i);
+    }
+    secp256k1_ecdsa_signature_load(ecmult_data->ctx, &r, &s, ecmult_data->sig[i]);
+    if (idx % 2 == 0) {
+        if (!ecmult_data->r_valid[i - ecmult_data->block]) {
+            return 0;
+        }
+        *pt = ecmult_data->r[i - ecmult_data->block];
+        secp256k1_scalar_mul(sc, &ecmult_data->a[i - ecmult_data->block], &s);
+    } else {
+        if (!secp256k1_pubkey_load(ecmult_data->ctx, pt, ecmult_data->pubkey[i])) {
+            return 0;
+        }
+        secp256k1_scalar_mul(sc, &ecmult_data->a[i - ecmult_data->block], &r);
+        secp256k1_scalar_negate(sc, sc);
+    }
+    return 1;
+}
+
+int secp256k1_ecdsa_verify_batch(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, const secp256k1_ecdsa_signature *const *sig, const int *recid, const unsigned char *const *msghash32, const secp256k1_pubkey *const *pubkey, size_t n_sigs) {
+    secp256k1_ecdsa_verify_batch_ecmult_data ecmult_data;
+    secp256k1_scalar g_sc;
+    secp256k1_gej rj;
+    size_t i;
+    int n_batched = 0;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(scratch != NULL);
+    /* The number of points given to ecmult_multi is 2*n_sigs. Also limit
+     * n_sigs to 2^31 to ensure the same behavior on 32-bit and 64-bit
+     * platforms. */
+    ARG_CHECK(n_sigs <= SIZE_MAX / 2);
+    ARG_CHECK(n_sigs < ((size_t)1 << 31));
+    if (n_sigs > 0) {
+        ARG_CHECK(sig != NULL);
+        ARG_CHECK(msghash32 != NULL);
+        ARG_CHECK(pubkey != NULL);
+    }
+
+    /* Verify the signatures without recovery id individually */
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_scalar r, s, m;
+        secp256k1_ge q;
+        ARG_CHECK(sig[i] != NULL);
+        ARG_CHECK(msghash32[i] != NULL);
+        ARG_CHECK(pubkey[i] != NULL);
+        ARG_CHECK(recid == NULL || (recid[i] >= -1 && recid[i] <= 3));
+
+        if (!secp256k1_pubkey_load(ctx, &q, pubkey[i])) {
+            return 0;
+        }
+        secp256k1_ecdsa_signature_load(ctx, &r, &s, sig[i]);
+        if (secp256k1_scalar_is_high(&s)) {
+            return 0;
+        }
+        if (!secp256k1_ecdsa_verify_batch_is_batched(recid, i)) {
+            secp256k1_scalar_set_b32(&m, msghash32[i], NULL);
+            if (!secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &r, &s, &q, &m)) {
+                return 0;
+            }
+        } else {
+            if (secp256k1_scalar_is_zero(&r) || secp256k1_scalar_is_zero(&s)) {
+                return 0;
+            }
+            n_batched++;
+        }
+    }
+    if (n_batched == 0) {
+        return 1;
+    }
+    if (!secp256k1_ecdsa_verify_batch_seed(ctx, ecmult_data.seed, sig, recid, msghash32, pubkey, n_sigs)) {
+        return 0;
+    }
+    ecmult_data.ctx = ctx;
+    ecmult_data.sig = sig;
+    ecmult_data.recid = recid;
+    ecmult_data.pubkey = pubkey;
+    ecmult_data.n_sigs = n_sigs;
+    ecmult_data.block = SIZE_MAX;
+
+    /* Compute g_sc = -(a_0*m_0 + a_1*m_1 + ...) over the batched signatures */
+    secp256k1_scalar_clear(&g_sc);
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_scalar m;
+        if (i % VERIFY_BATCH_BLOCK == 0) {
+            secp256k1_verify_batch_randomizers(ecmult_data.a, ecmult_data.seed, i, n_sigs - i < VERIFY_BATCH_BLOCK ? n_sigs - i : VERIFY_BATCH_BLOCK);
+        }
+        if (secp256k1_ecdsa_verify_batch_is_batched(recid, i)) {
+            secp256k1_scalar_set_b32(&m, msghash32[i], NULL);
+            secp256k1_scalar_mul(&m, &m, &ecmult_data.a[i % VERIFY_BATCH_BLOCK]);
+            secp256k1_scalar_add(&g_sc, &g_sc, &m);
+        }
+    }
+    secp256k1_scalar_negate(&g_sc, &g_sc);
+
+    /* Check that g_sc*G + (a_0*s_0)*R_0 - (a_0*r_0)*Q_0 + ... is the point at
+     * infinity. */
+    if (secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &rj, &g_sc, secp256k1_ecdsa_verify_batch_ecmult_callback, (void *) &ecmult_data, 2 * n_sigs)
+            && secp256k1_gej_is_infinity(&rj)) {
+        return 1;
+    }
+
+    /* The batch equation does not hold. Either a signature is invalid or a
+     * recovery id does not match its signature, which does not make the
+     * signature invalid. Fall back to individual verification to find out. */
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_scalar r, s, m;
+        secp256k1_ge q;
+        if (secp256k1_ecdsa_verify_batch_is_batched(recid, i)) {
+            secp256k1_ecdsa_signature_load(ctx, &r, &s, sig[i]);
+            secp256k1_scalar_set_b32(&m, msghash32[i], NULL);
+            if (!secp256k1_pubkey_load(ctx, &q, pubkey[i]) || !secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &r, &s, &q, &m)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
 }
 
 static SECP256K1_INLINE void buffer_append(unsigned char *buf, unsigned int *offset, const void *data, unsigned int len) {
@@ -505,12 +976,13 @@ static int nonce_function_rfc6979(unsigned char *nonce32, const unsigned char *m
 const secp256k1_nonce_function secp256k1_nonce_function_rfc6979 = nonce_function_rfc6979;
 const secp256k1_nonce_function secp256k1_nonce_function_default = nonce_function_rfc6979;
 
-static int secp256k1_ecdsa_sign_inner(const secp256k1_context* ctx, secp256k1_scalar* r, secp256k1_scalar* s, int* recid, const unsigned char *msg32, const unsigned char *seckey, secp256k1_nonce_function noncefp, const void* noncedata) {
+/* Signs like secp256k1_ecdsa_sign_inner, but starts calling the nonce function
+ * with the given counter. */
+static int secp256k1_ecdsa_sign_inner_from(const secp256k1_context* ctx, secp256k1_scalar* r, secp256k1_scalar* s, int* recid, const unsigned char *msg32, const unsigned char *seckey, secp256k1_nonce_function noncefp, const void* noncedata, unsigned int count) {
     secp256k1_scalar sec, non, msg;
     int ret = 0;
     int is_sec_valid;
     unsigned char nonce32[32];
-    unsigned int count = 0;
     /* Default initialization here is important so we won't pass uninit values to the cmov in the end */
     *r = secp256k1_scalar_zero;
     *s = secp256k1_scalar_zero;
@@ -561,6 +1033,10 @@ static int secp256k1_ecdsa_sign_inner(const secp256k1_context* ctx, secp256k1_sc
     return ret;
 }
 
+static int secp256k1_ecdsa_sign_inner(const secp256k1_context* ctx, secp256k1_scalar* r, secp256k1_scalar* s, int* recid, const unsigned char *msg32, const unsigned char *seckey, secp256k1_nonce_function noncefp, const void* noncedata) {
+    return secp256k1_ecdsa_sign_inner_from(ctx, r, s, recid, msg32, seckey, noncefp, noncedata, 0);
+}
+
 int secp256k1_ecdsa_sign(const secp256k1_context* ctx, secp256k1_ecdsa_signature *signature, const unsigned char *msghash32, const unsigned char *seckey, secp256k1_nonce_function noncefp, const void* noncedata) {
     secp256k1_scalar r, s;
     int ret;
@@ -575,6 +1051,89 @@ int secp256k1_ecdsa_sign(const secp256k1_context* ctx, secp256k1_ecdsa_signature
     return ret;
 }
 
+/* Number of signatures whose nonce points and nonce inverses are computed
+ * together by secp256k1_ecdsa_sign_batch. */
+#define SECP256K1_SIGN_BATCH_CHUNK 16
+
+int secp256k1_ecdsa_sign_batch(const secp256k1_context* ctx, secp256k1_ecdsa_signature *signatures, const unsigned char *const *msghash32, size_t n, const unsigned char *seckey, secp256k1_nonce_function noncefp, const void* noncedata) {
+    secp256k1_gej rj[SECP256K1_SIGN_BATCH_CHUNK];
+    secp256k1_ge rp[SECP256K1_SIGN_BATCH_CHUNK];
+    secp256k1_scalar non[SECP256K1_SIGN_BATCH_CHUNK];
+    secp256k1_scalar inv[SECP256K1_SIGN_BATCH_CHUNK];
+    int nonce_ret[SECP256K1_SIGN_BATCH_CHUNK];
+    int valid[SECP256K1_SIGN_BATCH_CHUNK];
+    secp256k1_scalar sec, msg, r, s;
+    unsigned char nonce32[32];
+    int is_sec_valid;
+    int ret = 1;
+    size_t i, j, k;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(signatures != NULL || n == 0);
+    ARG_CHECK(msghash32 != NULL || n == 0);
+    ARG_CHECK(seckey != NULL);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(msghash32[i] != NULL);
+    }
+    if (noncefp == NULL) {
+        noncefp = secp256k1_nonce_function_default;
+    }
+
+    /* Fail if the secret key is invalid, see secp256k1_ecdsa_sign_inner. */
+    is_sec_valid = secp256k1_scalar_set_b32_seckey(&sec, seckey);
+    secp256k1_scalar_cmov(&sec, &secp256k1_scalar_one, !is_sec_valid);
+    for (i = 0; i < n; i += k) {
+        k = n - i < SECP256K1_SIGN_BATCH_CHUNK ? n - i : SECP256K1_SIGN_BATCH_CHUNK;
+        for (j = 0; j < k; j++) {
+            non[j] = secp256k1_scalar_one;
+            nonce_ret[j] = !!noncefp(nonce32, msghash32[i + j], seckey, NULL, (void*)noncedata, 0);
+            valid[j] = nonce_ret[j];
+            if (valid[j]) {
+                int is_nonce_valid = secp256k1_scalar_set_b32_seckey(&non[j], nonce32);
+                /* As in secp256k1_ecdsa_sign_inner, the validity of the nonce is not secret. */
+                secp256k1_declassify(ctx, &is_nonce_valid, sizeof(is_nonce_valid));
+                valid[j] = is_nonce_valid;
+                secp256k1_scalar_cmov(&non[j], &secp256k1_scalar_one, !is_nonce_valid);
+            }
+            secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &rj[j], &non[j]);
+        }
+        /* None of the nonces is zero, so none of the points is infinity. */
+        secp256k1_ge_set_all_gej(rp, rj, k);
+
+        /* Invert all nonces with a single (constant-time) inversion. */
+        secp256k1_scalar_inverse_all(inv, non, k);
+
+        for (j = 0; j < k; j++) {
+            int ok = 0;
+            if (valid[j]) {
+                secp256k1_scalar_set_b32(&msg, msghash32[i + j], NULL);
+                ok = secp256k1_ecdsa_sig_sign_finish(&r, &s, &rp[j], &sec, &msg, &inv[j], NULL);
+                secp256k1_declassify(ctx, &ok, sizeof(ok));
+            }
+            if (!ok && nonce_ret[j]) {
+                /* The first nonce was unusable. Continue with the next counter
+                 * exactly like a single signature would, so that the nonce
+                 * function sees the same sequence of calls. If the nonce
+                 * function failed, signing fails like a single signature. */
+                ok = secp256k1_ecdsa_sign_inner_from(ctx, &r, &s, NULL, msghash32[i + j], seckey, noncefp, noncedata, 1);
+            }
+            ok &= is_sec_valid;
+            secp256k1_scalar_cmov(&r, &secp256k1_scalar_zero, !ok);
+            secp256k1_scalar_cmov(&s, &secp256k1_scalar_zero, !ok);
+            secp256k1_ecdsa_signature_save(&signatures[i + j], &r, &s);
+            ret &= ok;
+        }
+    }
+    memset(nonce32, 0, 32);
+    memset(non, 0, sizeof(non));
+    memset(inv, 0, sizeof(inv));
+    memset(rj, 0, sizeof(rj));
+    memset(rp, 0, sizeof(rp));
+    secp256k1_scalar_clear(&msg);
+    secp256k1_scalar_clear(&sec);
+    return ret;
+}
+
 int secp256k1_ec_seckey_verify(const secp256k1_context* ctx, const unsigned char *seckey) {
     secp256k1_scalar sec;
     int ret;
@@ -616,6 +1175,130 @@ int secp256k1_ec_pubkey_create(const secp256k1_context* ctx, secp256k1_pubkey *p
     return ret;
 }
 
+/* Number of public keys which share a field inversion in
+ * secp256k1_ec_pubkey_create_batch. */
+#define EC_PUBKEY_CREATE_BATCH_SIZE 32
+
+int secp256k1_ec_pubkey_create_batch(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, const unsigned char * const *seckeys, size_t n) {
+    secp256k1_gej pj[EC_PUBKEY_CREATE_BATCH_SIZE];
+    secp256k1_ge p[EC_PUBKEY_CREATE_BATCH_SIZE];
+    int valid[EC_PUBKEY_CREATE_BATCH_SIZE];
+    secp256k1_scalar seckey_scalar;
+    size_t i, j, n_batch;
+    int ret = 1;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkeys != NULL || n == 0);
+    if (n > 0) {
+        memset(pubkeys, 0, n * sizeof(*pubkeys));
+    }
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(seckeys != NULL || n == 0);
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(seckeys[i] != NULL);
+    }
+
+    for (i = 0; i < n; i += n_batch) {
+        n_batch = n - i < EC_PUBKEY_CREATE_BATCH_SIZE ? n - i : EC_PUBKEY_CREATE_BATCH_SIZE;
+        for (j = 0; j < n_batch; j++) {
+            valid[j] = secp256k1_scalar_set_b32_seckey(&seckey_scalar, seckeys[i + j]);
+            secp256k1_scalar_cmov(&seckey_scalar, &secp256k1_scalar_one, !valid[j]);
+            secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pj[j], &seckey_scalar);
+        }
+        /* None of the points is infinity because the scalars are nonzero */
+        secp256k1_ge_set_all_gej(p, pj, n_batch);
+        for (j = 0; j < n_batch; j++) {
+            secp256k1_pubkey_save(&pubkeys[i + j], &p[j]);
+            secp256k1_memczero(&pubkeys[i + j], sizeof(pubkeys[i + j]), !valid[j]);
+            ret &= valid[j];
+        }
+    }
+
+    secp256k1_scalar_clear(&seckey_scalar);
+    return ret;
+}
+
+/* Number of public keys which share a field inversion in
+ * secp256k1_pubkey_iterator_next. */
+#define PUBKEY_ITERATOR_BATCH_SIZE 64
+
+static void secp256k1_pubkey_iterator_save(secp256k1_pubkey_iterator *iter, secp256k1_ge *current, secp256k1_ge *step) {
+    iter->data[128] = secp256k1_ge_is_infinity(current);
+    if (iter->data[128]) {
+        memset(iter->data, 0, 64);
+    } else {
+        secp256k1_pubkey_save((secp256k1_pubkey *) &iter->data[0], current);
+    }
+    secp256k1_pubkey_save((secp256k1_pubkey *) &iter->data[64], step);
+}
+
+static int secp256k1_pubkey_iterator_load(const secp256k1_context* ctx, secp256k1_ge *current, secp256k1_ge *step, const secp256k1_pubkey_iterator *iter) {
+    if (!secp256k1_pubkey_load(ctx, step, (const secp256k1_pubkey *) &iter->data[64])) {
+        return 0;
+    }
+    if (iter->data[128]) {
+        secp256k1_ge_set_infinity(current);
+        return 1;
+    }
+    return secp256k1_pubkey_load(ctx, current, (const secp256k1_pubkey *) &iter->data[0]);
+}
+
+int secp256k1_pubkey_iterator_init(const secp256k1_context* ctx, secp256k1_pubkey_iterator *iter, const secp256k1_pubkey *start, const secp256k1_pubkey *step) {
+    secp256k1_ge current, s;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(iter != NULL);
+    memset(iter, 0, sizeof(*iter));
+    ARG_CHECK(start != NULL);
+
+    if (!secp256k1_pubkey_load(ctx, &current, start)) {
+        return 0;
+    }
+    if (step == NULL) {
+        s = secp256k1_ge_const_g;
+    } else if (!secp256k1_pubkey_load(ctx, &s, step)) {
+        return 0;
+    }
+    secp256k1_pubkey_iterator_save(iter, &current, &s);
+    return 1;
+}
+
+int secp256k1_pubkey_iterator_next(const secp256k1_context* ctx, secp256k1_pubkey_iterator *iter, secp256k1_pubkey *pubkeys, size_t n) {
+    secp256k1_gej pj[PUBKEY_ITERATOR_BATCH_SIZE + 1];
+    secp256k1_ge p[PUBKEY_ITERATOR_BATCH_SIZE + 1];
+    secp256k1_ge step;
+    size_t i, j, n_batch;
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(iter != NULL);
+    ARG_CHECK(pubkeys != NULL || n == 0);
+    if (!secp256k1_pubkey_iterator_load(ctx, &p[0], &step, iter)) {
+        return 0;
+    }
+
+    for (i = 0; i < n; i += n_batch) {
+        n_batch = n - i < PUBKEY_ITERATOR_BATCH_SIZE ? n - i : PUBKEY_ITERATOR_BATCH_SIZE;
+        /* Compute the next n_batch points and the point following them, which
+         * becomes the start of the next batch. */
+        secp256k1_gej_set_ge(&pj[0], &p[0]);
+        for (j = 1; j <= n_batch; j++) {
+            secp256k1_gej_add_ge_var(&pj[j], &pj[j - 1], &step, NULL);
+        }
+        secp256k1_ge_set_all_gej_var(p, pj, n_batch + 1);
+        for (j = 0; j < n_batch; j++) {
+            if (secp256k1_ge_is_infinity(&p[j])) {
+                memset(&pubkeys[i + j], 0, sizeof(pubkeys[i + j]));
+                ret = 0;
+            } else {
+                secp256k1_pubkey_save(&pubkeys[i + j], &p[j]);
+            }
+        }
+        p[0] = p[n_batch];
+    }
+    secp256k1_pubkey_iterator_save(iter, &p[0], &step);
+    return ret;
+}
+
 int secp256k1_ec_seckey_negate(const secp256k1_context* ctx, unsigned char *seckey) {
     secp256k1_scalar sec;
     int ret = 0;
@@ -682,11 +1365,11 @@ int secp256k1_ec_privkey_tweak_add(const secp256k1_context* ctx, unsigned char *
     return secp256k1_ec_seckey_tweak_add(ctx, seckey, tweak32);
 }
 
-static int secp256k1_ec_pubkey_tweak_add_helper(secp256k1_ge *p, const unsigned char *tweak32) {
+static int secp256k1_ec_pubkey_tweak_add_helper(const secp256k1_ecmult_context* ecmult_ctx, secp256k1_ge *p, const unsigned char *tweak32) {
     secp256k1_scalar term;
     int overflow = 0;
     secp256k1_scalar_set_b32(&term, tweak32, &overflow);
-    return !overflow && secp256k1_eckey_pubkey_tweak_add(p, &term);
+    return !overflow && secp256k1_eckey_pubkey_tweak_add(ecmult_ctx, p, &term);
 }
 
 int secp256k1_ec_pubkey_tweak_add(const secp256k1_context* ctx, secp256k1_pubkey *pubkey, const unsigned char *tweak32) {
@@ -698,7 +1381,7 @@ int secp256k1_ec_pubkey_tweak_add(const secp256k1_context* ctx, secp256k1_pubkey
 
     ret = secp256k1_pubkey_load(ctx, &p, pubkey);
     memset(pubkey, 0, sizeof(*pubkey));
-    ret = ret && secp256k1_ec_pubkey_tweak_add_helper(&p, tweak32);
+    ret = ret && secp256k1_ec_pubkey_tweak_add_helper(&ctx->ecmult_ctx, &p, tweak32);
     if (ret) {
         secp256k1_pubkey_save(pubkey, &p);
     }
@@ -743,7 +1426,7 @@ int secp256k1_ec_pubkey_tweak_mul(const secp256k1_context* ctx, secp256k1_pubkey
     ret = !overflow && secp256k1_pubkey_load(ctx, &p, pubkey);
     memset(pubkey, 0, sizeof(*pubkey));
     if (ret) {
-        if (secp256k1_eckey_pubkey_tweak_mul(&p, &factor)) {
+        if (secp256k1_eckey_pubkey_tweak_mul(&ctx->ecmult_ctx, &p, &factor)) {
             secp256k1_pubkey_save(pubkey, &p);
         } else {
             ret = 0;
@@ -785,6 +1468,78 @@ int secp256k1_ec_pubkey_combine(const secp256k1_context* ctx, secp256k1_pubkey *
     return 1;
 }
 
+typedef struct {
+    const secp256k1_context *ctx;
+    secp256k1_ecmult_multi_input_callback cb;
+    void *cbdata;
+} secp256k1_ecmult_multi_input_data;
+
+/* Converts the public inputs provided by the user callback into the internal
+ * representation expected by ecmult_multi. It only reads input_data, so it is
+ * safe to call concurrently if the user callback is. */
+static int secp256k1_ecmult_multi_input_ecmult_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    secp256k1_ecmult_multi_input_data *input_data = (secp256k1_ecmult_multi_input_data *) data;
+    unsigned char buf[32];
+    secp256k1_pubkey pubkey;
+    int overflow;
+
+    if (!input_data->cb(buf, &pubkey, idx, input_data->cbdata)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(sc, buf, &overflow);
+    if (overflow) {
+        return 0;
+    }
+    return secp256k1_pubkey_load(input_data->ctx, pt, &pubkey);
+}
+
+static int secp256k1_ecmult_multi_internal(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *pubkey, const unsigned char *g_scalar32, secp256k1_ecmult_multi_input_callback cb, void *cbdata, size_t n, secp256k1_ecmult_multi_dispatch_callback dispatch, void *dispatch_data, size_t n_tasks) {
+    secp256k1_ecmult_multi_input_data input_data;
+    secp256k1_scalar g_sc;
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    int overflow = 0;
+
+    if (g_scalar32 != NULL) {
+        secp256k1_scalar_set_b32(&g_sc, g_scalar32, &overflow);
+        if (overflow) {
+            return 0;
+        }
+    }
+    input_data.ctx = ctx;
+    input_data.cb = cb;
+    input_data.cbdata = cbdata;
+    if (!secp256k1_ecmult_multi_var_parallel(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &rj, g_scalar32 != NULL ? &g_sc : NULL, secp256k1_ecmult_multi_input_ecmult_callback, (void *) &input_data, n, dispatch, dispatch_data, n_tasks)) {
+        return 0;
+    }
+    if (secp256k1_gej_is_infinity(&rj)) {
+        return 0;
+    }
+    secp256k1_ge_set_gej(&r, &rj);
+    secp256k1_pubkey_save(pubkey, &r);
+    return 1;
+}
+
+int secp256k1_ecmult_multi(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *pubkey, const unsigned char *g_scalar32, secp256k1_ecmult_multi_input_callback cb, void *cbdata, size_t n) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkey != NULL);
+    memset(pubkey, 0, sizeof(*pubkey));
+    ARG_CHECK(cb != NULL || n == 0);
+
+    /* With a single task the dispatch function is never called. */
+    return secp256k1_ecmult_multi_internal(ctx, scratch, pubkey, g_scalar32, cb, cbdata, n, NULL, NULL, 1);
+}
+
+int secp256k1_ecmult_multi_parallel(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *pubkey, const unsigned char *g_scalar32, secp256k1_ecmult_multi_input_callback cb, void *cbdata, size_t n, secp256k1_ecmult_multi_dispatch_callback dispatch, void *dispatch_data, size_t n_tasks) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkey != NULL);
+    memset(pubkey, 0, sizeof(*pubkey));
+    ARG_CHECK(cb != NULL || n == 0);
+    ARG_CHECK(dispatch != NULL);
+
+    return secp256k1_ecmult_multi_internal(ctx, scratch, pubkey, g_scalar32, cb, cbdata, n, dispatch, dispatch_data, n_tasks);
+}
+
 int secp256k1_tagged_sha256(const secp256k1_context* ctx, unsigned char *hash32, const unsigned char *tag, size_t taglen, const unsigned char *msg, size_t msglen) {
     secp256k1_sha256 sha;
     VERIFY_CHECK(ctx != NULL);
@@ -798,6 +1553,91 @@ int secp256k1_tagged_sha256(const secp256k1_context* ctx, unsigned char *hash32,
     return 1;
 }
 
+static int secp256k1_tagged_sha256_batch_args(const secp256k1_context* ctx, unsigned char *hash32, const unsigned char *const *msg, const size_t *msglen, size_t n) {
+    size_t i;
+    if (n > 0) {
+        ARG_CHECK(hash32 != NULL);
+        ARG_CHECK(msg != NULL);
+        ARG_CHECK(msglen != NULL);
+    }
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(msg[i] != NULL || msglen[i] == 0);
+    }
+    return 1;
+}
+
+int secp256k1_tagged_sha256_batch(const secp256k1_context* ctx, unsigned char *hash32, const unsigned char *tag, size_t taglen, const unsigned char *const *msg, const size_t *msglen, size_t n) {
+    secp256k1_sha256 sha;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(tag != NULL);
+    if (!secp256k1_tagged_sha256_batch_args(ctx, hash32, msg, msglen, n)) {
+        return 0;
+    }
+
+    secp256k1_sha256_initialize_tagged(&sha, tag, taglen);
+    secp256k1_sha256_batch(&sha, hash32, msg, msglen, n);
+    return 1;
+}
+
+/* The midstate is stored as the big endian state words. The number of bytes
+ * hashed is always 64. */
+static void secp256k1_tagged_sha256_ctx_save(secp256k1_tagged_sha256_ctx *tag_ctx, const secp256k1_sha256 *sha) {
+    int i;
+    VERIFY_CHECK(sha->bytes == 64);
+    for (i = 0; i < 8; i++) {
+        tag_ctx->data[4*i] = sha->s[i] >> 24;
+        tag_ctx->data[4*i + 1] = sha->s[i] >> 16;
+        tag_ctx->data[4*i + 2] = sha->s[i] >> 8;
+        tag_ctx->data[4*i + 3] = sha->s[i];
+    }
+}
+
+static void secp256k1_tagged_sha256_ctx_load(secp256k1_sha256 *sha, const secp256k1_tagged_sha256_ctx *tag_ctx) {
+    int i;
+    for (i = 0; i < 8; i++) {
+        sha->s[i] = (uint32_t)tag_ctx->data[4*i] << 24 | (uint32_t)tag_ctx->data[4*i + 1] << 16 | (uint32_t)tag_ctx->data[4*i + 2] << 8 | tag_ctx->data[4*i + 3];
+    }
+    sha->bytes = 64;
+}
+
+int secp256k1_tagged_sha256_ctx_init(const secp256k1_context* ctx, secp256k1_tagged_sha256_ctx *tag_ctx, const unsigned char *tag, size_t taglen) {
+    secp256k1_sha256 sha;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(tag_ctx != NULL);
+    memset(tag_ctx, 0, sizeof(*tag_ctx));
+    ARG_CHECK(tag != NULL);
+
+    secp256k1_sha256_initialize_tagged(&sha, tag, taglen);
+    secp256k1_tagged_sha256_ctx_save(tag_ctx, &sha);
+    return 1;
+}
+
+int secp256k1_tagged_sha256_ctx_hash(const secp256k1_context* ctx, unsigned char *hash32, const secp256k1_tagged_sha256_ctx *tag_ctx, const unsigned char *msg, size_t msglen) {
+    secp256k1_sha256 sha;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash32 != NULL);
+    ARG_CHECK(tag_ctx != NULL);
+    ARG_CHECK(msg != NULL);
+
+    secp256k1_tagged_sha256_ctx_load(&sha, tag_ctx);
+    secp256k1_sha256_write(&sha, msg, msglen);
+    secp256k1_sha256_finalize(&sha, hash32);
+    return 1;
+}
+
+int secp256k1_tagged_sha256_ctx_hash_batch(const secp256k1_context* ctx, unsigned char *hash32, const secp256k1_tagged_sha256_ctx *tag_ctx, const unsigned char *const *msg, const size_t *msglen, size_t n) {
+    secp256k1_sha256 sha;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(tag_ctx != NULL);
+    if (!secp256k1_tagged_sha256_batch_args(ctx, hash32, msg, msglen, n)) {
+        return 0;
+    }
+
+    secp256k1_tagged_sha256_ctx_load(&sha, tag_ctx);
+    secp256k1_sha256_batch(&sha, hash32, msg, msglen, n);
+    return 1;
+}
+
 #ifdef ENABLE_MODULE_ECDH
 # include "modules/ecdh/main_impl.h"
 #endif
@@ -31,6 +31,7 @@
 #include "../include/secp256k1_preallocated.h"
 #include "testrand_impl.h"
 #include "util.h"
+#include "cpu.h"
 
 #ifdef ENABLE_OPENSSL_TESTS
 #include <openssl/bn.h>
@@ -326,8 +327,8 @@ void run_context_tests(int use_prealloc) {
     CHECK(secp256k1_ecdsa_sig_sign(&both->ecmult_gen_ctx, &sigr, &sigs, &key, &msg, &nonce, NULL));
 
     /* try verifying */
-    CHECK(secp256k1_ecdsa_sig_verify(&sigr, &sigs, &pub, &msg));
-    CHECK(secp256k1_ecdsa_sig_verify(&sigr, &sigs, &pub, &msg));
+    CHECK(secp256k1_ecdsa_sig_verify(&vrfy->ecmult_ctx, &sigr, &sigs, &pub, &msg));
+    CHECK(secp256k1_ecdsa_sig_verify(&both->ecmult_ctx, &sigr, &sigs, &pub, &msg));
 
     /* cleanup */
     if (use_prealloc) {
@@ -491,6 +492,26 @@ void run_sha256_tests(void) {
     }
 }
 
+void run_sha256_transform_tests(void) {
+    int i, j;
+    for (i = 0; i < 64; i++) {
+        uint32_t s1[8], s2[8], chunk[16];
+        for (j = 0; j < 8; j++) {
+            s1[j] = s2[j] = secp256k1_testrand32();
+        }
+        for (j = 0; j < 16; j++) {
+            chunk[j] = secp256k1_testrand32();
+        }
+        /* Compare the transformation using CPU extensions with the portable one. */
+        secp256k1_cpu_features_mask = ~0;
+        secp256k1_sha256_transform(s1, chunk);
+        secp256k1_cpu_features_mask = 0;
+        secp256k1_sha256_transform(s2, chunk);
+        secp256k1_cpu_features_mask = ~0;
+        CHECK(memcmp(s1, s2, sizeof(s1)) == 0);
+    }
+}
+
 void run_hmac_sha256_tests(void) {
     static const char *keys[6] = {
         "\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b",
@@ -608,6 +629,117 @@ void run_tagged_sha256_tests(void) {
     secp256k1_context_destroy(none);
 }
 
+void run_tagged_sha256_batch_tests(void) {
+    static const int masks[4] = { ~0, ~SECP256K1_CPU_SHA, ~(SECP256K1_CPU_AVX512F | SECP256K1_CPU_SHA), 0 };
+    int ecount = 0;
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    unsigned char tag[] = "tag";
+    unsigned char data[40][200];
+    const unsigned char *msg[40];
+    size_t msglen[40];
+    unsigned char hash32[40][32];
+    unsigned char expected[32];
+    size_t i, n;
+    int m;
+
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+
+    /* API test */
+    msg[0] = data[0];
+    msglen[0] = 0;
+    CHECK(secp256k1_tagged_sha256_batch(none, NULL, tag, 3, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_tagged_sha256_batch(none, &hash32[0][0], NULL, 0, msg, msglen, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_tagged_sha256_batch(none, NULL, tag, 3, msg, msglen, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_tagged_sha256_batch(none, &hash32[0][0], tag, 3, NULL, msglen, 1) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_tagged_sha256_batch(none, &hash32[0][0], tag, 3, msg, NULL, 1) == 0);
+    CHECK(ecount == 4);
+    msg[0] = NULL;
+    CHECK(secp256k1_tagged_sha256_batch(none, &hash32[0][0], tag, 3, msg, msglen, 1) == 1);
+    msglen[0] = 1;
+    CHECK(secp256k1_tagged_sha256_batch(none, &hash32[0][0], tag, 3, msg, msglen, 1) == 0);
+    CHECK(ecount == 5);
+
+    /* Compare with secp256k1_tagged_sha256, with and without the multi-buffer
+     * implementations, for messages of lengths around the block boundaries. */
+    for (m = 0; m < 4; m++) {
+        secp256k1_cpu_features_mask = masks[m];
+        for (n = 0; n <= 40; n += 1 + secp256k1_testrand_int(8)) {
+            for (i = 0; i < n; i++) {
+                msglen[i] = secp256k1_testrand_int(200);
+                secp256k1_testrand_bytes_test(data[i], msglen[i]);
+                msg[i] = data[i];
+            }
+            CHECK(secp256k1_tagged_sha256_batch(none, &hash32[0][0], tag, 3, msg, msglen, n) == 1);
+            for (i = 0; i < n; i++) {
+                CHECK(secp256k1_tagged_sha256(none, expected, tag, 3, msg[i], msglen[i]) == 1);
+                CHECK(secp256k1_memcmp_var(hash32[i], expected, 32) == 0);
+            }
+        }
+    }
+    secp256k1_cpu_features_mask = ~0;
+    secp256k1_context_destroy(none);
+}
+
+void run_tagged_sha256_ctx_tests(void) {
+    int ecount = 0;
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_tagged_sha256_ctx tag_ctx;
+    unsigned char tag[100];
+    unsigned char data[20][100];
+    const unsigned char *msg[20];
+    size_t msglen[20];
+    unsigned char hash32[20][32];
+    unsigned char expected[32];
+    size_t taglen, i;
+    int j;
+
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+
+    /* API test */
+    memset(tag, 0, sizeof(tag));
+    CHECK(secp256k1_tagged_sha256_ctx_init(none, NULL, tag, 3) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_tagged_sha256_ctx_init(none, &tag_ctx, NULL, 0) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_tagged_sha256_ctx_init(none, &tag_ctx, tag, 3) == 1);
+    CHECK(secp256k1_tagged_sha256_ctx_hash(none, NULL, &tag_ctx, tag, 3) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_tagged_sha256_ctx_hash(none, hash32[0], NULL, tag, 3) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_tagged_sha256_ctx_hash(none, hash32[0], &tag_ctx, NULL, 0) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_tagged_sha256_ctx_hash_batch(none, NULL, &tag_ctx, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_tagged_sha256_ctx_hash_batch(none, NULL, NULL, NULL, NULL, 0) == 0);
+    CHECK(ecount == 6);
+    msg[0] = NULL;
+    msglen[0] = 1;
+    CHECK(secp256k1_tagged_sha256_ctx_hash_batch(none, &hash32[0][0], &tag_ctx, msg, msglen, 1) == 0);
+    CHECK(ecount == 7);
+
+    /* Compare with secp256k1_tagged_sha256 */
+    for (j = 0; j < 8; j++) {
+        taglen = secp256k1_testrand_int(sizeof(tag));
+        secp256k1_testrand_bytes_test(tag, taglen);
+        CHECK(secp256k1_tagged_sha256_ctx_init(none, &tag_ctx, tag, taglen) == 1);
+        for (i = 0; i < 20; i++) {
+            msglen[i] = secp256k1_testrand_int(sizeof(data[i]));
+            secp256k1_testrand_bytes_test(data[i], msglen[i]);
+            msg[i] = data[i];
+        }
+        CHECK(secp256k1_tagged_sha256_ctx_hash_batch(none, &hash32[0][0], &tag_ctx, msg, msglen, 20) == 1);
+        for (i = 0; i < 20; i++) {
+            CHECK(secp256k1_tagged_sha256(none, expected, tag, taglen, msg[i], msglen[i]) == 1);
+            CHECK(secp256k1_memcmp_var(hash32[i], expected, 32) == 0);
+            CHECK(secp256k1_tagged_sha256_ctx_hash(none, hash32[i], &tag_ctx, msg[i], msglen[i]) == 1);
+            CHECK(secp256k1_memcmp_var(hash32[i], expected, 32) == 0);
+        }
+    }
+    secp256k1_context_destroy(none);
+}
+
 /***** RANDOM TESTS *****/
 
 void test_rand_bits(int rand32, int bits) {
@@ -2680,6 +2812,95 @@ void run_sqrt(void) {
     }
 }
 
+void run_sqrt_batch(void) {
+    secp256k1_fe a[11], r[11];
+    int ret[11];
+    size_t i, len;
+    int dispatch;
+
+    /* Test both with and without the code paths for CPU extensions. */
+    for (dispatch = 0; dispatch < 2; dispatch++) {
+        secp256k1_cpu_features_mask = dispatch ? ~0 : 0;
+        for (len = 1; len <= 11; len++) {
+            for (i = 0; i < len; i++) {
+                random_fe_test(&a[i]);
+                if (secp256k1_testrand_bits(1)) {
+                    secp256k1_fe_sqr(&a[i], &a[i]);
+                }
+            }
+            secp256k1_fe_sqrt_batch(r, ret, a, len);
+            for (i = 0; i < len; i++) {
+                secp256k1_fe s;
+                CHECK(ret[i] == secp256k1_fe_sqrt(&s, &a[i]));
+                CHECK(check_fe_equal(&s, &r[i]));
+            }
+        }
+    }
+}
+
+#ifdef SECP256K1_FE_LANES
+void run_field_lanes(void) {
+    /* p - 1, which has the largest limbs of any normalized element */
+    static const secp256k1_fe p_minus_one = SECP256K1_FE_CONST(
+        0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+        0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFE, 0xFFFFFC2E
+    );
+    secp256k1_fe a[SECP256K1_FE_LANES], b[SECP256K1_FE_LANES], r[SECP256K1_FE_LANES], t;
+    secp256k1_fe_lanes al, bl, rl;
+    size_t i, len;
+    int j, n;
+
+    if (!secp256k1_cpu_has(SECP256K1_CPU_AVX512IFMA)) {
+        return;
+    }
+    for (j = 0; j < 8 * count; j++) {
+        len = 1 + secp256k1_testrand_int(SECP256K1_FE_LANES);
+        for (i = 0; i < len; i++) {
+            if (secp256k1_testrand_bits(3) == 0) {
+                a[i] = p_minus_one;
+            } else {
+                random_field_element_test(&a[i]);
+            }
+            random_field_element_test(&b[i]);
+            random_field_element_magnitude(&a[i]);
+            random_field_element_magnitude(&b[i]);
+        }
+        secp256k1_fe_lanes_load(&al, a, len);
+        secp256k1_fe_lanes_load(&bl, b, len);
+
+        secp256k1_fe_lanes_mul(&rl, &al, &bl);
+        secp256k1_fe_lanes_store(r, &rl, len);
+        for (i = 0; i < len; i++) {
+            secp256k1_fe_mul(&t, &a[i], &b[i]);
+            CHECK(check_fe_equal(&t, &r[i]));
+        }
+
+        secp256k1_fe_lanes_sqr(&rl, &al);
+        secp256k1_fe_lanes_store(r, &rl, len);
+        for (i = 0; i < len; i++) {
+            secp256k1_fe_sqr(&t, &a[i]);
+            CHECK(check_fe_equal(&t, &r[i]));
+        }
+
+        /* Outputs of lane operations are valid inputs, also when aliased. */
+        n = secp256k1_testrand_int(4);
+        secp256k1_fe_lanes_sqr_n_mul(&al, &al, n, &bl);
+        secp256k1_fe_lanes_mul(&al, &al, &al);
+        secp256k1_fe_lanes_store(r, &al, len);
+        for (i = 0; i < len; i++) {
+            int k;
+            t = a[i];
+            for (k = 0; k < n; k++) {
+                secp256k1_fe_sqr(&t, &t);
+            }
+            secp256k1_fe_mul(&t, &t, &b[i]);
+            secp256k1_fe_sqr(&t, &t);
+            CHECK(check_fe_equal(&t, &r[i]));
+        }
+    }
+}
+#endif
+
 /***** FIELD/SCALAR INVERSE TESTS *****/
 
 static const secp256k1_scalar scalar_minus_one = SECP256K1_SCALAR_CONST(
@@ -2992,6 +3213,38 @@ void run_inverse_tests(void)
     }
 }
 
+void run_inverse_all_tests(void) {
+    secp256k1_fe fe_a[12], fe_r[12], fe_t;
+    secp256k1_scalar sc_a[12], sc_r[12], sc_t;
+    size_t i, len;
+    int var, j;
+
+    for (j = 0; j < count; j++) {
+        for (len = 0; len <= 12; len++) {
+            /* Include zero inputs, which must be mapped to zero like a single inversion does. */
+            for (i = 0; i < len; i++) {
+                if (secp256k1_testrand_bits(2) == 0) {
+                    secp256k1_fe_clear(&fe_a[i]);
+                    secp256k1_scalar_clear(&sc_a[i]);
+                } else {
+                    random_fe_test(&fe_a[i]);
+                    random_scalar_order_test(&sc_a[i]);
+                }
+            }
+            for (var = 0; var <= 1; var++) {
+                (var ? secp256k1_fe_inv_all_var : secp256k1_fe_inv_all)(fe_r, fe_a, len);
+                (var ? secp256k1_scalar_inverse_all_var : secp256k1_scalar_inverse_all)(sc_r, sc_a, len);
+                for (i = 0; i < len; i++) {
+                    secp256k1_fe_inv(&fe_t, &fe_a[i]);
+                    CHECK(check_fe_equal(&fe_t, &fe_r[i]));
+                    secp256k1_scalar_inverse(&sc_t, &sc_a[i]);
+                    CHECK(secp256k1_scalar_eq(&sc_t, &sc_r[i]));
+                }
+            }
+        }
+    }
+}
+
 /***** GROUP TESTS *****/
 
 void ge_equals_ge(const secp256k1_ge *a, const secp256k1_ge *b) {
@@ -3207,6 +3460,17 @@ void test_ge(void) {
         free(ge_set_all);
     }
 
+    /* Test constant-time batch gej -> ge conversion. */
+    {
+        secp256k1_ge *ge_set_all = (secp256k1_ge *)checked_malloc(&ctx->error_callback, (4 * runs) * sizeof(secp256k1_ge));
+        /* gej[0] is infinity */
+        secp256k1_ge_set_all_gej(ge_set_all, &gej[1], 4 * runs);
+        for (i = 0; i < 4 * runs; i++) {
+            ge_equals_gej(&ge_set_all[i], &gej[i + 1]);
+        }
+        free(ge_set_all);
+    }
+
     /* Test batch gej -> ge conversion with many infinities. */
     for (i = 0; i < 4 * runs + 1; i++) {
         int odd;
@@ -3375,6 +3639,277 @@ void test_ec_combine(void) {
     }
 }
 
+void test_ec_pubkey_create_batch(void) {
+    enum { N_KEYS = 80 };
+    unsigned char seckeys[N_KEYS][32];
+    const unsigned char *seckey_ptr[N_KEYS];
+    secp256k1_pubkey pubkeys[N_KEYS];
+    secp256k1_pubkey pubkey;
+    secp256k1_pubkey zero_pubkey;
+    size_t n = secp256k1_testrand_int(N_KEYS + 1);
+    size_t i;
+    int expected = 1;
+    int ecount = 0;
+
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar s;
+        random_scalar_order_test(&s);
+        secp256k1_scalar_get_b32(seckeys[i], &s);
+        if (secp256k1_testrand_int(16) == 0) {
+            /* Invalid secret key */
+            memset(seckeys[i], secp256k1_testrand_bits(1) ? 0xFF : 0, 32);
+            expected = 0;
+        }
+        seckey_ptr[i] = seckeys[i];
+    }
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, pubkeys, seckey_ptr, n) == expected);
+    for (i = 0; i < n; i++) {
+        int ret = secp256k1_ec_pubkey_create(ctx, &pubkey, seckeys[i]);
+        CHECK(ret || expected == 0);
+        CHECK(secp256k1_memcmp_var(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+    }
+
+    memset(&zero_pubkey, 0, sizeof(zero_pubkey));
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, NULL, NULL, 0) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, NULL, seckey_ptr, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ec_pubkey_create_batch(ctx, pubkeys, NULL, 1) == 0);
+    CHECK(ecount == 2);
+    if (n > 0) {
+        seckey_ptr[n - 1] = NULL;
+        CHECK(secp256k1_ec_pubkey_create_batch(ctx, pubkeys, seckey_ptr, n) == 0);
+        CHECK(ecount == 3);
+        for (i = 0; i < n; i++) {
+            CHECK(secp256k1_memcmp_var(&pubkeys[i], &zero_pubkey, sizeof(pubkeys[i])) == 0);
+        }
+    }
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
+void test_pubkey_iterator(void) {
+    enum { N_KEYS = 150 };
+    secp256k1_pubkey_iterator iter;
+    secp256k1_pubkey pubkeys[N_KEYS];
+    secp256k1_pubkey start, step, pubkey, zero_pubkey;
+    secp256k1_scalar k, t, s;
+    unsigned char seckey[32];
+    size_t i, n, n_done;
+    int use_g = secp256k1_testrand_bits(1);
+    int ecount = 0;
+
+    memset(&zero_pubkey, 0, sizeof(zero_pubkey));
+    random_scalar_order_test(&k);
+    secp256k1_scalar_get_b32(seckey, &k);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &start, seckey) == 1);
+    if (use_g) {
+        secp256k1_scalar_set_int(&t, 1);
+    } else {
+        random_scalar_order_test(&t);
+        secp256k1_scalar_get_b32(seckey, &t);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &step, seckey) == 1);
+    }
+    CHECK(secp256k1_pubkey_iterator_init(ctx, &iter, &start, use_g ? NULL : &step) == 1);
+
+    /* Produce the keys in chunks of random size */
+    for (n_done = 0; n_done < N_KEYS; n_done += n) {
+        n = secp256k1_testrand_int(N_KEYS - n_done + 1);
+        CHECK(secp256k1_pubkey_iterator_next(ctx, &iter, &pubkeys[n_done], n) == 1);
+    }
+    s = k;
+    for (i = 0; i < N_KEYS; i++) {
+        secp256k1_scalar_get_b32(seckey, &s);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == 1);
+        CHECK(secp256k1_memcmp_var(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+        secp256k1_scalar_add(&s, &s, &t);
+    }
+
+    /* Passing the point at infinity: start at -2*step */
+    secp256k1_scalar_add(&s, &t, &t);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_scalar_get_b32(seckey, &s);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &start, seckey) == 1);
+    CHECK(secp256k1_pubkey_iterator_init(ctx, &iter, &start, use_g ? NULL : &step) == 1);
+    CHECK(secp256k1_pubkey_iterator_next(ctx, &iter, pubkeys, 2) == 1);
+    CHECK(secp256k1_pubkey_iterator_next(ctx, &iter, &pubkeys[2], 1) == 0);
+    CHECK(secp256k1_memcmp_var(&pubkeys[2], &zero_pubkey, sizeof(pubkey)) == 0);
+    CHECK(secp256k1_pubkey_iterator_next(ctx, &iter, &pubkeys[3], 2) == 1);
+    CHECK(secp256k1_pubkey_iterator_init(ctx, &iter, &start, use_g ? NULL : &step) == 1);
+    CHECK(secp256k1_pubkey_iterator_next(ctx, &iter, &pubkeys[5], 5) == 0);
+    CHECK(secp256k1_memcmp_var(&pubkeys[0], &pubkeys[5], 5 * sizeof(pubkey)) == 0);
+    for (i = 0; i < 5; i++) {
+        secp256k1_scalar_get_b32(seckey, &s);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, seckey) == (i != 2));
+        CHECK(secp256k1_memcmp_var(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+        secp256k1_scalar_add(&s, &s, &t);
+    }
+
+    /* Illegal arguments */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_pubkey_iterator_init(ctx, NULL, &start, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_pubkey_iterator_init(ctx, &iter, NULL, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_pubkey_iterator_init(ctx, &iter, &zero_pubkey, NULL) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_pubkey_iterator_init(ctx, &iter, &start, &zero_pubkey) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_pubkey_iterator_next(ctx, &iter, pubkeys, 1) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_pubkey_iterator_init(ctx, &iter, &start, NULL) == 1);
+    CHECK(secp256k1_pubkey_iterator_next(ctx, NULL, pubkeys, 1) == 0);
+    CHECK(ecount == 6);
+    CHECK(secp256k1_pubkey_iterator_next(ctx, &iter, NULL, 1) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_pubkey_iterator_next(ctx, &iter, NULL, 0) == 1);
+    CHECK(ecount == 7);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
+void run_pubkey_iterator(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_pubkey_iterator();
+    }
+}
+
+void test_ec_pubkey_parse_serialize_batch(void) {
+    enum { N_KEYS = 50 };
+    unsigned char inputs[N_KEYS][65];
+    const unsigned char *input_ptr[N_KEYS];
+    size_t inputlens[N_KEYS];
+    unsigned char output[N_KEYS * 65];
+    size_t outputlen;
+    secp256k1_pubkey pubkeys[N_KEYS];
+    secp256k1_pubkey pubkey;
+    int valid[N_KEYS];
+    static const unsigned char g_serialized[33] = {
+        0x02, 0x79, 0xBE, 0x66, 0x7E, 0xF9, 0xDC, 0xBB, 0xAC, 0x55, 0xA0, 0x62,
+        0x95, 0xCE, 0x87, 0x0B, 0x07, 0x02, 0x9B, 0xFC, 0xDB, 0x2D, 0xCE, 0x28,
+        0xD9, 0x59, 0xF2, 0x81, 0x5B, 0x16, 0xF8, 0x17, 0x98
+    };
+    size_t n = secp256k1_testrand_int(N_KEYS + 1);
+    size_t i;
+    int ret, batch_ret;
+    int all_valid = 1;
+    int ecount = 0;
+
+    for (i = 0; i < n; i++) {
+        secp256k1_ge ge;
+        int compressed = secp256k1_testrand_bits(1);
+        random_group_element_test(&ge);
+        inputlens[i] = 65;
+        CHECK(secp256k1_eckey_pubkey_serialize(&ge, inputs[i], &inputlens[i], compressed));
+        switch (secp256k1_testrand_int(8)) {
+        case 0:
+            /* Random garbage, most likely an invalid key */
+            secp256k1_testrand256(&inputs[i][1]);
+            break;
+        case 1:
+            /* Wrong length */
+            inputlens[i] = secp256k1_testrand_int(66);
+            break;
+        case 2:
+            /* Hybrid or invalid header byte */
+            inputs[i][0] = secp256k1_testrand_bits(3);
+            break;
+        case 3:
+            /* X coordinate larger than the field size */
+            memset(&inputs[i][1], 0xFF, 32);
+            break;
+        }
+        input_ptr[i] = inputs[i];
+    }
+    batch_ret = secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, valid, input_ptr, inputlens, n);
+    for (i = 0; i < n; i++) {
+        ret = secp256k1_ec_pubkey_parse(ctx, &pubkey, inputs[i], inputlens[i]);
+        CHECK(valid[i] == ret);
+        if (!ret) {
+            memset(&pubkey, 0, sizeof(pubkey));
+        }
+        CHECK(secp256k1_memcmp_var(&pubkey, &pubkeys[i], sizeof(pubkey)) == 0);
+        all_valid &= ret;
+    }
+    CHECK(batch_ret == all_valid);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, NULL, input_ptr, inputlens, n) == all_valid);
+
+    /* Serialize the valid keys */
+    for (i = 0; i < n; i++) {
+        if (!valid[i]) {
+            CHECK(secp256k1_ec_pubkey_parse(ctx, &pubkeys[i], g_serialized, 33) == 1);
+        }
+    }
+    for (i = 0; i < 2; i++) {
+        unsigned int flags = i ? SECP256K1_EC_COMPRESSED : SECP256K1_EC_UNCOMPRESSED;
+        size_t keylen = i ? 33 : 65;
+        size_t j;
+        outputlen = n * keylen;
+        CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, output, &outputlen, pubkeys, n, flags) == 1);
+        CHECK(outputlen == n * keylen);
+        for (j = 0; j < n; j++) {
+            unsigned char out[65];
+            size_t outlen = sizeof(out);
+            CHECK(secp256k1_ec_pubkey_serialize(ctx, out, &outlen, &pubkeys[j], flags) == 1);
+            CHECK(outlen == keylen);
+            CHECK(secp256k1_memcmp_var(out, &output[j * keylen], keylen) == 0);
+        }
+    }
+
+    /* Illegal arguments */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, NULL, valid, input_ptr, inputlens, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, valid, NULL, inputlens, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, valid, input_ptr, NULL, 1) == 0);
+    CHECK(ecount == 3);
+    input_ptr[0] = NULL;
+    CHECK(secp256k1_ec_pubkey_parse_batch(ctx, pubkeys, valid, input_ptr, inputlens, 1) == 0);
+    CHECK(ecount == 4);
+    outputlen = 33;
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, output, &outputlen, pubkeys, 2, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 5);
+    outputlen = 130;
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, output, &outputlen, pubkeys, 2, SECP256K1_CONTEXT_SIGN) == 0);
+    CHECK(outputlen == 0);
+    CHECK(ecount == 6);
+    outputlen = 66;
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, output, &outputlen, NULL, 2, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 7);
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, output, &outputlen, NULL, 0, SECP256K1_EC_COMPRESSED) == 1);
+    CHECK(outputlen == 0);
+    CHECK(ecount == 7);
+    /* An uninitialized public key */
+    memset(&pubkeys[1], 0, sizeof(pubkeys[1]));
+    CHECK(secp256k1_ec_pubkey_parse(ctx, &pubkeys[0], g_serialized, 33) == 1);
+    outputlen = 66;
+    CHECK(secp256k1_ec_pubkey_serialize_batch(ctx, output, &outputlen, pubkeys, 2, SECP256K1_EC_COMPRESSED) == 0);
+    CHECK(ecount == 8);
+    CHECK(outputlen == 66);
+    CHECK(secp256k1_memcmp_var(output, g_serialized, 33) == 0);
+    for (i = 33; i < 66; i++) {
+        CHECK(output[i] == 0);
+    }
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
+void run_ec_pubkey_parse_serialize_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ec_pubkey_parse_serialize_batch();
+    }
+}
+
+void run_ec_pubkey_create_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ec_pubkey_create_batch();
+    }
+}
+
 void run_ec_combine(void) {
     int i;
     for (i = 0; i < count * 8; i++) {
@@ -3382,6 +3917,145 @@ void run_ec_combine(void) {
     }
 }
 
+typedef struct {
+    unsigned char (*scalars)[32];
+    secp256k1_pubkey *pubkeys;
+} ecmult_multi_api_data;
+
+static int ecmult_multi_api_callback(unsigned char *scalar32, secp256k1_pubkey *point, size_t idx, void *data) {
+    ecmult_multi_api_data *api_data = (ecmult_multi_api_data *) data;
+    memcpy(scalar32, api_data->scalars[idx], 32);
+    *point = api_data->pubkeys[idx];
+    return 1;
+}
+
+static int ecmult_multi_api_false_callback(unsigned char *scalar32, secp256k1_pubkey *point, size_t idx, void *data) {
+    (void)scalar32;
+    (void)point;
+    (void)idx;
+    (void)data;
+    return 0;
+}
+
+/* Runs the tasks sequentially in reverse order */
+static void ecmult_multi_test_dispatch(secp256k1_ecmult_multi_task *task, void *task_data, size_t n_tasks, void *dispatch_data) {
+    size_t *n_dispatched = (size_t *) dispatch_data;
+    size_t i;
+    for (i = n_tasks; i > 0; i--) {
+        task(i - 1, task_data);
+    }
+    *n_dispatched += n_tasks;
+}
+
+void test_ecmult_multi_api(void) {
+    enum { N_POINTS = 40 };
+    unsigned char scalars[N_POINTS][32];
+    unsigned char g_scalar[32];
+    unsigned char overflow_scalar[32];
+    secp256k1_pubkey pubkeys[N_POINTS];
+    secp256k1_pubkey tweaked[N_POINTS + 1];
+    const secp256k1_pubkey *tweaked_ptr[N_POINTS + 1];
+    secp256k1_pubkey expected, expected_g, result;
+    secp256k1_scalar sum, s;
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 100000);
+    ecmult_multi_api_data data;
+    int ecount = 0;
+    size_t n_dispatched = 0;
+    size_t i;
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    data.scalars = scalars;
+    data.pubkeys = pubkeys;
+    secp256k1_scalar_clear(&sum);
+    for (i = 0; i < N_POINTS; i++) {
+        secp256k1_ge ge;
+        random_scalar_order_test(&s);
+        secp256k1_scalar_get_b32(scalars[i], &s);
+        random_group_element_test(&ge);
+        secp256k1_pubkey_save(&pubkeys[i], &ge);
+        tweaked[i] = pubkeys[i];
+        CHECK(secp256k1_ec_pubkey_tweak_mul(ctx, &tweaked[i], scalars[i]) == 1);
+        tweaked_ptr[i] = &tweaked[i];
+    }
+    random_scalar_order_test(&s);
+    secp256k1_scalar_get_b32(g_scalar, &s);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &tweaked[N_POINTS], g_scalar) == 1);
+    tweaked_ptr[N_POINTS] = &tweaked[N_POINTS];
+
+    /* Compare against tweak_mul and combine */
+    CHECK(secp256k1_ec_pubkey_combine(ctx, &expected, tweaked_ptr, N_POINTS + 1) == 1);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, g_scalar, ecmult_multi_api_callback, &data, N_POINTS) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_ecmult_multi(ctx, NULL, &result, g_scalar, ecmult_multi_api_callback, &data, N_POINTS) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_ec_pubkey_combine(ctx, &expected, tweaked_ptr, N_POINTS) == 1);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, NULL, ecmult_multi_api_callback, &data, N_POINTS) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, g_scalar, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_memcmp_var(&tweaked[N_POINTS], &result, sizeof(result)) == 0);
+
+    /* The parallel variant computes the same results */
+    CHECK(secp256k1_ec_pubkey_combine(ctx, &expected_g, tweaked_ptr, N_POINTS + 1) == 1);
+    for (i = 1; i <= 8; i++) {
+        n_dispatched = 0;
+        CHECK(secp256k1_ecmult_multi_parallel(ctx, scratch, &result, g_scalar, ecmult_multi_api_callback, &data, N_POINTS, ecmult_multi_test_dispatch, &n_dispatched, i) == 1);
+        CHECK(secp256k1_memcmp_var(&expected_g, &result, sizeof(result)) == 0);
+        CHECK(n_dispatched == (i < 2 ? 0 : i));
+        CHECK(secp256k1_ecmult_multi_parallel(ctx, scratch, &result, NULL, ecmult_multi_api_callback, &data, N_POINTS, ecmult_multi_test_dispatch, &n_dispatched, i) == 1);
+        CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+        n_dispatched = 0;
+        CHECK(secp256k1_ecmult_multi_parallel(ctx, NULL, &result, NULL, ecmult_multi_api_callback, &data, N_POINTS, ecmult_multi_test_dispatch, &n_dispatched, i) == 1);
+        CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+        CHECK(n_dispatched == 0);
+    }
+
+    /* The point at infinity is not a valid result */
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, NULL, NULL, NULL, 0) == 0);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, NULL, ecmult_multi_api_callback, &data, 0) == 0);
+    memset(scalars[1], 0, 32);
+    secp256k1_scalar_set_b32(&s, scalars[0], NULL);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_scalar_get_b32(scalars[1], &s);
+    pubkeys[1] = pubkeys[0];
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, NULL, ecmult_multi_api_callback, &data, 2) == 0);
+    CHECK(secp256k1_memcmp_var(&result, &expected, sizeof(result)) != 0);
+
+    /* Overflowing scalars and failing callbacks */
+    memset(overflow_scalar, 0xFF, 32);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, overflow_scalar, ecmult_multi_api_callback, &data, N_POINTS) == 0);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, g_scalar, ecmult_multi_api_false_callback, NULL, N_POINTS) == 0);
+    memcpy(scalars[N_POINTS - 1], overflow_scalar, 32);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, g_scalar, ecmult_multi_api_callback, &data, N_POINTS) == 0);
+    CHECK(secp256k1_ecmult_multi(ctx, NULL, &result, g_scalar, ecmult_multi_api_callback, &data, N_POINTS) == 0);
+    CHECK(secp256k1_ecmult_multi_parallel(ctx, scratch, &result, g_scalar, ecmult_multi_api_callback, &data, N_POINTS, ecmult_multi_test_dispatch, &n_dispatched, 4) == 0);
+    CHECK(ecount == 0);
+
+    /* Invalid points and illegal arguments */
+    memset(&pubkeys[0], 0, sizeof(pubkeys[0]));
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, g_scalar, ecmult_multi_api_callback, &data, 1) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, NULL, g_scalar, ecmult_multi_api_callback, &data, 1) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecmult_multi(ctx, scratch, &result, g_scalar, NULL, &data, 1) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecmult_multi_parallel(ctx, scratch, NULL, g_scalar, ecmult_multi_api_callback, &data, 1, ecmult_multi_test_dispatch, &n_dispatched, 4) == 0);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_ecmult_multi_parallel(ctx, scratch, &result, g_scalar, NULL, &data, 1, ecmult_multi_test_dispatch, &n_dispatched, 4) == 0);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_ecmult_multi_parallel(ctx, scratch, &result, g_scalar, ecmult_multi_api_callback, &data, 1, NULL, NULL, 4) == 0);
+    CHECK(ecount == 6);
+
+    secp256k1_scratch_space_destroy(ctx, scratch);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+}
+
+void run_ecmult_multi_api(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecmult_multi_api();
+    }
+}
+
 void test_group_decompress(const secp256k1_fe* x) {
     /* The input itself, normalized. */
     secp256k1_fe fex = *x;
@@ -3506,6 +4180,168 @@ void run_ecmult_pre_g(void) {
     CHECK(secp256k1_memcmp_var(&gs, &secp256k1_pre_g_128[0], sizeof(gs)) == 0);
 }
 
+/* Checks a context with verification tables of the given window size, and
+ * its copies, against the default context. */
+void test_ecmult_context_window(int window) {
+    secp256k1_context *wctx[3];
+    void *prealloc;
+    size_t prealloc_size;
+    int i, j;
+
+    wctx[0] = secp256k1_context_create_ecmult_window(SECP256K1_CONTEXT_NONE, window);
+    CHECK(wctx[0] != NULL);
+    CHECK(wctx[0]->ecmult_ctx.window_g == window);
+    CHECK((wctx[0]->ecmult_ctx.pre_g == secp256k1_pre_g) == (window == WINDOW_G));
+    test_pre_g_table(wctx[0]->ecmult_ctx.pre_g, ECMULT_TABLE_SIZE(window));
+    test_pre_g_table(wctx[0]->ecmult_ctx.pre_g_128, ECMULT_TABLE_SIZE(window));
+    CHECK(secp256k1_memcmp_var(&wctx[0]->ecmult_ctx.pre_g[0], &secp256k1_pre_g[0], sizeof(secp256k1_ge_storage)) == 0);
+    CHECK(secp256k1_memcmp_var(&wctx[0]->ecmult_ctx.pre_g_128[0], &secp256k1_pre_g_128[0], sizeof(secp256k1_ge_storage)) == 0);
+
+    /* The tables are copied along with the context and do not depend on the
+     * original context */
+    wctx[1] = secp256k1_context_clone(wctx[0]);
+    secp256k1_context_destroy(wctx[0]);
+    prealloc_size = secp256k1_context_preallocated_size_ecmult_window(SECP256K1_CONTEXT_SIGN, window);
+    CHECK(prealloc_size >= secp256k1_context_preallocated_size(SECP256K1_CONTEXT_SIGN));
+    CHECK((prealloc_size == secp256k1_context_preallocated_size(SECP256K1_CONTEXT_SIGN)) == (window == WINDOW_G));
+    prealloc = malloc(prealloc_size);
+    CHECK(prealloc != NULL);
+    wctx[0] = secp256k1_context_preallocated_create_ecmult_window(prealloc, SECP256K1_CONTEXT_SIGN, window);
+    CHECK(wctx[0] != NULL);
+    CHECK(secp256k1_context_preallocated_clone_size(wctx[0]) == prealloc_size);
+    wctx[2] = secp256k1_context_clone(wctx[0]);
+
+    for (i = 0; i < 3; i++) {
+        CHECK(wctx[i]->ecmult_ctx.window_g == window);
+        for (j = 0; j < 4; j++) {
+            secp256k1_scalar na, ng;
+            secp256k1_ge ge;
+            secp256k1_gej a, r1, r2;
+            secp256k1_ecdsa_signature sig;
+            secp256k1_pubkey pubkey;
+            unsigned char key[32], msg[32];
+
+            random_scalar_order_test(&na);
+            random_scalar_order_test(&ng);
+            random_group_element_test(&ge);
+            random_group_element_jacobian_test(&a, &ge);
+            secp256k1_ecmult(&ctx->ecmult_ctx, &r1, &a, &na, &ng);
+            secp256k1_ecmult(&wctx[i]->ecmult_ctx, &r2, &a, &na, &ng);
+            secp256k1_gej_neg(&r2, &r2);
+            secp256k1_gej_add_var(&r1, &r1, &r2, NULL);
+            CHECK(secp256k1_gej_is_infinity(&r1));
+
+            random_scalar_order_b32(key);
+            secp256k1_testrand256(msg);
+            CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, key) == 1);
+            CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, key, NULL, NULL) == 1);
+            CHECK(secp256k1_ecdsa_verify(wctx[i], &sig, msg, &pubkey) == 1);
+            msg[0] ^= 1;
+            CHECK(secp256k1_ecdsa_verify(wctx[i], &sig, msg, &pubkey) == 0);
+        }
+    }
+
+    secp256k1_context_preallocated_destroy(wctx[0]);
+    free(prealloc);
+    secp256k1_context_destroy(wctx[1]);
+    secp256k1_context_destroy(wctx[2]);
+}
+
+void run_ecmult_context_window(void) {
+    test_ecmult_context_window(SECP256K1_ECMULT_WINDOW_MIN);
+    test_ecmult_context_window(WINDOW_G);
+    test_ecmult_context_window(3 + secp256k1_testrand_int(10));
+}
+
+/* Serializes the tables of a context with the given window size like
+ * gen_ecmult_static_pre_g does. */
+static unsigned char *ecmult_tables_serialize(size_t *len, int window) {
+    secp256k1_context *wctx = secp256k1_context_create_ecmult_window(SECP256K1_CONTEXT_NONE, window);
+    size_t table_size = ECMULT_TABLE_SIZE(window) * sizeof(secp256k1_ge_storage);
+    unsigned char *tables;
+    secp256k1_sha256 hash;
+
+    *len = ECMULT_TABLES_HEADER_SIZE + 2 * table_size;
+    tables = (unsigned char *)malloc(*len);
+    CHECK(wctx != NULL && tables != NULL);
+    memset(tables, 0, ECMULT_TABLES_HEADER_SIZE);
+    memcpy(tables, ECMULT_TABLES_MAGIC, 8);
+    tables[11] = ECMULT_TABLES_VERSION;
+    tables[15] = window;
+    tables[19] = sizeof(secp256k1_ge_storage);
+    memcpy(&tables[ECMULT_TABLES_HEADER_SIZE], wctx->ecmult_ctx.pre_g, table_size);
+    memcpy(&tables[ECMULT_TABLES_HEADER_SIZE + table_size], wctx->ecmult_ctx.pre_g_128, table_size);
+    secp256k1_sha256_initialize(&hash);
+    secp256k1_sha256_write(&hash, tables, 32);
+    secp256k1_sha256_write(&hash, &tables[ECMULT_TABLES_HEADER_SIZE], 2 * table_size);
+    secp256k1_sha256_finalize(&hash, &tables[32]);
+    secp256k1_context_destroy(wctx);
+    return tables;
+}
+
+/* Checks that loading fails and leaves the context unchanged. */
+static void test_ecmult_tables_invalid(secp256k1_context *tctx, const unsigned char *tables, size_t len) {
+    secp256k1_ecmult_context before = tctx->ecmult_ctx;
+    CHECK(secp256k1_context_set_ecmult_tables(tctx, tables, len) == 0);
+    CHECK(secp256k1_memcmp_var(&before, &tctx->ecmult_ctx, sizeof(before)) == 0);
+}
+
+void run_ecmult_tables(void) {
+    int window = 2 + secp256k1_testrand_int(11);
+    size_t len, i;
+    unsigned char *tables = ecmult_tables_serialize(&len, window);
+    secp256k1_context *tctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *clone;
+    secp256k1_pubkey pubkey;
+    secp256k1_ecdsa_signature sig;
+    unsigned char key[32], msg[32];
+    int ecount = 0;
+
+    /* Invalid tables */
+    for (i = 0; i < 20; i++) {
+        size_t idx = secp256k1_testrand_int(32);
+        tables[idx] ^= 1;
+        test_ecmult_tables_invalid(tctx, tables, len);
+        tables[idx] ^= 1;
+    }
+    for (i = 0; i < 20; i++) {
+        size_t idx = 32 + secp256k1_testrand_int(len - 32);
+        unsigned char flip = 1 << secp256k1_testrand_int(8);
+        tables[idx] ^= flip;
+        test_ecmult_tables_invalid(tctx, tables, len);
+        tables[idx] ^= flip;
+    }
+    test_ecmult_tables_invalid(tctx, tables, len - 1);
+    test_ecmult_tables_invalid(tctx, tables, len - sizeof(secp256k1_ge_storage));
+    test_ecmult_tables_invalid(tctx, tables, ECMULT_TABLES_HEADER_SIZE - 1);
+    test_ecmult_tables_invalid(tctx, tables, 0);
+
+    secp256k1_context_set_illegal_callback(tctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_context_set_ecmult_tables(tctx, NULL, len) == 0);
+    CHECK(ecount == 1);
+    secp256k1_context_set_illegal_callback(tctx, NULL, NULL);
+
+    /* Valid tables are used without copying them, also by clones */
+    CHECK(secp256k1_context_set_ecmult_tables(tctx, tables, len) == 1);
+    CHECK(tctx->ecmult_ctx.window_g == window);
+    CHECK((const unsigned char *)tctx->ecmult_ctx.pre_g == &tables[ECMULT_TABLES_HEADER_SIZE]);
+    CHECK(secp256k1_context_preallocated_clone_size(tctx) == secp256k1_context_preallocated_size(SECP256K1_CONTEXT_NONE));
+    clone = secp256k1_context_clone(tctx);
+    secp256k1_context_destroy(tctx);
+    CHECK(clone->ecmult_ctx.pre_g_128 == (const secp256k1_ge_storage *)(void *)&tables[ECMULT_TABLES_HEADER_SIZE + (len - ECMULT_TABLES_HEADER_SIZE) / 2]);
+    for (i = 0; i < 4; i++) {
+        random_scalar_order_b32(key);
+        secp256k1_testrand256(msg);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, key) == 1);
+        CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, key, NULL, NULL) == 1);
+        CHECK(secp256k1_ecdsa_verify(clone, &sig, msg, &pubkey) == 1);
+        msg[0] ^= 1;
+        CHECK(secp256k1_ecdsa_verify(clone, &sig, msg, &pubkey) == 0);
+    }
+    secp256k1_context_destroy(clone);
+    free(tables);
+}
+
 void run_ecmult_chain(void) {
     /* random starting point A (on the curve) */
     secp256k1_gej a = SECP256K1_GEJ_CONST(
@@ -3538,7 +4374,7 @@ void run_ecmult_chain(void) {
     x = a;
     for (i = 0; i < 200*count; i++) {
         /* in each iteration, compute X = xn*X + gn*G; */
-        secp256k1_ecmult(&x, &x, &xn, &gn);
+        secp256k1_ecmult(&ctx->ecmult_ctx, &x, &x, &xn, &gn);
         /* also compute ae and ge: the actual accumulated factors for A and G */
         /* if X was (ae*A+ge*G), xn*X + gn*G results in (xn*ae*A + (xn*ge+gn)*G) */
         secp256k1_scalar_mul(&ae, &ae, &xn);
@@ -3564,7 +4400,7 @@ void run_ecmult_chain(void) {
         }
     }
     /* redo the computation, but directly with the resulting ae and ge coefficients: */
-    secp256k1_ecmult(&x2, &a, &ae, &ge);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &x2, &a, &ae, &ge);
     secp256k1_gej_neg(&x2, &x2);
     secp256k1_gej_add_var(&x2, &x2, &x, NULL);
     CHECK(secp256k1_gej_is_infinity(&x2));
@@ -3582,8 +4418,8 @@ void test_point_times_order(const secp256k1_gej *point) {
     size_t psize = 65;
     random_scalar_order_test(&x);
     secp256k1_scalar_negate(&nx, &x);
-    secp256k1_ecmult(&res1, point, &x, &x); /* calc res1 = x * point + x * G; */
-    secp256k1_ecmult(&res2, point, &nx, &nx); /* calc res2 = (order - x) * point + (order - x) * G; */
+    secp256k1_ecmult(&ctx->ecmult_ctx, &res1, point, &x, &x); /* calc res1 = x * point + x * G; */
+    secp256k1_ecmult(&ctx->ecmult_ctx, &res2, point, &nx, &nx); /* calc res2 = (order - x) * point + (order - x) * G; */
     secp256k1_gej_add_var(&res1, &res1, &res2, NULL);
     CHECK(secp256k1_gej_is_infinity(&res1));
     secp256k1_ge_set_gej(&res3, &res1);
@@ -3593,13 +4429,13 @@ void test_point_times_order(const secp256k1_gej *point) {
     psize = 65;
     CHECK(secp256k1_eckey_pubkey_serialize(&res3, pub, &psize, 1) == 0);
     /* check zero/one edge cases */
-    secp256k1_ecmult(&res1, point, &zero, &zero);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &res1, point, &zero, &zero);
     secp256k1_ge_set_gej(&res3, &res1);
     CHECK(secp256k1_ge_is_infinity(&res3));
-    secp256k1_ecmult(&res1, point, &one, &zero);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &res1, point, &one, &zero);
     secp256k1_ge_set_gej(&res3, &res1);
     ge_equals_gej(&res3, point);
-    secp256k1_ecmult(&res1, point, &zero, &one);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &res1, point, &zero, &one);
     secp256k1_ge_set_gej(&res3, &res1);
     ge_equals_ge(&res3, &secp256k1_ge_const_g);
 }
@@ -3658,9 +4494,9 @@ void test_ecmult_target(const secp256k1_scalar* target, int mode) {
         secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &p2j, &n2);
         secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &ptj, target);
     } else if (mode == 1) {
-        secp256k1_ecmult(&p1j, &pj, &n1, &zero);
-        secp256k1_ecmult(&p2j, &pj, &n2, &zero);
-        secp256k1_ecmult(&ptj, &pj, target, &zero);
+        secp256k1_ecmult(&ctx->ecmult_ctx, &p1j, &pj, &n1, &zero);
+        secp256k1_ecmult(&ctx->ecmult_ctx, &p2j, &pj, &n2, &zero);
+        secp256k1_ecmult(&ctx->ecmult_ctx, &ptj, &pj, target, &zero);
     } else {
         secp256k1_ecmult_const(&p1j, &p, &n1, 256);
         secp256k1_ecmult_const(&p2j, &p, &n2, 256);
@@ -3829,6 +4665,11 @@ static int ecmult_multi_false_callback(secp256k1_scalar *sc, secp256k1_ge *pt, s
     return 0;
 }
 
+static int ecmult_multi_parallel_4(const secp256k1_callback* error_callback, const secp256k1_ecmult_context *ecmult_ctx, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    size_t n_dispatched = 0;
+    return secp256k1_ecmult_multi_var_parallel(error_callback, ecmult_ctx, scratch, r, inp_g_sc, cb, cbdata, n, ecmult_multi_test_dispatch, &n_dispatched, 4);
+}
+
 void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func ecmult_multi) {
     int ncount;
     secp256k1_scalar szero;
@@ -3843,7 +4684,7 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
     secp256k1_scalar_set_int(&szero, 0);
 
     /* No points to multiply */
-    CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, NULL, ecmult_multi_callback, &data, 0));
+    CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, NULL, ecmult_multi_callback, &data, 0));
 
     /* Check 1- and 2-point multiplies against ecmult */
     for (ncount = 0; ncount < count; ncount++) {
@@ -3858,32 +4699,32 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
         pt[1] = secp256k1_ge_const_g;
 
         /* only G scalar */
-        secp256k1_ecmult(&r2, &ptgj, &szero, &sc[0]);
-        CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &sc[0], ecmult_multi_callback, &data, 0));
+        secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &ptgj, &szero, &sc[0]);
+        CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &sc[0], ecmult_multi_callback, &data, 0));
         secp256k1_gej_neg(&r2, &r2);
         secp256k1_gej_add_var(&r, &r, &r2, NULL);
         CHECK(secp256k1_gej_is_infinity(&r));
 
         /* 1-point */
-        secp256k1_ecmult(&r2, &ptgj, &sc[0], &szero);
-        CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, 1));
+        secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &ptgj, &sc[0], &szero);
+        CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, 1));
         secp256k1_gej_neg(&r2, &r2);
         secp256k1_gej_add_var(&r, &r, &r2, NULL);
         CHECK(secp256k1_gej_is_infinity(&r));
 
         /* Try to multiply 1 point, but callback returns false */
-        CHECK(!ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_false_callback, &data, 1));
+        CHECK(!ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_false_callback, &data, 1));
 
         /* 2-point */
-        secp256k1_ecmult(&r2, &ptgj, &sc[0], &sc[1]);
-        CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, 2));
+        secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &ptgj, &sc[0], &sc[1]);
+        CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, 2));
         secp256k1_gej_neg(&r2, &r2);
         secp256k1_gej_add_var(&r, &r, &r2, NULL);
         CHECK(secp256k1_gej_is_infinity(&r));
 
         /* 2-point with G scalar */
-        secp256k1_ecmult(&r2, &ptgj, &sc[0], &sc[1]);
-        CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &sc[1], ecmult_multi_callback, &data, 1));
+        secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &ptgj, &sc[0], &sc[1]);
+        CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &sc[1], ecmult_multi_callback, &data, 1));
         secp256k1_gej_neg(&r2, &r2);
         secp256k1_gej_add_var(&r, &r, &r2, NULL);
         CHECK(secp256k1_gej_is_infinity(&r));
@@ -3900,7 +4741,7 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
                 random_scalar_order(&sc[i]);
                 secp256k1_ge_set_infinity(&pt[i]);
             }
-            CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, sizes[j]));
+            CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, sizes[j]));
             CHECK(secp256k1_gej_is_infinity(&r));
         }
 
@@ -3910,7 +4751,7 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
                 pt[i] = ptg;
                 secp256k1_scalar_set_int(&sc[i], 0);
             }
-            CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, sizes[j]));
+            CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, sizes[j]));
             CHECK(secp256k1_gej_is_infinity(&r));
         }
 
@@ -3923,7 +4764,7 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
                 pt[2 * i + 1] = ptg;
             }
 
-            CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, sizes[j]));
+            CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, sizes[j]));
             CHECK(secp256k1_gej_is_infinity(&r));
 
             random_scalar_order(&sc[0]);
@@ -3936,7 +4777,7 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
                 secp256k1_ge_neg(&pt[2*i+1], &pt[2*i]);
             }
 
-            CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, sizes[j]));
+            CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, sizes[j]));
             CHECK(secp256k1_gej_is_infinity(&r));
         }
 
@@ -3951,7 +4792,7 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
             secp256k1_scalar_negate(&sc[i], &sc[i]);
         }
 
-        CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, 32));
+        CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, 32));
         CHECK(secp256k1_gej_is_infinity(&r));
     }
 
@@ -3969,8 +4810,8 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
             secp256k1_gej_add_ge_var(&r, &r, &pt[i], NULL);
         }
 
-        secp256k1_ecmult(&r2, &r, &sc[0], &szero);
-        CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, 20));
+        secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &r, &sc[0], &szero);
+        CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, 20));
         secp256k1_gej_neg(&r2, &r2);
         secp256k1_gej_add_var(&r, &r, &r2, NULL);
         CHECK(secp256k1_gej_is_infinity(&r));
@@ -3992,8 +4833,8 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
         }
 
         secp256k1_gej_set_ge(&p0j, &pt[0]);
-        secp256k1_ecmult(&r2, &p0j, &rs, &szero);
-        CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, 20));
+        secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &p0j, &rs, &szero);
+        CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, 20));
         secp256k1_gej_neg(&r2, &r2);
         secp256k1_gej_add_var(&r, &r, &r2, NULL);
         CHECK(secp256k1_gej_is_infinity(&r));
@@ -4006,13 +4847,13 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
     }
 
     secp256k1_scalar_clear(&sc[0]);
-    CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, 20));
+    CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, 20));
     secp256k1_scalar_clear(&sc[1]);
     secp256k1_scalar_clear(&sc[2]);
     secp256k1_scalar_clear(&sc[3]);
     secp256k1_scalar_clear(&sc[4]);
-    CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, 6));
-    CHECK(ecmult_multi(&ctx->error_callback, scratch, &r, &szero, ecmult_multi_callback, &data, 5));
+    CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, 6));
+    CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &szero, ecmult_multi_callback, &data, 5));
     CHECK(secp256k1_gej_is_infinity(&r));
 
     /* Run through s0*(t0*P) + s1*(t1*P) exhaustively for many small values of s0, s1, t0, t1 */
@@ -4036,8 +4877,8 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
                 secp256k1_scalar_set_int(&t1, (t1i + 1) / 2);
                 secp256k1_scalar_cond_negate(&t1, t1i & 1);
 
-                secp256k1_ecmult(&t0p, &ptgj, &t0, &szero);
-                secp256k1_ecmult(&t1p, &ptgj, &t1, &szero);
+                secp256k1_ecmult(&ctx->ecmult_ctx, &t0p, &ptgj, &t0, &szero);
+                secp256k1_ecmult(&ctx->ecmult_ctx, &t1p, &ptgj, &t1, &szero);
 
                 for(s0i = 0; s0i < TOP; s0i++) {
                     for(s1i = 0; s1i < TOP; s1i++) {
@@ -4056,8 +4897,8 @@ void test_ecmult_multi(secp256k1_scratch *scratch, secp256k1_ecmult_multi_func e
                         secp256k1_scalar_mul(&tmp2, &t1, &sc[1]);
                         secp256k1_scalar_add(&tmp1, &tmp1, &tmp2);
 
-                        secp256k1_ecmult(&expected, &ptgj, &tmp1, &szero);
-                        CHECK(ecmult_multi(&ctx->error_callback, scratch, &actual, &szero, ecmult_multi_callback, &data, 2));
+                        secp256k1_ecmult(&ctx->ecmult_ctx, &expected, &ptgj, &tmp1, &szero);
+                        CHECK(ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &actual, &szero, ecmult_multi_callback, &data, 2));
                         secp256k1_gej_neg(&expected, &expected);
                         secp256k1_gej_add_var(&actual, &actual, &expected, NULL);
                         CHECK(secp256k1_gej_is_infinity(&actual));
@@ -4084,33 +4925,40 @@ void test_ecmult_multi_batch_single(secp256k1_ecmult_multi_func ecmult_multi) {
 
     /* Try to multiply 1 point, but scratch space is empty.*/
     scratch_empty = secp256k1_scratch_create(&ctx->error_callback, 0);
-    CHECK(!ecmult_multi(&ctx->error_callback, scratch_empty, &r, &szero, ecmult_multi_callback, &data, 1));
+    CHECK(!ecmult_multi(&ctx->error_callback, &ctx->ecmult_ctx, scratch_empty, &r, &szero, ecmult_multi_callback, &data, 1));
     secp256k1_scratch_destroy(&ctx->error_callback, scratch_empty);
 }
 
-void test_secp256k1_pippenger_bucket_window_inv(void) {
+void test_secp256k1_pippenger_bucket_window_inv(const secp256k1_ecmult_multi_profile *profile) {
     int i;
 
-    CHECK(secp256k1_pippenger_bucket_window_inv(0) == 0);
+    CHECK(secp256k1_pippenger_bucket_window_inv(profile, 0) == 0);
+    CHECK(secp256k1_pippenger_bucket_window_inv(profile, PIPPENGER_MAX_BUCKET_WINDOW + 1) == 0);
     for(i = 1; i <= PIPPENGER_MAX_BUCKET_WINDOW; i++) {
-        /* Bucket_window of 8 is not used with endo */
-        if (i == 8) {
+        /* Skip bucket windows which are never used, such as 8 in the
+         * default profile */
+        if (i > 1 && secp256k1_pippenger_bucket_window_inv(profile, i) == secp256k1_pippenger_bucket_window_inv(profile, i - 1)) {
             continue;
         }
-        CHECK(secp256k1_pippenger_bucket_window(secp256k1_pippenger_bucket_window_inv(i)) == i);
+        CHECK(secp256k1_pippenger_bucket_window(profile, secp256k1_pippenger_bucket_window_inv(profile, i)) == i);
         if (i != PIPPENGER_MAX_BUCKET_WINDOW) {
-            CHECK(secp256k1_pippenger_bucket_window(secp256k1_pippenger_bucket_window_inv(i)+1) > i);
+            CHECK(secp256k1_pippenger_bucket_window(profile, secp256k1_pippenger_bucket_window_inv(profile, i)+1) > i);
         }
     }
+    CHECK(secp256k1_pippenger_bucket_window_inv(profile, PIPPENGER_MAX_BUCKET_WINDOW) == SIZE_MAX);
 }
 
 /**
  * Probabilistically test the function returning the maximum number of possible points
  * for a given scratch space.
  */
-void test_ecmult_multi_pippenger_max_points(void) {
+void test_ecmult_multi_pippenger_max_points(int affine) {
+    const secp256k1_ecmult_multi_profile *profile = &ctx->ecmult_ctx.multi;
+    size_t (*scratch_size_fn)(size_t, int) = affine ? secp256k1_pippenger_affine_scratch_size : secp256k1_pippenger_scratch_size;
+    size_t (*max_points_fn)(const secp256k1_callback*, const secp256k1_ecmult_multi_profile*, secp256k1_scratch*) = affine ? secp256k1_pippenger_affine_max_points : secp256k1_pippenger_max_points;
+    size_t n_objects = affine ? PIPPENGER_AFFINE_SCRATCH_OBJECTS : PIPPENGER_SCRATCH_OBJECTS;
     size_t scratch_size = secp256k1_testrand_int(256);
-    size_t max_size = secp256k1_pippenger_scratch_size(secp256k1_pippenger_bucket_window_inv(PIPPENGER_MAX_BUCKET_WINDOW-1)+512, 12);
+    size_t max_size = scratch_size_fn(secp256k1_pippenger_bucket_window_inv(profile, PIPPENGER_MAX_BUCKET_WINDOW-1)+512, 12);
     secp256k1_scratch *scratch;
     size_t n_points_supported;
     int bucket_window = 0;
@@ -4122,15 +4970,15 @@ void test_ecmult_multi_pippenger_max_points(void) {
         scratch = secp256k1_scratch_create(&ctx->error_callback, scratch_size);
         CHECK(scratch != NULL);
         checkpoint = secp256k1_scratch_checkpoint(&ctx->error_callback, scratch);
-        n_points_supported = secp256k1_pippenger_max_points(&ctx->error_callback, scratch);
+        n_points_supported = max_points_fn(&ctx->error_callback, profile, scratch);
         if (n_points_supported == 0) {
             secp256k1_scratch_destroy(&ctx->error_callback, scratch);
             continue;
         }
-        bucket_window = secp256k1_pippenger_bucket_window(n_points_supported);
-        /* allocate `total_alloc` bytes over `PIPPENGER_SCRATCH_OBJECTS` many allocations */
-        total_alloc = secp256k1_pippenger_scratch_size(n_points_supported, bucket_window);
-        for (i = 0; i < PIPPENGER_SCRATCH_OBJECTS - 1; i++) {
+        bucket_window = secp256k1_pippenger_bucket_window(profile, n_points_supported);
+        /* allocate `total_alloc` bytes over `n_objects` many allocations */
+        total_alloc = scratch_size_fn(n_points_supported, bucket_window);
+        for (i = 0; i < n_objects - 1; i++) {
             CHECK(secp256k1_scratch_alloc(&ctx->error_callback, scratch, 1));
             total_alloc--;
         }
@@ -4206,7 +5054,7 @@ void test_ecmult_multi_batching(void) {
 
     /* Get random scalars and group elements and compute result */
     random_scalar_order(&scG);
-    secp256k1_ecmult(&r2, &r2, &szero, &scG);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &r2, &szero, &scG);
     for(i = 0; i < n_points; i++) {
         secp256k1_ge ptg;
         secp256k1_gej ptgj;
@@ -4214,7 +5062,7 @@ void test_ecmult_multi_batching(void) {
         secp256k1_gej_set_ge(&ptgj, &ptg);
         pt[i] = ptg;
         random_scalar_order(&sc[i]);
-        secp256k1_ecmult(&ptgj, &ptgj, &sc[i], NULL);
+        secp256k1_ecmult(&ctx->ecmult_ctx, &ptgj, &ptgj, &sc[i], NULL);
         secp256k1_gej_add_var(&r2, &r2, &ptgj, NULL);
     }
     data.sc = sc;
@@ -4224,7 +5072,7 @@ void test_ecmult_multi_batching(void) {
     /* Test with empty scratch space. It should compute the correct result using
      * ecmult_mult_simple algorithm which doesn't require a scratch space. */
     scratch = secp256k1_scratch_create(&ctx->error_callback, 0);
-    CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
+    CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
     secp256k1_gej_add_var(&r, &r, &r2, NULL);
     CHECK(secp256k1_gej_is_infinity(&r));
     secp256k1_scratch_destroy(&ctx->error_callback, scratch);
@@ -4233,21 +5081,21 @@ void test_ecmult_multi_batching(void) {
      * ecmult_multi selects strauss which requires more memory. It should
      * therefore select the simple algorithm. */
     scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_pippenger_scratch_size(1, 1) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
-    CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
+    CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
     secp256k1_gej_add_var(&r, &r, &r2, NULL);
     CHECK(secp256k1_gej_is_infinity(&r));
     secp256k1_scratch_destroy(&ctx->error_callback, scratch);
 
     for(i = 1; i <= n_points; i++) {
         if (i > ECMULT_PIPPENGER_THRESHOLD) {
-            int bucket_window = secp256k1_pippenger_bucket_window(i);
+            int bucket_window = secp256k1_pippenger_bucket_window(&ctx->ecmult_ctx.multi, i);
             size_t scratch_size = secp256k1_pippenger_scratch_size(i, bucket_window);
             scratch = secp256k1_scratch_create(&ctx->error_callback, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
         } else {
             size_t scratch_size = secp256k1_strauss_scratch_size(i);
             scratch = secp256k1_scratch_create(&ctx->error_callback, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
         }
-        CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
+        CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, n_points));
         secp256k1_gej_add_var(&r, &r, &r2, NULL);
         CHECK(secp256k1_gej_is_infinity(&r));
         secp256k1_scratch_destroy(&ctx->error_callback, scratch);
@@ -4256,18 +5104,193 @@ void test_ecmult_multi_batching(void) {
     free(pt);
 }
 
+/**
+ * Run secp256k1_ecmult_multi_var_parallel with various numbers of tasks and
+ * scratch space sizes.
+ */
+void test_ecmult_multi_parallel(void) {
+    static const size_t n_points = 4*ECMULT_PIPPENGER_THRESHOLD;
+    secp256k1_scalar scG;
+    secp256k1_scalar szero;
+    secp256k1_scalar *sc = (secp256k1_scalar *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_scalar) * n_points);
+    secp256k1_ge *pt = (secp256k1_ge *)checked_malloc(&ctx->error_callback, sizeof(secp256k1_ge) * n_points);
+    secp256k1_gej r;
+    secp256k1_gej r2;
+    ecmult_multi_data data;
+    size_t i, n_tasks;
+    size_t n_dispatched;
+    secp256k1_scratch *scratch;
+    secp256k1_scratch *scratch_small;
+
+    secp256k1_gej_set_infinity(&r2);
+    secp256k1_scalar_set_int(&szero, 0);
+    random_scalar_order(&scG);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &r2, &r2, &szero, &scG);
+    for(i = 0; i < n_points; i++) {
+        secp256k1_gej ptgj;
+        random_group_element_test(&pt[i]);
+        random_scalar_order(&sc[i]);
+        secp256k1_gej_set_ge(&ptgj, &pt[i]);
+        secp256k1_ecmult(&ctx->ecmult_ctx, &ptgj, &ptgj, &sc[i], NULL);
+        secp256k1_gej_add_var(&r2, &r2, &ptgj, NULL);
+    }
+    data.sc = sc;
+    data.pt = pt;
+    secp256k1_gej_neg(&r2, &r2);
+
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_pippenger_scratch_size(n_points, secp256k1_pippenger_bucket_window(&ctx->ecmult_ctx.multi, n_points)) + 16*PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
+    /* Space for the task state but not for a single point per task */
+    scratch_small = secp256k1_scratch_create(&ctx->error_callback, 16*(sizeof(secp256k1_scratch) + sizeof(secp256k1_gej) + sizeof(int) + 3*ALIGNMENT));
+    for (n_tasks = 0; n_tasks <= 16; n_tasks++) {
+        n_dispatched = 0;
+        CHECK(secp256k1_ecmult_multi_var_parallel(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, n_points, ecmult_multi_test_dispatch, &n_dispatched, n_tasks));
+        CHECK(n_dispatched == (n_tasks < 2 ? 0 : n_tasks));
+        CHECK(secp256k1_scratch_checkpoint(&ctx->error_callback, scratch) == 0);
+        secp256k1_gej_add_var(&r, &r, &r2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&r));
+
+        n_dispatched = 0;
+        CHECK(secp256k1_ecmult_multi_var_parallel(&ctx->error_callback, &ctx->ecmult_ctx, scratch_small, &r, &scG, ecmult_multi_callback, &data, n_points, ecmult_multi_test_dispatch, &n_dispatched, n_tasks));
+        CHECK(n_dispatched == (n_tasks < 2 ? 0 : n_tasks));
+        secp256k1_gej_add_var(&r, &r, &r2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&r));
+
+        /* Without scratch space the tasks are not dispatched */
+        n_dispatched = 0;
+        CHECK(secp256k1_ecmult_multi_var_parallel(&ctx->error_callback, &ctx->ecmult_ctx, NULL, &r, &scG, ecmult_multi_callback, &data, n_points, ecmult_multi_test_dispatch, &n_dispatched, n_tasks));
+        CHECK(n_dispatched == 0);
+        secp256k1_gej_add_var(&r, &r, &r2, NULL);
+        CHECK(secp256k1_gej_is_infinity(&r));
+
+        if (n_tasks > 0) {
+            CHECK(!secp256k1_ecmult_multi_var_parallel(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_false_callback, &data, n_points, ecmult_multi_test_dispatch, &n_dispatched, n_tasks));
+        }
+    }
+    /* More tasks than points */
+    n_dispatched = 0;
+    CHECK(secp256k1_ecmult_multi_var_parallel(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r, &scG, ecmult_multi_callback, &data, 3, ecmult_multi_test_dispatch, &n_dispatched, 8));
+    CHECK(n_dispatched == 3);
+    CHECK(secp256k1_ecmult_multi_var(&ctx->error_callback, &ctx->ecmult_ctx, scratch, &r2, &scG, ecmult_multi_callback, &data, 3));
+    secp256k1_gej_neg(&r2, &r2);
+    secp256k1_gej_add_var(&r, &r, &r2, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r));
+
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch_small);
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    free(sc);
+    free(pt);
+}
+
+/* Serializes profile like "bench_ecmult calibrate" does. */
+static void ecmult_multi_profile_serialize(unsigned char *out, const secp256k1_ecmult_multi_profile *profile) {
+    size_t counts[2 + PIPPENGER_MAX_BUCKET_WINDOW];
+    int i;
+
+    counts[0] = profile->pippenger_threshold;
+    counts[1] = profile->affine_threshold;
+    memcpy(&counts[2], profile->bucket_window_max_points, sizeof(profile->bucket_window_max_points));
+    memset(out, 0, ECMULT_MULTI_PROFILE_SIZE);
+    memcpy(out, ECMULT_MULTI_PROFILE_MAGIC, 8);
+    out[11] = ECMULT_MULTI_PROFILE_VERSION;
+    out[15] = PIPPENGER_MAX_BUCKET_WINDOW;
+    for (i = 0; i < 2 + PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        uint32_t x = counts[i] == SIZE_MAX ? 0xffffffff : (uint32_t)counts[i];
+        out[16 + 4*i] = x >> 24;
+        out[17 + 4*i] = x >> 16;
+        out[18 + 4*i] = x >> 8;
+        out[19 + 4*i] = x;
+    }
+}
+
+/* Checks that loading fails and leaves the context unchanged. */
+static void test_ecmult_multi_profile_invalid(secp256k1_context *tctx, const unsigned char *profile, size_t len) {
+    secp256k1_ecmult_multi_profile before = tctx->ecmult_ctx.multi;
+    CHECK(secp256k1_context_set_ecmult_multi_profile(tctx, profile, len) == 0);
+    CHECK(secp256k1_memcmp_var(&before, &tctx->ecmult_ctx.multi, sizeof(before)) == 0);
+}
+
+void test_ecmult_multi_profile(void) {
+    static const secp256k1_ecmult_multi_profile default_profile = ECMULT_MULTI_PROFILE_DEFAULT;
+    secp256k1_ecmult_multi_profile profile;
+    unsigned char out[ECMULT_MULTI_PROFILE_SIZE + 1];
+    secp256k1_context *tctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *clone;
+    secp256k1_scratch *scratch;
+    int ecount = 0;
+    size_t i;
+
+    CHECK(secp256k1_memcmp_var(&tctx->ecmult_ctx.multi, &default_profile, sizeof(default_profile)) == 0);
+
+    /* Random profile with small thresholds, so that ecmult_multi tries all
+     * algorithms with unusual bucket windows */
+    profile.pippenger_threshold = 1 + secp256k1_testrand_int(40);
+    profile.affine_threshold = secp256k1_testrand_int(4) == 0 ? SIZE_MAX : 1 + secp256k1_testrand_int(40);
+    profile.bucket_window_max_points[0] = secp256k1_testrand_int(4);
+    for (i = 1; i < PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        profile.bucket_window_max_points[i] = profile.bucket_window_max_points[i - 1] + secp256k1_testrand_int(8);
+    }
+    profile.bucket_window_max_points[PIPPENGER_MAX_BUCKET_WINDOW - 1] = SIZE_MAX;
+    ecmult_multi_profile_serialize(out, &profile);
+
+    /* Invalid profiles */
+    for (i = 0; i < 20; i++) {
+        size_t idx = secp256k1_testrand_int(16);
+        unsigned char flip = 1 << secp256k1_testrand_int(8);
+        out[idx] ^= flip;
+        test_ecmult_multi_profile_invalid(tctx, out, ECMULT_MULTI_PROFILE_SIZE);
+        out[idx] ^= flip;
+    }
+    test_ecmult_multi_profile_invalid(tctx, out, ECMULT_MULTI_PROFILE_SIZE - 1);
+    test_ecmult_multi_profile_invalid(tctx, out, ECMULT_MULTI_PROFILE_SIZE + 1);
+    test_ecmult_multi_profile_invalid(tctx, out, 0);
+    /* The last bucket window must be used for any number of points */
+    out[ECMULT_MULTI_PROFILE_SIZE - 1] = 0xfe;
+    test_ecmult_multi_profile_invalid(tctx, out, ECMULT_MULTI_PROFILE_SIZE);
+    out[ECMULT_MULTI_PROFILE_SIZE - 1] = 0xff;
+    /* Bucket windows must not decrease */
+    out[27] = 0xff;
+    test_ecmult_multi_profile_invalid(tctx, out, ECMULT_MULTI_PROFILE_SIZE);
+    out[27] = profile.bucket_window_max_points[0];
+
+    secp256k1_context_set_illegal_callback(tctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_context_set_ecmult_multi_profile(tctx, NULL, ECMULT_MULTI_PROFILE_SIZE) == 0);
+    CHECK(ecount == 1);
+    secp256k1_context_set_illegal_callback(tctx, NULL, NULL);
+
+    /* Valid profiles are copied, also by clones */
+    CHECK(secp256k1_context_set_ecmult_multi_profile(tctx, out, ECMULT_MULTI_PROFILE_SIZE) == 1);
+    memset(out, 0, sizeof(out));
+    clone = secp256k1_context_clone(tctx);
+    secp256k1_context_destroy(tctx);
+    CHECK(secp256k1_memcmp_var(&clone->ecmult_ctx.multi, &profile, sizeof(profile)) == 0);
+    test_secp256k1_pippenger_bucket_window_inv(&profile);
+
+    /* ecmult_multi is correct with the profile */
+    scratch = secp256k1_scratch_create(&ctx->error_callback, 819200);
+    ctx->ecmult_ctx.multi = profile;
+    test_ecmult_multi(scratch, secp256k1_ecmult_multi_var);
+    test_ecmult_multi_batching();
+    ctx->ecmult_ctx.multi = default_profile;
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    secp256k1_context_destroy(clone);
+}
+
 void run_ecmult_multi_tests(void) {
     secp256k1_scratch *scratch;
 
-    test_secp256k1_pippenger_bucket_window_inv();
-    test_ecmult_multi_pippenger_max_points();
+    test_secp256k1_pippenger_bucket_window_inv(&ctx->ecmult_ctx.multi);
+    test_ecmult_multi_pippenger_max_points(0);
+    test_ecmult_multi_pippenger_max_points(1);
     scratch = secp256k1_scratch_create(&ctx->error_callback, 819200);
     test_ecmult_multi(scratch, secp256k1_ecmult_multi_var);
     test_ecmult_multi(NULL, secp256k1_ecmult_multi_var);
     test_ecmult_multi(scratch, secp256k1_ecmult_pippenger_batch_single);
     test_ecmult_multi_batch_single(secp256k1_ecmult_pippenger_batch_single);
+    test_ecmult_multi(scratch, secp256k1_ecmult_pippenger_affine_batch_single);
+    test_ecmult_multi_batch_single(secp256k1_ecmult_pippenger_affine_batch_single);
     test_ecmult_multi(scratch, secp256k1_ecmult_strauss_batch_single);
     test_ecmult_multi_batch_single(secp256k1_ecmult_strauss_batch_single);
+    test_ecmult_multi(scratch, ecmult_multi_parallel_4);
     secp256k1_scratch_destroy(&ctx->error_callback, scratch);
 
     /* Run test_ecmult_multi with space for exactly one point */
@@ -4277,6 +5300,8 @@ void run_ecmult_multi_tests(void) {
 
     test_ecmult_multi_batch_size_helper();
     test_ecmult_multi_batching();
+    test_ecmult_multi_parallel();
+    test_ecmult_multi_profile();
 }
 
 void test_wnaf(const secp256k1_scalar *number, int w) {
@@ -4561,6 +5586,7 @@ void test_ecmult_gen_blind(void) {
     secp256k1_gej pgej2;
     secp256k1_gej i;
     secp256k1_ge pge;
+    int j;
     random_scalar_order_test(&key);
     secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pgej, &key);
     secp256k1_testrand256(seed32);
@@ -4573,6 +5599,17 @@ void test_ecmult_gen_blind(void) {
     CHECK(!gej_xyz_equals_gej(&i, &ctx->ecmult_gen_ctx.initial));
     secp256k1_ge_set_gej(&pge, &pgej);
     ge_equals_gej(&pge, &pgej2);
+    /* The initial point turns into (offset - blind)*G after the doublings of the comb. */
+    i = ctx->ecmult_gen_ctx.initial;
+    for (j = 1; j < ECMULT_GEN_COMB_SPACING; j++) {
+        secp256k1_gej_double_var(&i, &i, NULL);
+    }
+    secp256k1_ecmult_gen_comb_offset(&b);
+    secp256k1_scalar_negate(&key, &ctx->ecmult_gen_ctx.blind);
+    secp256k1_scalar_add(&b, &b, &key);
+    secp256k1_ecmult(&ctx->ecmult_ctx, &pgej, &pgej2, &secp256k1_scalar_zero, &b);
+    secp256k1_ge_set_gej(&pge, &pgej);
+    ge_equals_gej(&pge, &i);
 }
 
 void test_ecmult_gen_blind_reset(void) {
@@ -5366,10 +6403,10 @@ void test_ecdsa_sign_verify(void) {
     } else {
         random_sign(&sigr, &sigs, &key, &msg, NULL);
     }
-    CHECK(secp256k1_ecdsa_sig_verify(&sigr, &sigs, &pub, &msg));
+    CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sigr, &sigs, &pub, &msg));
     secp256k1_scalar_set_int(&one, 1);
     secp256k1_scalar_add(&msg, &msg, &one);
-    CHECK(!secp256k1_ecdsa_sig_verify(&sigr, &sigs, &pub, &msg));
+    CHECK(!secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sigr, &sigs, &pub, &msg));
 }
 
 void run_ecdsa_sign_verify(void) {
@@ -5379,6 +6416,213 @@ void run_ecdsa_sign_verify(void) {
     }
 }
 
+/* Creates a random number of signatures with and without recovery ids and
+ * checks that batch verification agrees with individual verification. */
+#define N_SIGS 64
+void test_ecdsa_verify_batch(void) {
+    secp256k1_ecdsa_signature sig[N_SIGS];
+    secp256k1_pubkey pubkey[N_SIGS];
+    unsigned char msg[N_SIGS][32];
+    int recid[N_SIGS];
+    const secp256k1_ecdsa_signature *sig_ptr[N_SIGS];
+    const secp256k1_pubkey *pubkey_ptr[N_SIGS];
+    const unsigned char *msg_ptr[N_SIGS];
+    size_t n_sigs = 1 + secp256k1_testrand_int(N_SIGS);
+    size_t i;
+    size_t idx;
+    int ecount = 0;
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(ctx, 1024 * 256);
+
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    for (i = 0; i < n_sigs; i++) {
+        unsigned char key[32];
+        secp256k1_scalar r, s;
+        random_scalar_order_b32(key);
+        secp256k1_testrand256(msg[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[i], key) == 1);
+        CHECK(secp256k1_ecdsa_sign_inner(ctx, &r, &s, &recid[i], msg[i], key, NULL, NULL) == 1);
+        secp256k1_ecdsa_signature_save(&sig[i], &r, &s);
+        if (secp256k1_testrand_bits(2) == 0) {
+            recid[i] = -1;
+        }
+        sig_ptr[i] = &sig[i];
+        pubkey_ptr[i] = &pubkey[i];
+        msg_ptr[i] = msg[i];
+    }
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 1);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, NULL, msg_ptr, pubkey_ptr, n_sigs) == 1);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK(ecount == 0);
+
+    /* The randomizers commit to the recovery ids, which choose between R and
+     * -R, and to which signatures are batched */
+    {
+        unsigned char seed[3][32];
+        secp256k1_scalar a[3][2];
+        int recid_orig;
+        int k;
+        idx = secp256k1_testrand_int(n_sigs);
+        recid_orig = recid[idx];
+        for (k = 0; k < 3; k++) {
+            recid[idx] = k - 1;
+            CHECK(secp256k1_ecdsa_verify_batch_seed(ctx, seed[k], sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 1);
+            secp256k1_verify_batch_randomizers(a[k], seed[k], 0, 2);
+        }
+        for (k = 0; k < 3; k++) {
+            CHECK(secp256k1_memcmp_var(seed[k], seed[(k + 1) % 3], 32) != 0);
+            CHECK(!secp256k1_scalar_eq(&a[k][1], &a[(k + 1) % 3][1]));
+        }
+        recid[idx] = recid_orig;
+    }
+
+    /* A wrong recovery id does not make a valid signature fail */
+    idx = secp256k1_testrand_int(n_sigs);
+    recid[idx] = (recid[idx] + 1) & 1;
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 1);
+    recid[idx] = 2;
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 1);
+
+    /* But a wrong message does, whether it has a recovery id or not */
+    msg[idx][0] ^= 1;
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 0);
+    recid[idx] = -1;
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 0);
+    msg[idx][0] ^= 1;
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 1);
+
+    /* High-S signatures are rejected like in secp256k1_ecdsa_verify */
+    {
+        secp256k1_ecdsa_signature sig_high;
+        secp256k1_scalar r, s;
+        secp256k1_ecdsa_signature_load(ctx, &r, &s, &sig[idx]);
+        secp256k1_scalar_negate(&s, &s);
+        secp256k1_ecdsa_signature_save(&sig_high, &r, &s);
+        sig_ptr[idx] = &sig_high;
+        CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 0);
+        sig_ptr[idx] = &sig[idx];
+    }
+
+    /* Illegal arguments */
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, NULL, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, NULL, recid, msg_ptr, pubkey_ptr, n_sigs) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, NULL, pubkey_ptr, n_sigs) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, NULL, n_sigs) == 0);
+    CHECK(ecount == 4);
+    recid[idx] = 4;
+    CHECK(secp256k1_ecdsa_verify_batch(ctx, scratch, sig_ptr, recid, msg_ptr, pubkey_ptr, n_sigs) == 0);
+    CHECK(ecount == 5);
+
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_scratch_space_destroy(ctx, scratch);
+}
+#undef N_SIGS
+
+/* Checks the randomizers derived for a block of signatures against their definition. */
+void test_verify_batch_randomizers(void) {
+    secp256k1_scalar a[VERIFY_BATCH_BLOCK], expected;
+    unsigned char seed[32], buf[40], hash[32];
+    secp256k1_sha256 sha;
+    size_t idx = secp256k1_testrand_bits(1) ? 0 : secp256k1_testrand_int(1000);
+    size_t n = secp256k1_testrand_int(VERIFY_BATCH_BLOCK + 1);
+    size_t i;
+    int j;
+
+    secp256k1_testrand256(seed);
+    secp256k1_verify_batch_randomizers(a, seed, idx, n);
+    for (i = 0; i < n; i++) {
+        if (idx + i == 0) {
+            CHECK(secp256k1_scalar_is_one(&a[i]));
+            continue;
+        }
+        memcpy(buf, seed, 32);
+        for (j = 0; j < 8; j++) {
+            buf[32 + j] = ((uint64_t)(idx + i) >> (56 - 8*j)) & 0xFF;
+        }
+        secp256k1_sha256_initialize(&sha);
+        secp256k1_sha256_write(&sha, buf, sizeof(buf));
+        secp256k1_sha256_finalize(&sha, hash);
+        secp256k1_scalar_set_b32(&expected, hash, NULL);
+        CHECK(secp256k1_scalar_eq(&a[i], &expected));
+    }
+}
+
+void run_ecdsa_verify_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_verify_batch_randomizers();
+        test_ecdsa_verify_batch();
+    }
+}
+
+void test_ecdsa_verify_precomp(void) {
+    secp256k1_ecdsa_signature sig, sig_high;
+    secp256k1_pubkey pubkey;
+    secp256k1_pubkey_precomp *precomp;
+    unsigned char key[32];
+    unsigned char msg[32];
+    secp256k1_scalar r, s;
+    int window = 2 + secp256k1_testrand_int(11);
+    int ecount = 0;
+
+    random_scalar_order_b32(key);
+    secp256k1_testrand256(msg);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, key) == 1);
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, key, NULL, NULL) == 1);
+    precomp = secp256k1_pubkey_precomp_create(ctx, &pubkey, window);
+    CHECK(precomp != NULL);
+
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == 1);
+    msg[secp256k1_testrand_int(32)] ^= 1 << secp256k1_testrand_int(8);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == secp256k1_ecdsa_verify(ctx, &sig, msg, &pubkey));
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == 0);
+
+    /* High-S signatures are rejected like in secp256k1_ecdsa_verify */
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, key, NULL, NULL) == 1);
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, &sig);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecdsa_signature_save(&sig_high, &r, &s);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig_high, msg, precomp) == 0);
+    CHECK(secp256k1_ecdsa_signature_normalize(ctx, &sig, &sig_high) == 1);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == 1);
+
+    /* Signatures by other keys are rejected */
+    random_scalar_order_b32(key);
+    CHECK(secp256k1_ecdsa_sign(ctx, &sig, msg, key, NULL, NULL) == 1);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, precomp) == 0);
+
+    /* Illegal arguments */
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, NULL, msg, precomp) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, NULL, precomp) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_verify_precomp(ctx, &sig, msg, NULL) == 0);
+    CHECK(ecount == 3);
+    CHECK(secp256k1_pubkey_precomp_create(ctx, NULL, window) == NULL);
+    CHECK(ecount == 4);
+    CHECK(secp256k1_pubkey_precomp_create(ctx, &pubkey, 1) == NULL);
+    CHECK(ecount == 5);
+    CHECK(secp256k1_pubkey_precomp_create(ctx, &pubkey, SECP256K1_PUBKEY_PRECOMP_MAX_WINDOW + 1) == NULL);
+    CHECK(ecount == 6);
+    memset(&pubkey, 0, sizeof(pubkey));
+    CHECK(secp256k1_pubkey_precomp_create(ctx, &pubkey, window) == NULL);
+    CHECK(ecount == 7);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+
+    secp256k1_pubkey_precomp_destroy(ctx, precomp);
+    secp256k1_pubkey_precomp_destroy(ctx, NULL);
+}
+
+void run_ecdsa_verify_precomp(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecdsa_verify_precomp();
+    }
+}
+
 /** Dummy nonce generation function that just uses a precomputed nonce, and fails if it is not accepted. Use only for testing. */
 static int precomputed_nonce_function(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, void *data, unsigned int counter) {
     (void)msg32;
@@ -5431,6 +6675,127 @@ int is_empty_signature(const secp256k1_ecdsa_signature *sig) {
     return secp256k1_memcmp_var(sig, res, sizeof(secp256k1_ecdsa_signature)) == 0;
 }
 
+#define N_BATCH_SIGS 40
+/* Records, for every message, the counters nonce_function_test_log is
+ * called with. */
+typedef struct {
+    unsigned char (*msgs)[32];
+    size_t n;
+    int n_calls[N_BATCH_SIGS];
+    unsigned int counters[N_BATCH_SIGS][8];
+} nonce_function_log;
+
+static int nonce_function_test_log(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, void *data, unsigned int counter) {
+    nonce_function_log *log = (nonce_function_log *)data;
+    size_t i;
+    for (i = 0; i < log->n; i++) {
+        if (secp256k1_memcmp_var(msg32, log->msgs[i], 32) == 0) {
+            CHECK(log->n_calls[i] < 8);
+            log->counters[i][log->n_calls[i]++] = counter;
+        }
+    }
+    return nonce_function_test_retry(nonce32, msg32, key32, algo16, NULL, counter);
+}
+
+void test_ecdsa_sign_batch(void) {
+    secp256k1_ecdsa_signature sigs[N_BATCH_SIGS];
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    unsigned char msgs[N_BATCH_SIGS][32];
+    const unsigned char *msg_ptr[N_BATCH_SIGS];
+    unsigned char key[32];
+    unsigned char extra[32];
+    const secp256k1_nonce_function noncefps[3] = { NULL, nonce_function_rfc6979, nonce_function_test_retry };
+    secp256k1_context *none = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    size_t n = secp256k1_testrand_int(N_BATCH_SIGS + 1);
+    size_t i;
+    int f;
+    int ecount = 0;
+
+    random_scalar_order_b32(key);
+    secp256k1_testrand256(extra);
+    CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey, key) == 1);
+    for (i = 0; i < n; i++) {
+        secp256k1_testrand256(msgs[i]);
+        msg_ptr[i] = msgs[i];
+    }
+
+    /* Batch signing creates the same signatures as signing individually,
+     * including when the first nonce is rejected. */
+    for (f = 0; f < 3; f++) {
+        const void *ndata = secp256k1_testrand_bits(1) ? extra : NULL;
+        CHECK(secp256k1_ecdsa_sign_batch(ctx, sigs, msg_ptr, n, key, noncefps[f], ndata) == 1);
+        for (i = 0; i < n; i++) {
+            CHECK(secp256k1_ecdsa_sign(ctx, &sig, msgs[i], key, noncefps[f], ndata) == 1);
+            CHECK(secp256k1_memcmp_var(&sig, &sigs[i], sizeof(sig)) == 0);
+            CHECK(secp256k1_ecdsa_verify(ctx, &sigs[i], msgs[i], &pubkey) == 1);
+        }
+    }
+
+    /* The nonce function is called with the same counters for every message */
+    {
+        nonce_function_log log_batch, log_single;
+        memset(&log_batch, 0, sizeof(log_batch));
+        log_batch.msgs = msgs;
+        log_batch.n = n;
+        log_single = log_batch;
+        CHECK(secp256k1_ecdsa_sign_batch(ctx, sigs, msg_ptr, n, key, nonce_function_test_log, &log_batch) == 1);
+        for (i = 0; i < n; i++) {
+            CHECK(secp256k1_ecdsa_sign(ctx, &sig, msgs[i], key, nonce_function_test_log, &log_single) == 1);
+            CHECK(secp256k1_memcmp_var(&sig, &sigs[i], sizeof(sig)) == 0);
+        }
+        CHECK(memcmp(log_batch.n_calls, log_single.n_calls, sizeof(log_batch.n_calls)) == 0);
+        CHECK(memcmp(log_batch.counters, log_single.counters, sizeof(log_batch.counters)) == 0);
+    }
+
+    /* Failing nonce functions and invalid keys produce empty signatures */
+    if (n > 0) {
+        unsigned char nonce[32];
+        memset(nonce, 0, sizeof(nonce));
+        CHECK(secp256k1_ecdsa_sign_batch(ctx, sigs, msg_ptr, n, key, precomputed_nonce_function, nonce) == 0);
+        for (i = 0; i < n; i++) {
+            CHECK(is_empty_signature(&sigs[i]));
+        }
+        CHECK(secp256k1_ecdsa_sign_batch(ctx, sigs, msg_ptr, n, key, nonce_function_test_fail, NULL) == 0);
+        for (i = 0; i < n; i++) {
+            CHECK(is_empty_signature(&sigs[i]));
+        }
+        memset(key, 0, sizeof(key));
+        CHECK(secp256k1_ecdsa_sign_batch(ctx, sigs, msg_ptr, n, key, NULL, NULL) == 0);
+        for (i = 0; i < n; i++) {
+            CHECK(is_empty_signature(&sigs[i]));
+        }
+    }
+
+    /* Illegal arguments */
+    random_scalar_order_b32(key);
+    secp256k1_context_set_illegal_callback(ctx, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, NULL, NULL, 0, key, NULL, NULL) == 1);
+    CHECK(ecount == 0);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, NULL, msg_ptr, 1, key, NULL, NULL) == 0);
+    CHECK(ecount == 1);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, sigs, NULL, 1, key, NULL, NULL) == 0);
+    CHECK(ecount == 2);
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, sigs, msg_ptr, 0, NULL, NULL, NULL) == 0);
+    CHECK(ecount == 3);
+    msg_ptr[0] = NULL;
+    CHECK(secp256k1_ecdsa_sign_batch(ctx, sigs, msg_ptr, 1, key, NULL, NULL) == 0);
+    CHECK(ecount == 4);
+    secp256k1_context_set_illegal_callback(ctx, NULL, NULL);
+    secp256k1_context_set_illegal_callback(none, counting_illegal_callback_fn, &ecount);
+    CHECK(secp256k1_ecdsa_sign_batch(none, sigs, msg_ptr, 0, key, NULL, NULL) == 0);
+    CHECK(ecount == 5);
+    secp256k1_context_destroy(none);
+}
+#undef N_BATCH_SIGS
+
+void run_ecdsa_sign_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecdsa_sign_batch();
+    }
+}
+
 void test_ecdsa_end_to_end(void) {
     unsigned char extra[32] = {0x00};
     unsigned char privkey[32];
@@ -6047,7 +7412,7 @@ void test_ecdsa_edge_cases(void) {
         secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &keyj, &sr);
         secp256k1_ge_set_gej(&key, &keyj);
         msg = ss;
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 0);
     }
 
     /* Verify signature with r of zero fails. */
@@ -6066,7 +7431,7 @@ void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_set_int(&msg, 0);
         secp256k1_scalar_set_int(&sr, 0);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey_mods_zero, 33));
-        CHECK(secp256k1_ecdsa_sig_verify( &sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 0);
     }
 
     /* Verify signature with s of zero fails. */
@@ -6085,7 +7450,7 @@ void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_set_int(&msg, 0);
         secp256k1_scalar_set_int(&sr, 1);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey, 33));
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 0);
     }
 
     /* Verify signature with message 0 passes. */
@@ -6113,14 +7478,14 @@ void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_set_int(&sr, 2);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey, 33));
         CHECK(secp256k1_eckey_pubkey_parse(&key2, pubkey2, 33));
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key2, &msg) == 1);
         secp256k1_scalar_negate(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key2, &msg) == 1);
         secp256k1_scalar_set_int(&ss, 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key2, &msg) == 0);
     }
 
     /* Verify signature with message 1 passes. */
@@ -6154,15 +7519,15 @@ void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_set_b32(&sr, csr, NULL);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey, 33));
         CHECK(secp256k1_eckey_pubkey_parse(&key2, pubkey2, 33));
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key2, &msg) == 1);
         secp256k1_scalar_negate(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key2, &msg) == 1);
         secp256k1_scalar_set_int(&ss, 2);
         secp256k1_scalar_inverse_var(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key2, &msg) == 0);
     }
 
     /* Verify signature with message -1 passes. */
@@ -6188,12 +7553,12 @@ void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_negate(&msg, &msg);
         secp256k1_scalar_set_b32(&sr, csr, NULL);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey, 33));
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 1);
         secp256k1_scalar_negate(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 1);
         secp256k1_scalar_set_int(&ss, 3);
         secp256k1_scalar_inverse_var(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sr, &ss, &key, &msg) == 0);
     }
 
     /* Signature where s would be zero. */
@@ -6439,10 +7804,10 @@ void test_ecdsa_openssl(void) {
     CHECK(ec_key != NULL);
     CHECK(ECDSA_sign(0, message, sizeof(message), signature, &sigsize, ec_key));
     CHECK(secp256k1_ecdsa_sig_parse(&sigr, &sigs, signature, sigsize));
-    CHECK(secp256k1_ecdsa_sig_verify(&sigr, &sigs, &q, &msg));
+    CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sigr, &sigs, &q, &msg));
     secp256k1_scalar_set_int(&one, 1);
     secp256k1_scalar_add(&msg2, &msg, &one);
-    CHECK(!secp256k1_ecdsa_sig_verify(&sigr, &sigs, &q, &msg2));
+    CHECK(!secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sigr, &sigs, &q, &msg2));
 
     random_sign(&sigr, &sigs, &key, &msg, NULL);
     CHECK(secp256k1_ecdsa_sig_serialize(signature, &secp_sigsize, &sigr, &sigs));
@@ -6689,11 +8054,15 @@ int main(int argc, char **argv) {
     run_ctz_tests();
     run_modinv_tests();
     run_inverse_tests();
+    run_inverse_all_tests();
 
     run_sha256_tests();
+    run_sha256_transform_tests();
     run_hmac_sha256_tests();
     run_rfc6979_hmac_sha256_tests();
     run_tagged_sha256_tests();
+    run_tagged_sha256_batch_tests();
+    run_tagged_sha256_ctx_tests();
 
     /* scalar tests */
     run_scalar_tests();
@@ -6704,6 +8073,10 @@ int main(int argc, char **argv) {
     run_fe_mul();
     run_sqr();
     run_sqrt();
+    run_sqrt_batch();
+#ifdef SECP256K1_FE_LANES
+    run_field_lanes();
+#endif
 
     /* group tests */
     run_ge();
@@ -6711,6 +8084,8 @@ int main(int argc, char **argv) {
 
     /* ecmult tests */
     run_ecmult_pre_g();
+    run_ecmult_context_window();
+    run_ecmult_tables();
     run_wnaf();
     run_point_times_order();
     run_ecmult_near_split_bound();
@@ -6720,6 +8095,10 @@ int main(int argc, char **argv) {
     run_ecmult_const_tests();
     run_ecmult_multi_tests();
     run_ec_combine();
+    run_ec_pubkey_create_batch();
+    run_ec_pubkey_parse_serialize_batch();
+    run_pubkey_iterator();
+    run_ecmult_multi_api();
 
     /* endomorphism tests */
     run_endomorphism_tests();
@@ -6743,6 +8122,9 @@ int main(int argc, char **argv) {
     run_random_pubkeys();
     run_ecdsa_der_parse();
     run_ecdsa_sign_verify();
+    run_ecdsa_sign_batch();
+    run_ecdsa_verify_batch();
+    run_ecdsa_verify_precomp();
     run_ecdsa_end_to_end();
     run_ecdsa_edge_cases();
 #ifdef ENABLE_OPENSSL_TESTS
@@ -76,13 +76,20 @@ int main(void) {
 
 void run_tests(secp256k1_context *ctx, unsigned char *key) {
     secp256k1_ecdsa_signature signature;
+    secp256k1_ecdsa_signature signatures[2];
     secp256k1_pubkey pubkey;
+    secp256k1_pubkey pubkeys[2];
+    const unsigned char *key_ptr[2];
+    const unsigned char *msg_ptr[2];
     size_t siglen = 74;
     size_t outputlen = 33;
     int i;
     int ret;
     unsigned char msg[32];
     unsigned char sig[74];
+#ifdef ENABLE_MODULE_SCHNORRSIG
+    unsigned char sigs[128];
+#endif
     unsigned char spubkey[33];
 #ifdef ENABLE_MODULE_RECOVERY
     secp256k1_ecdsa_recoverable_signature recoverable_signature;
@@ -104,6 +111,16 @@ void run_tests(secp256k1_context *ctx, unsigned char *key) {
     CHECK(ret);
     CHECK(secp256k1_ec_pubkey_serialize(ctx, spubkey, &outputlen, &pubkey, SECP256K1_EC_COMPRESSED) == 1);
 
+    /* Test batch keygen. */
+    VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
+    key_ptr[0] = key;
+    key_ptr[1] = key;
+    ret = secp256k1_ec_pubkey_create_batch(ctx, pubkeys, key_ptr, 2);
+    VALGRIND_MAKE_MEM_DEFINED(pubkeys, sizeof(pubkeys));
+    VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+    CHECK(ret);
+    CHECK(secp256k1_memcmp_var(&pubkeys[0], &pubkey, sizeof(pubkey)) == 0);
+
     /* Test signing. */
     VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
     ret = secp256k1_ecdsa_sign(ctx, &signature, msg, key, NULL, NULL);
@@ -112,6 +129,16 @@ void run_tests(secp256k1_context *ctx, unsigned char *key) {
     CHECK(ret);
     CHECK(secp256k1_ecdsa_signature_serialize_der(ctx, sig, &siglen, &signature));
 
+    /* Test batch signing. */
+    VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
+    msg_ptr[0] = msg;
+    msg_ptr[1] = msg;
+    ret = secp256k1_ecdsa_sign_batch(ctx, signatures, msg_ptr, 2, key, NULL, NULL);
+    VALGRIND_MAKE_MEM_DEFINED(signatures, sizeof(signatures));
+    VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+    CHECK(ret);
+    CHECK(secp256k1_memcmp_var(&signatures[1], &signature, sizeof(signature)) == 0);
+
 #ifdef ENABLE_MODULE_ECDH
     /* Test ECDH. */
     VALGRIND_MAKE_MEM_UNDEFINED(key, 32);
@@ -181,5 +208,8 @@ void run_tests(secp256k1_context *ctx, unsigned char *key) {
     ret = secp256k1_schnorrsig_sign(ctx, sig, msg, &keypair, NULL);
     VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
     CHECK(ret == 1);
+    ret = secp256k1_schnorrsig_sign_batch(ctx, sigs, msg_ptr, 2, &keypair, NULL);
+    VALGRIND_MAKE_MEM_DEFINED(&ret, sizeof(ret));
+    CHECK(ret == 1);
 #endif
 }